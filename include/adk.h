@@ -33,7 +33,9 @@
 #include <unordered_set>
 #include <map>
 #include <unordered_map>
+#include <tuple>
 #include <cstring>
+#include <cmath>
 #include <string>
 #include <sstream>
 #include <memory>
@@ -43,6 +45,10 @@
 #include <thread>
 #include <chrono>
 
+#if defined(__SSE2__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
 #include <glibmm.h>
 #include <giomm.h>
 #include <sigc++/sigc++.h>
@@ -68,12 +74,19 @@
 
 #include <adk/spinlock.h>
 #include <adk/optional.h>
+#include <adk/string_view.h>
 #include <adk/message_queue.h>
 #include <adk/executor.h>
 #include <adk/thread_pool_executor.h>
 #include <adk/bitmap.h>
+#include <adk/compressed_bitmap.h>
 #include <adk/hash.h>
+#include <adk/flat_hash_map.h>
+#include <adk/crc32c.h>
+#include <adk/tree_hash.h>
+#include <adk/sketch.h>
 #include <adk/rb_tree.h>
+#include <adk/btree.h>
 #include <adk/random.h>
 
 #include <adk/signal.h>
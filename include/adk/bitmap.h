@@ -121,6 +121,195 @@ public:
     }
 };
 
+/** Bitwise AND operation for bulk bitmap operations. */
+struct BitmapOpAnd {
+    template <typename T>
+    T
+    operator()(T a, T b) const
+    {
+        return a & b;
+    }
+
+#ifdef __AVX2__
+    __m256i
+    operator()(__m256i a, __m256i b) const
+    {
+        return _mm256_and_si256(a, b);
+    }
+#endif
+};
+
+/** Bitwise OR operation for bulk bitmap operations. */
+struct BitmapOpOr {
+    template <typename T>
+    T
+    operator()(T a, T b) const
+    {
+        return a | b;
+    }
+
+#ifdef __AVX2__
+    __m256i
+    operator()(__m256i a, __m256i b) const
+    {
+        return _mm256_or_si256(a, b);
+    }
+#endif
+};
+
+/** Bitwise XOR operation for bulk bitmap operations. */
+struct BitmapOpXor {
+    template <typename T>
+    T
+    operator()(T a, T b) const
+    {
+        return a ^ b;
+    }
+
+#ifdef __AVX2__
+    __m256i
+    operator()(__m256i a, __m256i b) const
+    {
+        return _mm256_xor_si256(a, b);
+    }
+#endif
+};
+
+/** Bitwise AND-NOT (a & ~b) operation for bulk bitmap operations. */
+struct BitmapOpAndNot {
+    template <typename T>
+    T
+    operator()(T a, T b) const
+    {
+        return a & ~b;
+    }
+
+#ifdef __AVX2__
+    __m256i
+    operator()(__m256i a, __m256i b) const
+    {
+        /* Intrinsic negates the first operand. */
+        return _mm256_andnot_si256(b, a);
+    }
+#endif
+};
+
+/** Bulk operations over bitmap storage words. Vectorized with AVX2 when it is
+ * enabled for the build, scalar code is used otherwise.
+ */
+template <typename word_t>
+class BitmapWordOps {
+public:
+    /** Apply binary operation to each word: dst[i] = op(dst[i], src[i]). */
+    template <class Op>
+    static void
+    Apply(word_t *dst, const word_t *src, size_t numWords, Op op)
+    {
+        size_t idx = 0;
+#ifdef __AVX2__
+        for (; idx + WORDS_PER_VEC <= numWords; idx += WORDS_PER_VEC) {
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&dst[idx]));
+            __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&src[idx]));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(&dst[idx]), op(a, b));
+        }
+#endif
+        for (; idx < numWords; idx++) {
+            dst[idx] = op(dst[idx], src[idx]);
+        }
+    }
+
+    /** Check if op(a[i], b[i]) is non-zero for any word. */
+    template <class Op>
+    static bool
+    Any(const word_t *a, const word_t *b, size_t numWords, Op op)
+    {
+        size_t idx = 0;
+#ifdef __AVX2__
+        for (; idx + WORDS_PER_VEC <= numWords; idx += WORDS_PER_VEC) {
+            __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&a[idx]));
+            __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&b[idx]));
+            __m256i r = op(va, vb);
+            if (!_mm256_testz_si256(r, r)) {
+                return true;
+            }
+        }
+#endif
+        for (; idx < numWords; idx++) {
+            if (static_cast<word_t>(op(a[idx], b[idx]))) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /** Count set bits in the words. */
+    static size_t
+    Count(const word_t *bits, size_t numWords)
+    {
+        size_t idx = 0, count = 0;
+#ifdef __AVX2__
+        /* Nibble lookup table population count. */
+        const __m256i lookup = _mm256_setr_epi8(
+            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+        const __m256i lowMask = _mm256_set1_epi8(0x0f);
+        __m256i acc = _mm256_setzero_si256();
+        for (; idx + WORDS_PER_VEC <= numWords; idx += WORDS_PER_VEC) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&bits[idx]));
+            __m256i lo = _mm256_and_si256(v, lowMask);
+            __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), lowMask);
+            __m256i cnt = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo),
+                                          _mm256_shuffle_epi8(lookup, hi));
+            acc = _mm256_add_epi64(acc, _mm256_sad_epu8(cnt, _mm256_setzero_si256()));
+        }
+        count += _mm256_extract_epi64(acc, 0) + _mm256_extract_epi64(acc, 1) +
+                 _mm256_extract_epi64(acc, 2) + _mm256_extract_epi64(acc, 3);
+#endif
+        for (; idx < numWords; idx++) {
+            count += CountOnes(bits[idx]);
+        }
+        return count;
+    }
+
+private:
+#ifdef __AVX2__
+    static constexpr size_t WORDS_PER_VEC = sizeof(__m256i) / sizeof(word_t);
+#endif
+};
+
+#ifdef __AVX2__
+/** Lookup table for decoding set bits of one byte into indices. */
+class BitmapDecodeTable {
+public:
+    /** Indices of set bits for each byte value, padded with zeros. */
+    u8 indices[256][8];
+    /** Number of set bits for each byte value. */
+    u8 counts[256];
+
+    static const BitmapDecodeTable &
+    Get()
+    {
+        static const BitmapDecodeTable table;
+        return table;
+    }
+
+private:
+    BitmapDecodeTable()
+    {
+        for (int value = 0; value < 256; value++) {
+            u8 count = 0;
+            memset(indices[value], 0, sizeof(indices[value]));
+            for (u8 bit = 0; bit < 8; bit++) {
+                if (value & (1 << bit)) {
+                    indices[value][count++] = bit;
+                }
+            }
+            counts[value] = count;
+        }
+    }
+};
+#endif /* __AVX2__ */
+
 } /* namespace internal */
 
 /** Class representing bitmap - set of bits.
@@ -135,6 +324,8 @@ class Bitmap: public internal::BitmapBase<numBits, Allocator, word_t> {
 private:
     /** Base class type. */
     typedef internal::BitmapBase<numBits, Allocator, word_t> BaseT;
+    /** Unsigned type for word bits manipulations. */
+    typedef typename std::make_unsigned<word_t>::type UWord;
 
     /** Get index of word containing the specified bit. */
     static constexpr size_t
@@ -150,6 +341,28 @@ private:
         return static_cast<word_t>(1) << (bitIdx % (sizeof(word_t) * NBBY));
     }
 
+    /** Get mask of word with all bits starting from the specified one set. */
+    static constexpr word_t
+    _GetMaskFrom(size_t bitIdx)
+    {
+        return static_cast<word_t>(static_cast<UWord>(~static_cast<UWord>(0)) <<
+                                   (bitIdx % (sizeof(word_t) * NBBY)));
+    }
+
+    /** Get mask of the word containing bit preceding the specified end bit,
+     * with all bits below the end bit set.
+     */
+    static constexpr word_t
+    _GetMaskTo(size_t endBit)
+    {
+        return endBit % (sizeof(word_t) * NBBY) ?
+            static_cast<word_t>(~_GetMaskFrom(endBit)) :
+            static_cast<word_t>(~static_cast<word_t>(0));
+    }
+
+    template <size_t, class, typename>
+    friend class Bitmap;
+
 public:
     Bitmap(): BaseT() {}
 
@@ -251,6 +464,104 @@ public:
         }
     }
 
+    /** Intersect with another bitmap of the same size (this &= other). */
+    template <size_t otherNumBits, class OtherAllocator>
+    void
+    And(const Bitmap<otherNumBits, OtherAllocator, word_t> &other)
+    {
+        ASSERT(BaseT::NumBits() == other.NumBits());
+        internal::BitmapWordOps<word_t>::Apply(BaseT::_bits, other._bits,
+                                               BaseT::NumWords(),
+                                               internal::BitmapOpAnd());
+    }
+
+    /** Unite with another bitmap of the same size (this |= other). */
+    template <size_t otherNumBits, class OtherAllocator>
+    void
+    Or(const Bitmap<otherNumBits, OtherAllocator, word_t> &other)
+    {
+        ASSERT(BaseT::NumBits() == other.NumBits());
+        internal::BitmapWordOps<word_t>::Apply(BaseT::_bits, other._bits,
+                                               BaseT::NumWords(),
+                                               internal::BitmapOpOr());
+    }
+
+    /** Symmetric difference with another bitmap of the same size
+     * (this ^= other).
+     */
+    template <size_t otherNumBits, class OtherAllocator>
+    void
+    Xor(const Bitmap<otherNumBits, OtherAllocator, word_t> &other)
+    {
+        ASSERT(BaseT::NumBits() == other.NumBits());
+        internal::BitmapWordOps<word_t>::Apply(BaseT::_bits, other._bits,
+                                               BaseT::NumWords(),
+                                               internal::BitmapOpXor());
+    }
+
+    /** Subtract another bitmap of the same size (this &= ~other). */
+    template <size_t otherNumBits, class OtherAllocator>
+    void
+    AndNot(const Bitmap<otherNumBits, OtherAllocator, word_t> &other)
+    {
+        ASSERT(BaseT::NumBits() == other.NumBits());
+        internal::BitmapWordOps<word_t>::Apply(BaseT::_bits, other._bits,
+                                               BaseT::NumWords(),
+                                               internal::BitmapOpAndNot());
+    }
+
+    /** Get number of set bits in the bitmap. */
+    size_t
+    Count() const
+    {
+        return CountRange(0, BaseT::NumBits());
+    }
+
+    /** Get number of set bits in the specified range.
+     *
+     * @param startBit Index of the first bit in the range.
+     * @param numRangeBits Number of bits in the range.
+     */
+    size_t
+    CountRange(size_t startBit, size_t numRangeBits) const
+    {
+        ASSERT(startBit + numRangeBits <= BaseT::NumBits());
+        if (!numRangeBits) {
+            return 0;
+        }
+        size_t endBit = startBit + numRangeBits;
+        size_t firstWord = _GetWordIdx(startBit), lastWord = _GetWordIdx(endBit - 1);
+        word_t firstMask = _GetMaskFrom(startBit), lastMask = _GetMaskTo(endBit);
+        const word_t *bits = BaseT::_bits;
+        if (firstWord == lastWord) {
+            return CountOnes(static_cast<word_t>(bits[firstWord] & firstMask & lastMask));
+        }
+        return CountOnes(static_cast<word_t>(bits[firstWord] & firstMask)) +
+            internal::BitmapWordOps<word_t>::Count(&bits[firstWord + 1],
+                                                   lastWord - firstWord - 1) +
+            CountOnes(static_cast<word_t>(bits[lastWord] & lastMask));
+    }
+
+    /** Check if this bitmap has any set bit in common with another bitmap of
+     * the same size.
+     */
+    template <size_t otherNumBits, class OtherAllocator>
+    bool
+    Intersects(const Bitmap<otherNumBits, OtherAllocator, word_t> &other) const
+    {
+        return _AnyInAll(other, internal::BitmapOpAnd());
+    }
+
+    /** Check if all bits set in this bitmap are also set in another bitmap of
+     * the same size.
+     */
+    template <size_t otherNumBits, class OtherAllocator>
+    bool
+    IsSubsetOf(const Bitmap<otherNumBits, OtherAllocator, word_t> &other) const
+    {
+        return !_AnyInAll(other, internal::BitmapOpAndNot());
+    }
+
     /** Get first set bit index.
      *
      * @param startBit Bit index to start search from.
@@ -259,63 +570,908 @@ public:
     size_t
     FirstSet(size_t startBit = 0) const
     {
-        for (size_t wordIdx = startBit / (sizeof(word_t) * NBBY);
-             wordIdx < BaseT::NumWords();
-             wordIdx++) {
+        return _FindFirst(startBit, 0, BaseT::NumBits());
+    }
+
+    /** Get first cleared bit index.
+     *
+     * @param startBit Bit index to start search from.
+     * @return First cleared bit index, -1 if set bit not found.
+     */
+    size_t
+    FirstClear(size_t startBit = 0) const
+    {
+        return _FindFirst(startBit, ~static_cast<word_t>(0), BaseT::NumBits());
+    }
+
+    /** Forward iterator over indices of set bits. */
+    class SetBitIterator {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef size_t value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const size_t *pointer;
+        typedef size_t reference;
+
+        SetBitIterator() = default;
+
+        size_t
+        operator*() const
+        {
+            return _wordIdx * BITS_PER_WORD + CountTrailingZeros(_word);
+        }
+
+        SetBitIterator &
+        operator++()
+        {
+            /* Clear the lowest set bit. */
+            _word &= _word - 1;
+            if (!_word) {
+                _SeekWord(_wordIdx + 1);
+            }
+            return *this;
+        }
+
+        SetBitIterator
+        operator++(int)
+        {
+            SetBitIterator it = *this;
+            ++*this;
+            return it;
+        }
+
+        bool
+        operator==(const SetBitIterator &other) const
+        {
+            return _wordIdx == other._wordIdx && _word == other._word;
+        }
+
+        bool
+        operator!=(const SetBitIterator &other) const
+        {
+            return !(*this == other);
+        }
+
+    private:
+        friend class Bitmap;
+
+        const Bitmap *_bitmap = nullptr;
+        /** Index of the current word, number of words for end iterator. */
+        size_t _wordIdx = 0;
+        /** Not yet visited bits of the current word. */
+        UWord _word = 0;
+
+        SetBitIterator(const Bitmap *bitmap, size_t wordIdx):
+            _bitmap(bitmap)
+        {
+            _SeekWord(wordIdx);
+        }
+
+        /** Move to the first non-zero word starting from the specified one. */
+        void
+        _SeekWord(size_t wordIdx)
+        {
+            size_t numWords = _bitmap->NumWords();
+            _wordIdx = _bitmap->_SkipWords(wordIdx, 0, numWords);
+            _word = _wordIdx < numWords ? _bitmap->_GetWordBits(_wordIdx) : 0;
+            if (!_word) {
+                /* Only bits beyond the bitmap size were set in the last word. */
+                _wordIdx = numWords;
+            }
+        }
+    };
 
-            word_t w = BaseT::_bits[wordIdx];
-            if (!w) {
+    /** Range of set bits indices, usable in range-based for loop. */
+    class SetBitsRange {
+    public:
+        SetBitIterator
+        begin() const
+        {
+            return SetBitIterator(_bitmap, 0);
+        }
+
+        SetBitIterator
+        end() const
+        {
+            return SetBitIterator(_bitmap, _bitmap->NumWords());
+        }
+
+    private:
+        friend class Bitmap;
+
+        const Bitmap *_bitmap;
+
+        SetBitsRange(const Bitmap *bitmap):
+            _bitmap(bitmap)
+        {}
+    };
+
+    /** Get range of set bits indices in ascending order, e.g.
+     * @code
+     * for (size_t bitIdx: bitmap.SetBits()) {
+     *     ...
+     * }
+     * @endcode
+     */
+    SetBitsRange
+    SetBits() const
+    {
+        return SetBitsRange(this);
+    }
+
+    /** Write indices of all set bits in ascending order.
+     *
+     * @param out Output buffer, should have space for @ref Count values.
+     * @return Number of values written.
+     */
+    size_t
+    DecodeTo(u32 *out) const
+    {
+        ASSERT(BaseT::NumBits() <= static_cast<size_t>(MAX_U32) + 1);
+        size_t numWords = BaseT::NumWords();
+        size_t n = 0;
+#ifdef __AVX2__
+        /* Each byte is expanded into eight indices at once so the tail of
+         * the output buffer is written with scalar code to not overrun it.
+         */
+        const internal::BitmapDecodeTable &table = internal::BitmapDecodeTable::Get();
+        size_t total = Count();
+#endif
+        for (size_t wordIdx = _SkipWords(0, 0, numWords);
+             wordIdx < numWords;
+             wordIdx = _SkipWords(wordIdx + 1, 0, numWords)) {
+
+            UWord w = _GetWordBits(wordIdx);
+            u32 base = wordIdx * BITS_PER_WORD;
+#ifdef __AVX2__
+            if (n + CountOnes(w) + 8 <= total) {
+                for (size_t byteIdx = 0; byteIdx < sizeof(word_t); byteIdx++) {
+                    u8 b = static_cast<u8>(w >> (byteIdx * NBBY));
+                    __m256i idx = _mm256_cvtepu8_epi32(_mm_loadl_epi64(
+                        reinterpret_cast<const __m128i *>(table.indices[b])));
+                    idx = _mm256_add_epi32(idx, _mm256_set1_epi32(base + byteIdx * NBBY));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i *>(&out[n]), idx);
+                    n += table.counts[b];
+                }
                 continue;
             }
-            size_t baseIdx = wordIdx * sizeof(word_t) * NBBY;
-            if (startBit) {
-                startBit -= baseIdx;
+#endif
+            while (w) {
+                out[n++] = base + CountTrailingZeros(w);
+                w &= w - 1;
+            }
+        }
+        return n;
+    }
+
+    /** Set all bits in the specified range.
+     *
+     * @param startBit Index of the first bit in the range.
+     * @param numRangeBits Number of bits in the range.
+     */
+    void
+    SetRange(size_t startBit, size_t numRangeBits)
+    {
+        _FillRange(startBit, numRangeBits, ~static_cast<word_t>(0));
+    }
+
+    /** Clear all bits in the specified range.
+     *
+     * @param startBit Index of the first bit in the range.
+     * @param numRangeBits Number of bits in the range.
+     */
+    void
+    ClearRange(size_t startBit, size_t numRangeBits)
+    {
+        _FillRange(startBit, numRangeBits, 0);
+    }
+
+    /** Check if all bits in the specified range are clear.
+     *
+     * @param startBit Index of the first bit in the range.
+     * @param numRangeBits Number of bits in the range.
+     */
+    bool
+    IsRangeClear(size_t startBit, size_t numRangeBits) const
+    {
+        ASSERT(startBit + numRangeBits <= BaseT::NumBits());
+        return _FindFirst(startBit, 0, startBit + numRangeBits) == static_cast<size_t>(-1);
+    }
+
+    /** Check if all bits in the specified range are set.
+     *
+     * @param startBit Index of the first bit in the range.
+     * @param numRangeBits Number of bits in the range.
+     */
+    bool
+    IsRangeSet(size_t startBit, size_t numRangeBits) const
+    {
+        ASSERT(startBit + numRangeBits <= BaseT::NumBits());
+        return _FindFirst(startBit, ~static_cast<word_t>(0), startBit + numRangeBits) ==
+            static_cast<size_t>(-1);
+    }
+
+    /** Find first run of cleared bits of the specified length. Can be used
+     * as first-fit allocator of contiguous blocks.
+     *
+     * @param length Required number of consecutive cleared bits.
+     * @param alignment Required alignment of the run start index.
+     * @param startBit Bit index to start search from.
+     * @return Index of the first bit of the found run, -1 if not found.
+     */
+    size_t
+    FindClearRun(size_t length, size_t alignment = 1, size_t startBit = 0) const
+    {
+        ASSERT(length && alignment);
+        size_t endBit = BaseT::NumBits();
+        size_t pos = startBit;
+        while (true) {
+            pos = _FindFirst(pos, ~static_cast<word_t>(0), endBit);
+            if (pos == static_cast<size_t>(-1)) {
+                return -1;
+            }
+            pos = RoundUp(pos, alignment);
+            if (pos >= endBit || length > endBit - pos) {
+                return -1;
             }
-            for (size_t bitIdx = startBit;
-                 baseIdx + bitIdx < BaseT::NumBits();
-                 bitIdx++) {
+            /* The run is interrupted by the first set bit inside it, if any. */
+            size_t setIdx = _FindFirst(pos, 0, pos + length);
+            if (setIdx == static_cast<size_t>(-1)) {
+                return pos;
+            }
+            pos = setIdx + 1;
+        }
+    }
+
+private:
+    /** Check if the operation gives non-zero result for any pair of words.
+     * Bits beyond the bitmap size are ignored.
+     */
+    template <size_t otherNumBits, class OtherAllocator, class Op>
+    bool
+    _AnyInAll(const Bitmap<otherNumBits, OtherAllocator, word_t> &other, Op op) const
+    {
+        ASSERT(BaseT::NumBits() == other.NumBits());
+        size_t numWords = BaseT::NumWords();
+        if (!numWords) {
+            return false;
+        }
+        if (internal::BitmapWordOps<word_t>::Any(BaseT::_bits, other._bits,
+                                                 numWords - 1, op)) {
+            return true;
+        }
+        return static_cast<word_t>(op(BaseT::_bits[numWords - 1],
+                                      other._bits[numWords - 1]) &
+                                   _GetMaskTo(BaseT::NumBits()));
+    }
 
-                if (w & _GetMask(bitIdx)) {
-                    return baseIdx + bitIdx;
+    /** Number of bits in one storage word. */
+    static constexpr size_t BITS_PER_WORD = sizeof(word_t) * NBBY;
+
+    /** Find first word which is not equal to the specified pattern.
+     *
+     * @param wordIdx Index of word to start search from.
+     * @param pattern Either all zeros or all ones word value.
+     * @param numWords Index of word to stop search at.
+     * @return Index of found word, @a numWords if not found.
+     */
+    size_t
+    _SkipWords(size_t wordIdx, word_t pattern, size_t numWords) const
+    {
+        const word_t *bits = BaseT::_bits;
+
+        /* Vectorized scan works on raw bytes so it does not depend on word
+         * type - only on pattern being uniform.
+         */
+#if defined(__AVX2__)
+        const size_t wordsPerVec = sizeof(__m256i) / sizeof(word_t);
+        if (wordsPerVec) {
+            __m256i p = _mm256_set1_epi8(static_cast<char>(pattern));
+            while (wordIdx + wordsPerVec <= numWords) {
+                __m256i v = _mm256_loadu_si256(
+                    reinterpret_cast<const __m256i *>(&bits[wordIdx]));
+                if (!_mm256_testc_si256(_mm256_cmpeq_epi8(v, p), _mm256_set1_epi8(-1))) {
+                    break;
                 }
+                wordIdx += wordsPerVec;
             }
-            startBit = 0;
         }
-        return -1;
+#elif defined(__SSE2__)
+        const size_t wordsPerVec = sizeof(__m128i) / sizeof(word_t);
+        if (wordsPerVec) {
+            __m128i p = _mm_set1_epi8(static_cast<char>(pattern));
+            while (wordIdx + wordsPerVec <= numWords) {
+                __m128i v = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i *>(&bits[wordIdx]));
+                if (_mm_movemask_epi8(_mm_cmpeq_epi8(v, p)) != 0xffff) {
+                    break;
+                }
+                wordIdx += wordsPerVec;
+            }
+        }
+#endif
+        while (wordIdx < numWords && bits[wordIdx] == pattern) {
+            wordIdx++;
+        }
+        return wordIdx;
+    }
+
+    /** Find first bit which differs from the corresponding bit of the
+     * pattern.
+     *
+     * @param startBit Bit index to start search from.
+     * @param pattern Zero to search set bits, all ones to search cleared bits.
+     * @param endBit Bit index to stop search at (exclusive).
+     * @return Found bit index, -1 if not found.
+     */
+    size_t
+    _FindFirst(size_t startBit, word_t pattern, size_t endBit) const
+    {
+        if (startBit >= endBit) {
+            return -1;
+        }
+        size_t wordIdx = _GetWordIdx(startBit);
+        /* Mask out bits below the start bit in the first word. */
+        word_t w = (BaseT::_bits[wordIdx] ^ pattern) & _GetMaskFrom(startBit);
+        if (!w) {
+            size_t endWord = _GetWordIdx(endBit - 1) + 1;
+            wordIdx = _SkipWords(wordIdx + 1, pattern, endWord);
+            if (wordIdx >= endWord) {
+                return -1;
+            }
+            w = BaseT::_bits[wordIdx] ^ pattern;
+        }
+        size_t bitIdx = wordIdx * BITS_PER_WORD + CountTrailingZeros(w);
+        return bitIdx < endBit ? bitIdx : -1;
+    }
+
+    /** Get bits of the specified word, with bits beyond the bitmap size
+     * cleared.
+     */
+    UWord
+    _GetWordBits(size_t wordIdx) const
+    {
+        UWord w = BaseT::_bits[wordIdx];
+        if (wordIdx == BaseT::NumWords() - 1) {
+            w &= static_cast<UWord>(_GetMaskTo(BaseT::NumBits()));
+        }
+        return w;
+    }
+
+    /** Set all bits of the range to the pattern value.
+     *
+     * @param pattern Zero to clear bits, all ones to set bits.
+     */
+    void
+    _FillRange(size_t startBit, size_t numRangeBits, word_t pattern)
+    {
+        ASSERT(startBit + numRangeBits <= BaseT::NumBits());
+        if (!numRangeBits) {
+            return;
+        }
+        size_t endBit = startBit + numRangeBits;
+        size_t firstWord = _GetWordIdx(startBit), lastWord = _GetWordIdx(endBit - 1);
+        word_t *bits = BaseT::_bits;
+        word_t firstMask = _GetMaskFrom(startBit), lastMask = _GetMaskTo(endBit);
+        if (firstWord == lastWord) {
+            firstMask &= lastMask;
+        }
+        bits[firstWord] = (bits[firstWord] & ~firstMask) | (pattern & firstMask);
+        if (firstWord == lastWord) {
+            return;
+        }
+        for (size_t wordIdx = firstWord + 1; wordIdx < lastWord; wordIdx++) {
+            bits[wordIdx] = pattern;
+        }
+        bits[lastWord] = (bits[lastWord] & ~lastMask) | (pattern & lastMask);
+    }
+};
+
+/** Bitmap with hierarchical summary levels for fast search in huge, mostly
+ * full or mostly empty bitmaps. Each summary level has one bit per word of the
+ * level below, so @ref FirstSet and @ref FirstClear touch O(log64 n) words
+ * instead of scanning the whole storage. Two summaries are maintained - one
+ * indicates non-empty words (used for set bits search), another one indicates
+ * non-full words (used for cleared bits search). Single bit updates cost
+ * amortized O(1) since summaries are updated only when a word changes its
+ * empty or full state.
+ *
+ * @param Allocator Allocator for bitmap storage.
+ */
+template <class Allocator = std::allocator<int>>
+class HierarchicalBitmap {
+public:
+    HierarchicalBitmap() = default;
+
+    /** Create bitmap with all bits cleared. */
+    HierarchicalBitmap(size_t numBits)
+    {
+        Resize(numBits);
+    }
+
+    /** Resize bitmap. All bits are cleared in new bitmap. */
+    void
+    Resize(size_t numBits)
+    {
+        _numBits = numBits;
+        _bits.assign(_NumWords(numBits), 0);
+        _setSummary.clear();
+        _clearSummary.clear();
+        size_t numWords = _bits.size();
+        while (numWords > 1) {
+            size_t numSummaryWords = _NumWords(numWords);
+            _setSummary.emplace_back(numSummaryWords, 0);
+            _clearSummary.emplace_back(numSummaryWords, 0);
+            numWords = numSummaryWords;
+        }
+        _InitClearSummary();
+    }
+
+    /** Get number of bits in the bitmap. */
+    size_t
+    GetNumBits() const
+    {
+        return _numBits;
+    }
+
+    /** Set bit with specified index. */
+    void
+    Set(size_t bitIdx)
+    {
+        ASSERT(bitIdx < _numBits);
+        size_t wordIdx = bitIdx / BITS_PER_WORD;
+        u64 old = _bits[wordIdx];
+        u64 w = old | _GetMask(bitIdx);
+        if (w == old) {
+            return;
+        }
+        _bits[wordIdx] = w;
+        if (!old) {
+            _SummarySet(_setSummary, wordIdx);
+        }
+        if (w == ~static_cast<u64>(0)) {
+            _SummaryClear(_clearSummary, wordIdx);
+        }
+    }
+
+    /** Clear bit with specified index. */
+    void
+    Clear(size_t bitIdx)
+    {
+        ASSERT(bitIdx < _numBits);
+        size_t wordIdx = bitIdx / BITS_PER_WORD;
+        u64 old = _bits[wordIdx];
+        u64 w = old & ~_GetMask(bitIdx);
+        if (w == old) {
+            return;
+        }
+        _bits[wordIdx] = w;
+        if (old == ~static_cast<u64>(0)) {
+            _SummarySet(_clearSummary, wordIdx);
+        }
+        if (!w) {
+            _SummaryClear(_setSummary, wordIdx);
+        }
+    }
+
+    /** Set or clear bit with specified index.
+     *
+     * @param bitIdx Index of bit to change.
+     * @param value @a true to set, @a false to clear.
+     */
+    void
+    SetValue(size_t bitIdx, bool value)
+    {
+        if (value) {
+            Set(bitIdx);
+        } else {
+            Clear(bitIdx);
+        }
+    }
+
+    /** Check if bit is set at specified position. */
+    bool
+    IsSet(size_t bitIdx) const
+    {
+        ASSERT(bitIdx < _numBits);
+        return _bits[bitIdx / BITS_PER_WORD] & _GetMask(bitIdx);
+    }
+
+    /** Check if bit is clear at specified position. */
+    bool
+    IsClear(size_t bitIdx) const
+    {
+        return !IsSet(bitIdx);
+    }
+
+    bool
+    operator[](size_t bitIdx) const
+    {
+        return IsSet(bitIdx);
+    }
+
+    /** Clear all bits. */
+    void
+    ClearAll()
+    {
+        std::fill(_bits.begin(), _bits.end(), 0);
+        for (auto &level: _setSummary) {
+            std::fill(level.begin(), level.end(), 0);
+        }
+        _InitClearSummary();
+    }
+
+    /** Set all bits. */
+    void
+    SetAll()
+    {
+        ClearAll();
+        std::swap(_setSummary, _clearSummary);
+        for (size_t i = 0; i < _numBits / BITS_PER_WORD; i++) {
+            _bits[i] = ~static_cast<u64>(0);
+        }
+        if (_numBits % BITS_PER_WORD) {
+            /* Last word is never full since bits beyond the size are clear. */
+            _bits.back() = ~(~static_cast<u64>(0) << (_numBits % BITS_PER_WORD));
+            _SummarySet(_clearSummary, _bits.size() - 1);
+        }
+    }
+
+    /** Get first set bit index.
+     *
+     * @param startBit Bit index to start search from.
+     * @return First set bit index, -1 if set bit not found.
+     */
+    size_t
+    FirstSet(size_t startBit = 0) const
+    {
+        return _FindFirst(startBit, 0, _setSummary);
     }
 
     /** Get first cleared bit index.
      *
      * @param startBit Bit index to start search from.
-     * @return First cleared bit index, -1 if set bit not found.
+     * @return First cleared bit index, -1 if cleared bit not found.
      */
     size_t
     FirstClear(size_t startBit = 0) const
     {
-        for (size_t wordIdx = startBit / (sizeof(word_t) * NBBY);
-             wordIdx < BaseT::NumWords();
-             wordIdx++) {
+        return _FindFirst(startBit, ~static_cast<u64>(0), _clearSummary);
+    }
 
-            word_t w = BaseT::_bits[wordIdx];
-            if (w == ~static_cast<word_t>(0)) {
-                continue;
+private:
+    static constexpr size_t BITS_PER_WORD = sizeof(u64) * NBBY;
+
+    typedef typename Allocator::template rebind<u64>::other WordAllocator;
+    typedef std::vector<u64, WordAllocator> Words;
+    typedef typename Allocator::template rebind<Words>::other LevelAllocator;
+    typedef std::vector<Words, LevelAllocator> Summary;
+
+    size_t _numBits = 0;
+    /** Bits storage. */
+    Words _bits;
+    /** Summary levels, the first one describes storage words, each next one
+     * describes words of the previous level. Bit is set when the
+     * corresponding word is non-empty.
+     */
+    Summary _setSummary,
+    /** The same for non-full storage words. Bits in summary levels are set when
+     * the corresponding word is non-zero.
+     */
+            _clearSummary;
+
+    static constexpr size_t
+    _NumWords(size_t numBits)
+    {
+        return RoundUp2(numBits, BITS_PER_WORD) / BITS_PER_WORD;
+    }
+
+    static constexpr u64
+    _GetMask(size_t bitIdx)
+    {
+        return static_cast<u64>(1) << (bitIdx % BITS_PER_WORD);
+    }
+
+    /** Set summary bits for all existing words - used when all bits are
+     * cleared.
+     */
+    void
+    _InitClearSummary()
+    {
+        size_t numWords = _bits.size();
+        for (Words &level: _clearSummary) {
+            std::fill(level.begin(), level.end(), 0);
+            for (size_t i = 0; i < numWords / BITS_PER_WORD; i++) {
+                level[i] = ~static_cast<u64>(0);
             }
-            size_t baseIdx = wordIdx * sizeof(word_t) * NBBY;
-            if (startBit) {
-                startBit -= baseIdx;
+            if (numWords % BITS_PER_WORD) {
+                level.back() = ~(~static_cast<u64>(0) << (numWords % BITS_PER_WORD));
             }
-            for (size_t bitIdx = startBit;
-                 baseIdx + bitIdx < BaseT::NumBits();
-                 bitIdx++) {
+            numWords = level.size();
+        }
+    }
+
+    /** Set summary bit for the word which became non-zero. */
+    static void
+    _SummarySet(Summary &summary, size_t idx)
+    {
+        for (Words &level: summary) {
+            u64 &w = level[idx / BITS_PER_WORD];
+            u64 old = w;
+            w |= _GetMask(idx);
+            if (old) {
+                break;
+            }
+            idx /= BITS_PER_WORD;
+        }
+    }
 
-                if (!(w & _GetMask(bitIdx))) {
-                    return baseIdx + bitIdx;
+    /** Clear summary bit for the word which became zero. */
+    static void
+    _SummaryClear(Summary &summary, size_t idx)
+    {
+        for (Words &level: summary) {
+            u64 &w = level[idx / BITS_PER_WORD];
+            w &= ~_GetMask(idx);
+            if (w) {
+                break;
+            }
+            idx /= BITS_PER_WORD;
+        }
+    }
+
+    /** Find first bit which differs from the pattern bits.
+     *
+     * @param startBit Bit index to start search from.
+     * @param pattern Zero to search set bits, all ones to search cleared bits.
+     * @param summary Summary levels corresponding to the pattern.
+     */
+    size_t
+    _FindFirst(size_t startBit, u64 pattern, const Summary &summary) const
+    {
+        if (startBit >= _numBits) {
+            return -1;
+        }
+        size_t idx = startBit / BITS_PER_WORD;
+        u64 w = (_bits[idx] ^ pattern) &
+            (~static_cast<u64>(0) << (startBit % BITS_PER_WORD));
+        if (!w) {
+            /* Ascend until a level with candidate word after the current one
+             * is found.
+             */
+            size_t level = 0;
+            for (; level < summary.size(); level++) {
+                size_t shift = idx % BITS_PER_WORD + 1;
+                u64 s = shift < BITS_PER_WORD ?
+                    summary[level][idx / BITS_PER_WORD] & (~static_cast<u64>(0) << shift) : 0;
+                if (s) {
+                    idx = idx / BITS_PER_WORD * BITS_PER_WORD + CountTrailingZeros(s);
+                    break;
                 }
+                idx /= BITS_PER_WORD;
+            }
+            if (level == summary.size()) {
+                return -1;
+            }
+            /* Descend to the storage word. */
+            while (level > 0) {
+                level--;
+                idx = idx * BITS_PER_WORD + CountTrailingZeros(summary[level][idx]);
+            }
+            w = _bits[idx] ^ pattern;
+            ASSERT(w);
+        }
+        size_t bitIdx = idx * BITS_PER_WORD + CountTrailingZeros(w);
+        return bitIdx < _numBits ? bitIdx : -1;
+    }
+};
+
+/** Bitmap which can be modified concurrently from several threads without
+ * external locking. It is intended to be used as lock-free identifiers or
+ * slots allocator - @ref ClaimFirstClear atomically finds and sets a free bit,
+ * @ref TryClear releases it.
+ *
+ * @param word_t Word type for storage. Atomic operations on it should be
+ *      lock-free.
+ */
+template <typename word_t = unsigned long>
+class AtomicBitmap {
+public:
+    AtomicBitmap(size_t numBits):
+        _numBits(numBits),
+        _numWords(RoundUp2(numBits, BITS_PER_WORD) / BITS_PER_WORD),
+        _bits(new std::atomic<word_t>[_numWords])
+    {
+        for (size_t i = 0; i < _numWords; i++) {
+            _bits[i].store(0, std::memory_order_relaxed);
+        }
+        /* Bits beyond the size are permanently set so that they are never
+         * claimed.
+         */
+        if (numBits % BITS_PER_WORD) {
+            _bits[_numWords - 1].store(_GetMaskFrom(numBits), std::memory_order_relaxed);
+        }
+        /* Cursors start at evenly spread positions. */
+        for (size_t i = 0; i < NUM_CURSORS; i++) {
+            _cursors[i].pos.store(i * numBits / NUM_CURSORS, std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    AtomicBitmap(const AtomicBitmap &) = delete;
+
+    /** Get number of bits in the bitmap. */
+    size_t
+    GetNumBits() const
+    {
+        return _numBits;
+    }
+
+    /** Atomically set the bit.
+     *
+     * @return @a true if the bit was clear and this call has set it, @a false
+     *      if it was already set.
+     */
+    bool
+    TrySet(size_t bitIdx)
+    {
+        ASSERT(bitIdx < _numBits);
+        word_t mask = _GetMask(bitIdx);
+        return !(_bits[bitIdx / BITS_PER_WORD].fetch_or(mask, std::memory_order_acq_rel) & mask);
+    }
+
+    /** Atomically clear the bit.
+     *
+     * @return @a true if the bit was set and this call has cleared it, @a
+     *      false if it was already clear.
+     */
+    bool
+    TryClear(size_t bitIdx)
+    {
+        ASSERT(bitIdx < _numBits);
+        word_t mask = _GetMask(bitIdx);
+        return _bits[bitIdx / BITS_PER_WORD].fetch_and(~mask, std::memory_order_acq_rel) & mask;
+    }
+
+    /** Set the bit. */
+    void
+    Set(size_t bitIdx)
+    {
+        TrySet(bitIdx);
+    }
+
+    /** Clear the bit. */
+    void
+    Clear(size_t bitIdx)
+    {
+        TryClear(bitIdx);
+    }
+
+    /** Check if bit is set at specified position. */
+    bool
+    IsSet(size_t bitIdx) const
+    {
+        ASSERT(bitIdx < _numBits);
+        return _bits[bitIdx / BITS_PER_WORD].load(std::memory_order_acquire) & _GetMask(bitIdx);
+    }
+
+    /** Check if bit is clear at specified position. */
+    bool
+    IsClear(size_t bitIdx) const
+    {
+        return !IsSet(bitIdx);
+    }
+
+    /** Atomically find and set a clear bit. Search starts from the specified
+     * hint and wraps around the bitmap end.
+     *
+     * @param startHint Bit index to start search from. Different threads
+     *      should use different hints to reduce contention.
+     * @return Index of claimed bit, -1 if there are no clear bits.
+     */
+    size_t
+    ClaimFirstClear(size_t startHint)
+    {
+        if (!_numBits) {
+            return -1;
+        }
+        startHint %= _numBits;
+        size_t startWord = startHint / BITS_PER_WORD;
+        word_t startMask = _GetMaskFrom(startHint);
+        /* The start word is visited twice - firstly bits after the hint, and
+         * bits before the hint after wrapping around.
+         */
+        for (size_t i = 0; i <= _numWords; i++) {
+            size_t wordIdx = (startWord + i) % _numWords;
+            word_t allowed = ~static_cast<word_t>(0);
+            if (i == 0) {
+                allowed = startMask;
+            } else if (i == _numWords) {
+                allowed = ~startMask;
+            }
+            size_t bitIdx = _ClaimInWord(wordIdx, allowed);
+            if (bitIdx != static_cast<size_t>(-1)) {
+                return bitIdx;
             }
-            startBit = 0;
         }
         return -1;
     }
+
+    /** Atomically find and set a clear bit using per-thread start hint. Each
+     * thread is mapped to one of the bitmap cursors which start at evenly
+     * spread positions and advance past the last claimed bit, so concurrent
+     * allocations mostly touch different words.
+     *
+     * @return Index of claimed bit, -1 if there are no clear bits.
+     */
+    size_t
+    ClaimFirstClear()
+    {
+        static thread_local size_t threadHash =
+            std::hash<std::thread::id>()(std::this_thread::get_id());
+        std::atomic<size_t> &cursor = _cursors[threadHash % NUM_CURSORS].pos;
+        size_t bitIdx = ClaimFirstClear(cursor.load(std::memory_order_relaxed));
+        if (bitIdx != static_cast<size_t>(-1)) {
+            cursor.store(bitIdx + 1, std::memory_order_relaxed);
+        }
+        return bitIdx;
+    }
+
+private:
+    static constexpr size_t BITS_PER_WORD = sizeof(word_t) * NBBY;
+    /** Number of per-thread search cursors. */
+    static constexpr size_t NUM_CURSORS = 8;
+
+    /** Word type promoted to at least unsigned int so that shifts are not
+     * applied to negative promoted values.
+     */
+    typedef typename std::common_type<word_t, unsigned>::type shift_word_t;
+
+    /** Search cursor padded to occupy a separate cache line. */
+    struct Cursor {
+        std::atomic<size_t> pos;
+        u8 pad[64 - sizeof(std::atomic<size_t>)];
+    };
+
+    size_t _numBits, _numWords;
+    std::unique_ptr<std::atomic<word_t>[]> _bits;
+    Cursor _cursors[NUM_CURSORS];
+
+    static constexpr word_t
+    _GetMask(size_t bitIdx)
+    {
+        return static_cast<word_t>(1) << (bitIdx % BITS_PER_WORD);
+    }
+
+    static constexpr word_t
+    _GetMaskFrom(size_t bitIdx)
+    {
+        return static_cast<word_t>(~static_cast<shift_word_t>(0) << (bitIdx % BITS_PER_WORD));
+    }
+
+    /** Claim clear bit in the specified word.
+     *
+     * @param wordIdx Word index.
+     * @param allowed Mask of bits allowed to claim.
+     * @return Claimed bit index, -1 if no allowed clear bits in the word.
+     */
+    size_t
+    _ClaimInWord(size_t wordIdx, word_t allowed)
+    {
+        std::atomic<word_t> &aw = _bits[wordIdx];
+        word_t w = aw.load(std::memory_order_relaxed);
+        while (true) {
+            word_t free = ~w & allowed;
+            if (!free) {
+                return -1;
+            }
+            word_t mask = free & (~free + 1);
+            if (aw.compare_exchange_weak(w, w | mask, std::memory_order_acq_rel,
+                                         std::memory_order_relaxed)) {
+                return wordIdx * BITS_PER_WORD + CountTrailingZeros(mask);
+            }
+        }
+    }
 };
 
 } /* namespace adk */
@@ -0,0 +1,1423 @@
+/* This file is a part of ADK library.
+ * Copyright (c) 2012-2015, Artyom Lebedev <artyom.lebedev@gmail.com>
+ * All rights reserved.
+ * See LICENSE file for copyright details.
+ */
+
+/** @file btree.h
+ * Cache-friendly B+-tree ordered map and set.
+ */
+
+#ifndef BTREE_H_
+#define BTREE_H_
+
+namespace adk {
+
+namespace internal {
+
+/** Search for lower bound in sorted node keys. Generic implementation for
+ * arbitrary keys and predicates uses binary search.
+ */
+template <class TKey, class Compare, class = void>
+struct BTreeKeySearch {
+    /** Get index of the first key which is not less than the specified one,
+     * which is also the number of keys less than the specified one.
+     */
+    static size_t
+    LowerBound(const TKey *keys, size_t numKeys, const TKey &key, const Compare &cmp)
+    {
+        return std::lower_bound(keys, keys + numKeys, key, cmp) - keys;
+    }
+};
+
+#if defined(__x86_64__) && defined(__GNUC__)
+/** SIMD search implementations are compiled. */
+#define ADK_BTREE_SIMD
+
+/** SIMD instruction sets available for B-tree node search. */
+enum class BTreeSimdLevel {
+    NONE,
+    SSE42,
+    AVX2
+};
+
+/** Detect SIMD level once based on CPU features. */
+inline BTreeSimdLevel
+GetBTreeSimdLevel()
+{
+    static const BTreeSimdLevel level = [] () {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return BTreeSimdLevel::AVX2;
+        }
+        if (__builtin_cpu_supports("sse4.2")) {
+            return BTreeSimdLevel::SSE42;
+        }
+        return BTreeSimdLevel::NONE;
+    }();
+    return level;
+}
+#endif /* defined(__x86_64__) && defined(__GNUC__) */
+
+/** Search in nodes with 32 and 64 bits integer keys. Keys less than the
+ * specified one are counted with SIMD comparisons, without branches on keys
+ * values. Large nodes are firstly narrowed by binary search so that the
+ * linear scan does not exceed two cache lines.
+ *
+ * SIMD implementation is selected at run time: AVX2 for all keys, SSE4.2
+ * for 64-bits keys and SSE2 for 32-bits keys. Scalar branchless counting is
+ * used for 64-bits keys on CPUs without SSE4.2 and on other architectures.
+ */
+template <class TKey>
+struct BTreeKeySearch<TKey, std::less<TKey>,
+                      typename std::enable_if<std::is_integral<TKey>::value &&
+                                              (sizeof(TKey) == 4 || sizeof(TKey) == 8)>::type> {
+    static size_t
+    LowerBound(const TKey *keys, size_t numKeys, TKey key, const std::less<TKey> &)
+    {
+        size_t base = 0;
+        while (numKeys > LINEAR_KEYS) {
+            size_t half = numKeys / 2;
+            if (keys[base + half] < key) {
+                base += half + 1;
+                numKeys -= half + 1;
+            } else {
+                numKeys = half;
+            }
+        }
+        return base + _CountLess(keys + base, numKeys, key);
+    }
+
+private:
+    /** Maximal number of keys for linear scan. */
+    static constexpr size_t LINEAR_KEYS = 128 / sizeof(TKey);
+    /** Only signed comparison is available, unsigned values are biased by
+     * flipping the sign bit.
+     */
+    static constexpr u64 BIAS = std::is_signed<TKey>::value ? 0 :
+        static_cast<u64>(1) << (sizeof(TKey) * NBBY - 1);
+
+    /** Count keys less than the specified one. Since the keys are sorted,
+     * matching lanes always form a prefix, so the scan stops at the first
+     * vector which is not completely less.
+     */
+    static size_t
+    _CountLess(const TKey *keys, size_t numKeys, TKey key)
+    {
+#ifdef ADK_BTREE_SIMD
+        BTreeSimdLevel level = GetBTreeSimdLevel();
+        if (level == BTreeSimdLevel::AVX2) {
+            return _CountLessAvx2(keys, numKeys, key);
+        }
+        if (sizeof(TKey) == 4) {
+            return _CountLessSse2(keys, numKeys, key);
+        }
+        if (level == BTreeSimdLevel::SSE42) {
+            return _CountLessSse42(keys, numKeys, key);
+        }
+#endif /* ADK_BTREE_SIMD */
+        return _CountLessScalar(keys, 0, numKeys, key);
+    }
+
+    /** Count keys less than the specified one starting from the specified
+     * index which is the number of keys already counted.
+     */
+    static size_t
+    _CountLessScalar(const TKey *keys, size_t i, size_t numKeys, TKey key)
+    {
+        size_t count = i;
+        for (; i < numKeys; i++) {
+            count += keys[i] < key;
+        }
+        return count;
+    }
+
+#ifdef ADK_BTREE_SIMD
+    __attribute__((target("avx2"))) static size_t
+    _CountLessAvx2(const TKey *keys, size_t numKeys, TKey key)
+    {
+        size_t i = 0;
+        if (sizeof(TKey) == 8) {
+            __m256i vBias = _mm256_set1_epi64x(static_cast<i64>(BIAS));
+            __m256i vKey = _mm256_set1_epi64x(static_cast<u64>(key) ^ BIAS);
+            for (; i + 4 <= numKeys; i += 4) {
+                __m256i v = _mm256_xor_si256(
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i)), vBias);
+                u32 mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(vKey, v)));
+                if (mask != 0xf) {
+                    return i + CountOnes(mask);
+                }
+            }
+        } else {
+            __m256i vBias = _mm256_set1_epi32(static_cast<i32>(static_cast<u32>(BIAS)));
+            __m256i vKey = _mm256_set1_epi32(static_cast<u32>(key) ^ static_cast<u32>(BIAS));
+            for (; i + 8 <= numKeys; i += 8) {
+                __m256i v = _mm256_xor_si256(
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i)), vBias);
+                u32 mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(vKey, v)));
+                if (mask != 0xff) {
+                    return i + CountOnes(mask);
+                }
+            }
+        }
+        return _CountLessScalar(keys, i, numKeys, key);
+    }
+
+    /** 64-bits comparison requires SSE4.2. */
+    __attribute__((target("sse4.2"))) static size_t
+    _CountLessSse42(const TKey *keys, size_t numKeys, TKey key)
+    {
+        size_t i = 0;
+        __m128i vBias = _mm_set1_epi64x(static_cast<i64>(BIAS));
+        __m128i vKey = _mm_set1_epi64x(static_cast<u64>(key) ^ BIAS);
+        for (; i + 2 <= numKeys; i += 2) {
+            __m128i v = _mm_xor_si128(
+                _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys + i)), vBias);
+            u32 mask = _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(vKey, v)));
+            if (mask != 0x3) {
+                return i + CountOnes(mask);
+            }
+        }
+        return _CountLessScalar(keys, i, numKeys, key);
+    }
+
+    /** SSE2 is always available on x86-64. */
+    static size_t
+    _CountLessSse2(const TKey *keys, size_t numKeys, TKey key)
+    {
+        size_t i = 0;
+        __m128i vBias = _mm_set1_epi32(static_cast<i32>(static_cast<u32>(BIAS)));
+        __m128i vKey = _mm_set1_epi32(static_cast<u32>(key) ^ static_cast<u32>(BIAS));
+        for (; i + 4 <= numKeys; i += 4) {
+            __m128i v = _mm_xor_si128(
+                _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys + i)), vBias);
+            u32 mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(vKey, v)));
+            if (mask != 0xf) {
+                return i + CountOnes(mask);
+            }
+        }
+        return _CountLessScalar(keys, i, numKeys, key);
+    }
+#endif /* ADK_BTREE_SIMD */
+};
+
+/** Values array in B-tree leaf. */
+template <class T, size_t capacity>
+struct BTreeValues {
+    /** Size of one value in the node. */
+    static constexpr size_t VALUE_SIZE = sizeof(T);
+
+    T values[capacity];
+
+    T *
+    Get(size_t idx)
+    {
+        return &values[idx];
+    }
+
+    /** Move values inside the array, ranges may overlap. */
+    void
+    Move(size_t dst, size_t src, size_t count)
+    {
+        memmove(&values[dst], &values[src], count * sizeof(T));
+    }
+
+    /** Copy values from other leaf. */
+    void
+    CopyFrom(size_t dst, const BTreeValues &other, size_t src, size_t count)
+    {
+        memcpy(&values[dst], &other.values[src], count * sizeof(T));
+    }
+};
+
+/** Sets have no values. */
+template <size_t capacity>
+struct BTreeValues<void, capacity> {
+    static constexpr size_t VALUE_SIZE = 0;
+
+    void *
+    Get(size_t)
+    {
+        return nullptr;
+    }
+
+    void
+    Move(size_t, size_t, size_t)
+    {}
+
+    void
+    CopyFrom(size_t, const BTreeValues &, size_t, size_t)
+    {}
+};
+
+/** Result of iterator arrow operator when the reference is a temporary
+ * object rather than a real reference.
+ */
+template <class TRef>
+class BTreeArrowProxy {
+public:
+    BTreeArrowProxy(const TRef &ref):
+        _ref(ref)
+    {}
+
+    const TRef *
+    operator ->() const
+    {
+        return &_ref;
+    }
+
+private:
+    TRef _ref;
+};
+
+/** Iterator reference type, pair of references to key and value for maps.
+ * Keys and values are stored in separate arrays, so there is no stored pair
+ * to point to.
+ */
+template <class TKey, class T, bool isConst>
+struct BTreeReference {
+    typedef std::pair<const TKey &,
+                      typename std::conditional<isConst, const T &, T &>::type> type;
+    typedef std::pair<const TKey, T> value_type;
+    typedef BTreeArrowProxy<type> pointer;
+
+    template <class TValues>
+    static type
+    Make(const TKey &key, TValues &values, size_t idx)
+    {
+        return type(key, *values.Get(idx));
+    }
+
+    template <class TValues>
+    static pointer
+    MakePointer(const TKey &key, TValues &values, size_t idx)
+    {
+        return pointer(Make(key, values, idx));
+    }
+};
+
+template <class TKey, bool isConst>
+struct BTreeReference<TKey, void, isConst> {
+    typedef const TKey &type;
+    typedef TKey value_type;
+    typedef const TKey *pointer;
+
+    template <class TValues>
+    static type
+    Make(const TKey &key, TValues &, size_t)
+    {
+        return key;
+    }
+
+    template <class TValues>
+    static pointer
+    MakePointer(const TKey &key, TValues &, size_t)
+    {
+        return &key;
+    }
+};
+
+/** B+-tree with fixed-size nodes. All items are stored in leaves which are
+ * linked in a list for range iteration, inner nodes store only keys and
+ * children pointers. Each inner node key is the upper bound of the keys in
+ * the corresponding child subtree, so only lower bound search is needed on
+ * all levels. Keys in a node are stored contiguously and searched with
+ * @ref BTreeKeySearch.
+ *
+ * Nodes are allocated from pooled chunks aligned to the cache line size.
+ * Keys and values should be trivially copyable, they are moved inside nodes
+ * with memmove. Iterators are invalidated by any modification.
+ *
+ * @param T Value type, void for sets.
+ * @param nodeSize Node size in bytes, multiple of the cache line size.
+ */
+template <class TKey, class T, class Compare, size_t nodeSize>
+class BTree {
+protected:
+    enum {
+        CACHE_LINE_SIZE = 64,
+        /** Maximal tree height, enough for any number of items since each
+         * non-root node has at least two children.
+         */
+        MAX_HEIGHT = sizeof(size_t) * NBBY
+    };
+
+    static_assert(nodeSize % CACHE_LINE_SIZE == 0,
+                  "Node size should be multiple of cache line size");
+    static_assert(std::is_trivially_copyable<TKey>::value,
+                  "Key type should be trivially copyable");
+
+    /** Number of items in leaf. Space for the header, links and padding is
+     * reserved.
+     */
+    static constexpr size_t LEAF_CAPACITY = (nodeSize - 4 * sizeof(void *)) /
+        (sizeof(TKey) + BTreeValues<T, 1>::VALUE_SIZE);
+    /** Number of keys in inner node, it has one child more. */
+    static constexpr size_t INNER_CAPACITY = (nodeSize - 3 * sizeof(void *)) /
+        (sizeof(TKey) + sizeof(void *));
+    /** Nodes with less number of keys are re-balanced on deletion. */
+    static constexpr size_t LEAF_MIN = LEAF_CAPACITY / 2;
+    static constexpr size_t INNER_MIN = INNER_CAPACITY / 2;
+
+    static_assert(LEAF_CAPACITY >= 2 && INNER_CAPACITY >= 3,
+                  "Node size is too small for the key and value types");
+    /* Number of keys is stored in 16 bits. */
+    static_assert(LEAF_CAPACITY <= 0xffff && INNER_CAPACITY <= 0xffff,
+                  "Node size is too large for the key and value types");
+
+    struct Node {
+        u16 numKeys;
+        bool isLeaf;
+    };
+
+    struct Leaf: Node {
+        TKey keys[LEAF_CAPACITY];
+        BTreeValues<T, LEAF_CAPACITY> values;
+        Leaf *prev, *next;
+    };
+
+    struct Inner: Node {
+        TKey keys[INNER_CAPACITY];
+        Node *children[INNER_CAPACITY + 1];
+    };
+
+    static_assert(sizeof(Leaf) <= nodeSize && sizeof(Inner) <= nodeSize,
+                  "Node capacity calculation error");
+
+public:
+    typedef TKey key_type;
+    typedef size_t size_type;
+
+    /** Bidirectional iterator over the items in ascending order. */
+    template <bool isConst>
+    class Iterator {
+    public:
+        typedef std::bidirectional_iterator_tag iterator_category;
+        typedef std::ptrdiff_t difference_type;
+        typedef typename BTreeReference<TKey, T, isConst>::type reference;
+        typedef typename BTreeReference<TKey, T, isConst>::value_type value_type;
+        typedef typename BTreeReference<TKey, T, isConst>::pointer pointer;
+
+        Iterator() = default;
+
+        /** Mutable iterator is convertible to constant one. */
+        template <bool otherConst,
+                  typename = typename std::enable_if<isConst && !otherConst>::type>
+        Iterator(const Iterator<otherConst> &other):
+            _leaf(other._leaf), _idx(other._idx), _tree(other._tree)
+        {}
+
+        /** Get key reference for sets, pair of key and value references for
+         * maps.
+         */
+        reference
+        operator *() const
+        {
+            return BTreeReference<TKey, T, isConst>::Make(_leaf->keys[_idx],
+                                                          _leaf->values, _idx);
+        }
+
+        pointer
+        operator ->() const
+        {
+            return BTreeReference<TKey, T, isConst>::MakePointer(_leaf->keys[_idx],
+                                                                 _leaf->values, _idx);
+        }
+
+        const TKey &
+        GetKey() const
+        {
+            return _leaf->keys[_idx];
+        }
+
+        /** Get value reference, maps only. */
+        auto &
+        GetValue() const
+        {
+            return std::get<1>(**this);
+        }
+
+        Iterator &
+        operator ++()
+        {
+            if (++_idx == _leaf->numKeys) {
+                _leaf = _leaf->next;
+                _idx = 0;
+            }
+            return *this;
+        }
+
+        Iterator
+        operator ++(int)
+        {
+            Iterator it = *this;
+            ++*this;
+            return it;
+        }
+
+        /** Decrementing end iterator gives the last item. */
+        Iterator &
+        operator --()
+        {
+            if (!_leaf) {
+                _leaf = _tree->_lastLeaf;
+                _idx = _leaf->numKeys - 1;
+            } else if (!_idx) {
+                _leaf = _leaf->prev;
+                _idx = _leaf->numKeys - 1;
+            } else {
+                _idx--;
+            }
+            return *this;
+        }
+
+        Iterator
+        operator --(int)
+        {
+            Iterator it = *this;
+            --*this;
+            return it;
+        }
+
+        bool
+        operator ==(const Iterator &other) const
+        {
+            return _leaf == other._leaf && _idx == other._idx;
+        }
+
+        bool
+        operator !=(const Iterator &other) const
+        {
+            return !(*this == other);
+        }
+
+    private:
+        friend class BTree;
+        template <bool>
+        friend class Iterator;
+
+        /** NULL for end iterator. */
+        Leaf *_leaf = nullptr;
+        size_t _idx = 0;
+        /** Tree is needed for decrementing end iterator. */
+        const BTree *_tree = nullptr;
+
+        Iterator(Leaf *leaf, size_t idx, const BTree *tree):
+            _leaf(leaf), _idx(idx), _tree(tree)
+        {}
+    };
+
+    typedef Iterator<false> iterator;
+    typedef Iterator<true> const_iterator;
+
+    BTree(const Compare &cmp = Compare()):
+        _cmp(cmp)
+    {}
+
+    BTree(const BTree &other):
+        _cmp(other._cmp)
+    {
+        const_iterator it = other.begin();
+        _Build(other._size, [&](Leaf *leaf, size_t idx) {
+            leaf->keys[idx] = it._leaf->keys[it._idx];
+            leaf->values.CopyFrom(idx, it._leaf->values, it._idx, 1);
+            ++it;
+        });
+    }
+
+    BTree(BTree &&other):
+        _cmp(std::move(other._cmp))
+    {
+        _Steal(other);
+    }
+
+    BTree &
+    operator =(const BTree &other)
+    {
+        if (this != &other) {
+            BTree tmp(other);
+            *this = std::move(tmp);
+        }
+        return *this;
+    }
+
+    BTree &
+    operator =(BTree &&other)
+    {
+        if (this != &other) {
+            _cmp = std::move(other._cmp);
+            _Steal(other);
+        }
+        return *this;
+    }
+
+    /** Get number of items. */
+    size_t
+    Size() const
+    {
+        return _size;
+    }
+
+    bool
+    IsEmpty() const
+    {
+        return !_size;
+    }
+
+    /** Get number of levels, zero for empty tree. */
+    size_t
+    GetHeight() const
+    {
+        return _height;
+    }
+
+    /** Get number of bytes allocated for nodes. */
+    size_t
+    GetMemoryUsage() const
+    {
+        return _numAllocatedNodes * nodeSize;
+    }
+
+    iterator
+    begin()
+    {
+        return iterator(_firstLeaf, 0, this);
+    }
+
+    iterator
+    end()
+    {
+        return iterator(nullptr, 0, this);
+    }
+
+    const_iterator
+    begin() const
+    {
+        return const_cast<BTree *>(this)->begin();
+    }
+
+    const_iterator
+    end() const
+    {
+        return const_cast<BTree *>(this)->end();
+    }
+
+    /** Remove all items and release the memory. */
+    void
+    Clear()
+    {
+        _chunks.clear();
+        _chunkNodes = nullptr;
+        _numChunkNodes = 0;
+        _freeNodes = nullptr;
+        _numAllocatedNodes = 0;
+        _root = nullptr;
+        _firstLeaf = _lastLeaf = nullptr;
+        _size = 0;
+        _height = 0;
+    }
+
+    /** Find item by key.
+     *
+     * @return Iterator pointing to the found item, @ref end if not found.
+     */
+    iterator
+    Find(const TKey &key)
+    {
+        if (!_root) {
+            return end();
+        }
+        Leaf *leaf = _FindLeaf(key);
+        size_t idx = _Search(leaf->keys, leaf->numKeys, key);
+        if (idx < leaf->numKeys && !_cmp(key, leaf->keys[idx])) {
+            return iterator(leaf, idx, this);
+        }
+        return end();
+    }
+
+    const_iterator
+    Find(const TKey &key) const
+    {
+        return const_cast<BTree *>(this)->Find(key);
+    }
+
+    /** Check if item with the specified key exists. */
+    bool
+    Contains(const TKey &key) const
+    {
+        return Find(key) != end();
+    }
+
+    /** Get iterator pointing to the first item with key not less than the
+     * specified one.
+     */
+    iterator
+    LowerBound(const TKey &key)
+    {
+        if (!_root) {
+            return end();
+        }
+        Leaf *leaf = _FindLeaf(key);
+        size_t idx = _Search(leaf->keys, leaf->numKeys, key);
+        if (idx == leaf->numKeys) {
+            /* All keys of the next leaf are greater than the leaf bound. */
+            return iterator(leaf->next, 0, this);
+        }
+        return iterator(leaf, idx, this);
+    }
+
+    const_iterator
+    LowerBound(const TKey &key) const
+    {
+        return const_cast<BTree *>(this)->LowerBound(key);
+    }
+
+    /** Get iterator pointing to the first item with key greater than the
+     * specified one.
+     */
+    iterator
+    UpperBound(const TKey &key)
+    {
+        iterator it = LowerBound(key);
+        if (it != end() && !_cmp(key, it.GetKey())) {
+            ++it;
+        }
+        return it;
+    }
+
+    const_iterator
+    UpperBound(const TKey &key) const
+    {
+        return const_cast<BTree *>(this)->UpperBound(key);
+    }
+
+    /** Remove item with the specified key.
+     *
+     * @return Number of removed items.
+     */
+    size_t
+    Erase(const TKey &key)
+    {
+        if (!_root) {
+            return 0;
+        }
+        Inner *path[MAX_HEIGHT];
+        size_t pathIdx[MAX_HEIGHT];
+        size_t level = 0;
+        Node *node = _root;
+        while (!node->isLeaf) {
+            Inner *inner = static_cast<Inner *>(node);
+            size_t idx = _Search(inner->keys, inner->numKeys, key);
+            path[level] = inner;
+            pathIdx[level] = idx;
+            level++;
+            node = inner->children[idx];
+        }
+        Leaf *leaf = static_cast<Leaf *>(node);
+        size_t pos = _Search(leaf->keys, leaf->numKeys, key);
+        if (pos == leaf->numKeys || _cmp(key, leaf->keys[pos])) {
+            return 0;
+        }
+        _LeafRemove(leaf, pos);
+        _size--;
+
+        if (!level) {
+            if (!leaf->numKeys) {
+                Clear();
+            }
+            return 1;
+        }
+        if (leaf->numKeys >= LEAF_MIN ||
+            !_RebalanceLeaf(leaf, path[level - 1], pathIdx[level - 1])) {
+
+            return 1;
+        }
+        /* Parent lost a child, re-balance up the path. */
+        for (level--; level; level--) {
+            Inner *inner = path[level];
+            if (inner->numKeys >= INNER_MIN ||
+                !_RebalanceInner(inner, path[level - 1], pathIdx[level - 1])) {
+
+                return 1;
+            }
+        }
+        Inner *root = path[0];
+        if (!root->numKeys) {
+            _root = root->children[0];
+            _FreeNode(root);
+            _height--;
+        }
+        return 1;
+    }
+
+    /** Remove item pointed by the iterator. */
+    void
+    Erase(const_iterator it)
+    {
+        TKey key = it.GetKey();
+        Erase(key);
+    }
+
+    /** Validate the tree structure. This method is intended for
+     * troubleshooting.
+     *
+     * @return @a true if all invariants are satisfied.
+     */
+    bool
+    Validate() const
+    {
+        if (!_root) {
+            return !_size && !_height && !_firstLeaf && !_lastLeaf;
+        }
+        Leaf *prevLeaf = nullptr;
+        size_t numItems = 0;
+        if (!_ValidateNode(_root, 1, nullptr, nullptr, prevLeaf, numItems)) {
+            return false;
+        }
+        return prevLeaf == _lastLeaf && !prevLeaf->next && numItems == _size;
+    }
+
+protected:
+    /** Find item by key or insert a new one if not found. The value of the
+     * inserted item is left uninitialized.
+     *
+     * @return Iterator pointing to the item and @a true if it was inserted.
+     */
+    std::pair<iterator, bool>
+    _FindOrInsert(const TKey &key)
+    {
+        if (!_root) {
+            Leaf *leaf = _NewLeaf();
+            _root = leaf;
+            _firstLeaf = _lastLeaf = leaf;
+            _height = 1;
+        }
+        Inner *path[MAX_HEIGHT];
+        size_t pathIdx[MAX_HEIGHT];
+        size_t level = 0;
+        Node *node = _root;
+        while (!node->isLeaf) {
+            Inner *inner = static_cast<Inner *>(node);
+            size_t idx = _Search(inner->keys, inner->numKeys, key);
+            path[level] = inner;
+            pathIdx[level] = idx;
+            level++;
+            node = inner->children[idx];
+        }
+        Leaf *leaf = static_cast<Leaf *>(node);
+        size_t pos = _Search(leaf->keys, leaf->numKeys, key);
+        if (pos < leaf->numKeys && !_cmp(key, leaf->keys[pos])) {
+            return std::make_pair(iterator(leaf, pos, this), false);
+        }
+        _size++;
+        if (leaf->numKeys < LEAF_CAPACITY) {
+            _LeafInsert(leaf, pos, key);
+            return std::make_pair(iterator(leaf, pos, this), true);
+        }
+
+        /* Split the leaf, upper part goes to the new right sibling. When
+         * appending to the last leaf, the leaf is left full so that
+         * ascending insertions produce full nodes.
+         */
+        size_t numLeft = pos == LEAF_CAPACITY && !leaf->next ?
+            LEAF_CAPACITY : (LEAF_CAPACITY + 1) / 2;
+        Leaf *right = _NewLeaf();
+        _LeafCopy(right, 0, leaf, numLeft, LEAF_CAPACITY - numLeft);
+        right->numKeys = LEAF_CAPACITY - numLeft;
+        leaf->numKeys = numLeft;
+        right->prev = leaf;
+        right->next = leaf->next;
+        if (leaf->next) {
+            leaf->next->prev = right;
+        } else {
+            _lastLeaf = right;
+        }
+        leaf->next = right;
+
+        Leaf *target = leaf;
+        if (pos > numLeft || numLeft == LEAF_CAPACITY) {
+            target = right;
+            pos -= numLeft;
+        }
+        _LeafInsert(target, pos, key);
+        _InsertSeparator(path, pathIdx, level, leaf->keys[leaf->numKeys - 1], right);
+        return std::make_pair(iterator(target, pos, this), true);
+    }
+
+    /** Replace the tree content with the items in strictly ascending order.
+     * Leaves are filled evenly and as much as possible, the tree is built
+     * level by level in O(n) time.
+     *
+     * @param numItems Number of items.
+     * @param fill Functor which is called with leaf pointer and index to
+     *      fill the next item key and value.
+     */
+    template <class Fill>
+    void
+    _Build(size_t numItems, Fill &&fill)
+    {
+        Clear();
+        if (!numItems) {
+            return;
+        }
+        size_t numLeaves = (numItems + LEAF_CAPACITY - 1) / LEAF_CAPACITY;
+        std::vector<Node *> nodes;
+        /* Upper bound key of each node. */
+        std::vector<TKey> bounds;
+        nodes.reserve(numLeaves);
+        bounds.reserve(numLeaves);
+        for (size_t i = 0; i < numLeaves; i++) {
+            size_t count = numItems / numLeaves + (i < numItems % numLeaves);
+            Leaf *leaf = _NewLeaf();
+            for (size_t idx = 0; idx < count; idx++) {
+                fill(leaf, idx);
+            }
+            leaf->numKeys = count;
+            leaf->prev = _lastLeaf;
+            if (_lastLeaf) {
+                _lastLeaf->next = leaf;
+            } else {
+                _firstLeaf = leaf;
+            }
+            _lastLeaf = leaf;
+            nodes.push_back(leaf);
+            bounds.push_back(leaf->keys[count - 1]);
+        }
+        _height = 1;
+
+        while (nodes.size() > 1) {
+            size_t numChildren = nodes.size();
+            size_t numNodes = (numChildren + INNER_CAPACITY) / (INNER_CAPACITY + 1);
+            size_t src = 0;
+            for (size_t i = 0; i < numNodes; i++) {
+                size_t count = numChildren / numNodes + (i < numChildren % numNodes);
+                Inner *inner = _NewInner();
+                for (size_t idx = 0; idx < count; idx++, src++) {
+                    inner->children[idx] = nodes[src];
+                    if (idx < count - 1) {
+                        inner->keys[idx] = bounds[src];
+                    }
+                }
+                inner->numKeys = count - 1;
+                /* Upper level is built in place, it is always shorter. */
+                nodes[i] = inner;
+                bounds[i] = bounds[src - 1];
+            }
+            nodes.resize(numNodes);
+            bounds.resize(numNodes);
+            _height++;
+        }
+        _root = nodes[0];
+        _size = numItems;
+        ASSERT(Validate());
+    }
+
+private:
+    Compare _cmp;
+    Node *_root = nullptr;
+    Leaf *_firstLeaf = nullptr, *_lastLeaf = nullptr;
+    size_t _size = 0, _height = 0;
+
+    /** Nodes storage chunks. */
+    std::vector<std::unique_ptr<u8[]>> _chunks;
+    /** Not yet used nodes in the last chunk. */
+    u8 *_chunkNodes = nullptr;
+    size_t _numChunkNodes = 0;
+    /** Released nodes list, linked through the first bytes. */
+    void *_freeNodes = nullptr;
+    size_t _numAllocatedNodes = 0;
+
+    size_t
+    _Search(const TKey *keys, size_t numKeys, const TKey &key) const
+    {
+        return BTreeKeySearch<TKey, Compare>::LowerBound(keys, numKeys, key, _cmp);
+    }
+
+    /** Find leaf which may contain the key. */
+    Leaf *
+    _FindLeaf(const TKey &key) const
+    {
+        Node *node = _root;
+        while (!node->isLeaf) {
+            Inner *inner = static_cast<Inner *>(node);
+            node = inner->children[_Search(inner->keys, inner->numKeys, key)];
+        }
+        return static_cast<Leaf *>(node);
+    }
+
+    void *
+    _AllocNode()
+    {
+        _numAllocatedNodes++;
+        if (_freeNodes) {
+            void *node = _freeNodes;
+            _freeNodes = *static_cast<void **>(node);
+            return node;
+        }
+        if (!_numChunkNodes) {
+            /* Chunks grow with the tree up to 64 nodes. */
+            size_t numNodes = Min<size_t>(64, Max<size_t>(1, _numAllocatedNodes / 2));
+            _chunks.emplace_back(new u8[numNodes * nodeSize + CACHE_LINE_SIZE - 1]);
+            _chunkNodes = reinterpret_cast<u8 *>(
+                RoundUp2(reinterpret_cast<uintptr_t>(_chunks.back().get()), CACHE_LINE_SIZE));
+            _numChunkNodes = numNodes;
+        }
+        void *node = _chunkNodes;
+        _chunkNodes += nodeSize;
+        _numChunkNodes--;
+        return node;
+    }
+
+    void
+    _FreeNode(void *node)
+    {
+        *static_cast<void **>(node) = _freeNodes;
+        _freeNodes = node;
+        _numAllocatedNodes--;
+    }
+
+    Leaf *
+    _NewLeaf()
+    {
+        Leaf *leaf = new(_AllocNode()) Leaf;
+        leaf->numKeys = 0;
+        leaf->isLeaf = true;
+        leaf->prev = leaf->next = nullptr;
+        return leaf;
+    }
+
+    Inner *
+    _NewInner()
+    {
+        Inner *inner = new(_AllocNode()) Inner;
+        inner->numKeys = 0;
+        inner->isLeaf = false;
+        return inner;
+    }
+
+    /** Copy items between leaves. */
+    static void
+    _LeafCopy(Leaf *dst, size_t dstIdx, Leaf *src, size_t srcIdx, size_t count)
+    {
+        memcpy(&dst->keys[dstIdx], &src->keys[srcIdx], count * sizeof(TKey));
+        dst->values.CopyFrom(dstIdx, src->values, srcIdx, count);
+    }
+
+    /** Insert key in the leaf which is not full, the value slot is left
+     * uninitialized.
+     */
+    static void
+    _LeafInsert(Leaf *leaf, size_t pos, const TKey &key)
+    {
+        size_t count = leaf->numKeys - pos;
+        memmove(&leaf->keys[pos + 1], &leaf->keys[pos], count * sizeof(TKey));
+        leaf->values.Move(pos + 1, pos, count);
+        leaf->keys[pos] = key;
+        leaf->numKeys++;
+    }
+
+    static void
+    _LeafRemove(Leaf *leaf, size_t pos)
+    {
+        size_t count = leaf->numKeys - pos - 1;
+        memmove(&leaf->keys[pos], &leaf->keys[pos + 1], count * sizeof(TKey));
+        leaf->values.Move(pos, pos + 1, count);
+        leaf->numKeys--;
+    }
+
+    /** Insert key and the child following it in the inner node which is not
+     * full.
+     */
+    static void
+    _InnerInsert(Inner *inner, size_t idx, const TKey &key, Node *child)
+    {
+        size_t count = inner->numKeys - idx;
+        memmove(&inner->keys[idx + 1], &inner->keys[idx], count * sizeof(TKey));
+        memmove(&inner->children[idx + 2], &inner->children[idx + 1],
+                count * sizeof(Node *));
+        inner->keys[idx] = key;
+        inner->children[idx + 1] = child;
+        inner->numKeys++;
+    }
+
+    /** Remove key and the child following it from the inner node. */
+    static void
+    _InnerRemove(Inner *inner, size_t idx)
+    {
+        size_t count = inner->numKeys - idx - 1;
+        memmove(&inner->keys[idx], &inner->keys[idx + 1], count * sizeof(TKey));
+        memmove(&inner->children[idx + 1], &inner->children[idx + 2],
+                count * sizeof(Node *));
+        inner->numKeys--;
+    }
+
+    /** Insert separator key and new child after split, splitting inner nodes
+     * up the path if necessary.
+     *
+     * @param path Inner nodes from the root to the split node parent.
+     * @param pathIdx Child index in each path node.
+     * @param level Number of nodes in the path.
+     * @param key Upper bound of the split node left part.
+     * @param child Split node right part.
+     */
+    void
+    _InsertSeparator(Inner **path, size_t *pathIdx, size_t level, TKey key, Node *child)
+    {
+        /* Whether the path goes along the right edge of the tree. */
+        bool isRightEdge[MAX_HEIGHT];
+        for (size_t i = 0; i < level; i++) {
+            isRightEdge[i] = pathIdx[i] == path[i]->numKeys && (!i || isRightEdge[i - 1]);
+        }
+
+        while (level) {
+            level--;
+            Inner *inner = path[level];
+            size_t idx = pathIdx[level];
+            if (inner->numKeys < INNER_CAPACITY) {
+                _InnerInsert(inner, idx, key, child);
+                return;
+            }
+            /* Split the node, middle key goes up. */
+            size_t numLeft = isRightEdge[level] ? INNER_CAPACITY - 1 : INNER_CAPACITY / 2;
+            Inner *right = _NewInner();
+            size_t numRight = INNER_CAPACITY - numLeft - 1;
+            memcpy(right->keys, &inner->keys[numLeft + 1], numRight * sizeof(TKey));
+            memcpy(right->children, &inner->children[numLeft + 1],
+                   (numRight + 1) * sizeof(Node *));
+            right->numKeys = numRight;
+            inner->numKeys = numLeft;
+            TKey upKey = inner->keys[numLeft];
+            if (idx <= numLeft) {
+                _InnerInsert(inner, idx, key, child);
+            } else {
+                _InnerInsert(right, idx - numLeft - 1, key, child);
+            }
+            key = upKey;
+            child = right;
+        }
+
+        /* Split reached the root, grow the tree. */
+        Inner *root = _NewInner();
+        root->keys[0] = key;
+        root->children[0] = _root;
+        root->children[1] = child;
+        root->numKeys = 1;
+        _root = root;
+        _height++;
+    }
+
+    /** Re-balance underflown leaf by borrowing an item from a sibling or
+     * merging with it.
+     *
+     * @return @a true if the leaf was merged, so the parent lost a child.
+     */
+    bool
+    _RebalanceLeaf(Leaf *leaf, Inner *parent, size_t idx)
+    {
+        if (idx) {
+            Leaf *left = static_cast<Leaf *>(parent->children[idx - 1]);
+            if (left->numKeys > LEAF_MIN) {
+                _LeafInsert(leaf, 0, left->keys[left->numKeys - 1]);
+                leaf->values.CopyFrom(0, left->values, left->numKeys - 1, 1);
+                left->numKeys--;
+                parent->keys[idx - 1] = left->keys[left->numKeys - 1];
+                return false;
+            }
+        }
+        if (idx < parent->numKeys) {
+            Leaf *right = static_cast<Leaf *>(parent->children[idx + 1]);
+            if (right->numKeys > LEAF_MIN) {
+                _LeafCopy(leaf, leaf->numKeys, right, 0, 1);
+                leaf->numKeys++;
+                _LeafRemove(right, 0);
+                parent->keys[idx] = leaf->keys[leaf->numKeys - 1];
+                return false;
+            }
+        }
+        if (idx) {
+            idx--;
+        }
+        Leaf *left = static_cast<Leaf *>(parent->children[idx]);
+        Leaf *right = static_cast<Leaf *>(parent->children[idx + 1]);
+        _LeafCopy(left, left->numKeys, right, 0, right->numKeys);
+        left->numKeys += right->numKeys;
+        left->next = right->next;
+        if (right->next) {
+            right->next->prev = left;
+        } else {
+            _lastLeaf = left;
+        }
+        _FreeNode(right);
+        _InnerRemove(parent, idx);
+        return true;
+    }
+
+    /** Re-balance underflown inner node by rotating a child through the
+     * parent from a sibling or merging with it.
+     *
+     * @return @a true if the node was merged, so the parent lost a child.
+     */
+    bool
+    _RebalanceInner(Inner *inner, Inner *parent, size_t idx)
+    {
+        if (idx) {
+            Inner *left = static_cast<Inner *>(parent->children[idx - 1]);
+            if (left->numKeys > INNER_MIN) {
+                memmove(&inner->keys[1], &inner->keys[0], inner->numKeys * sizeof(TKey));
+                memmove(&inner->children[1], &inner->children[0],
+                        (inner->numKeys + 1) * sizeof(Node *));
+                inner->keys[0] = parent->keys[idx - 1];
+                inner->children[0] = left->children[left->numKeys];
+                inner->numKeys++;
+                parent->keys[idx - 1] = left->keys[left->numKeys - 1];
+                left->numKeys--;
+                return false;
+            }
+        }
+        if (idx < parent->numKeys) {
+            Inner *right = static_cast<Inner *>(parent->children[idx + 1]);
+            if (right->numKeys > INNER_MIN) {
+                inner->keys[inner->numKeys] = parent->keys[idx];
+                inner->children[inner->numKeys + 1] = right->children[0];
+                inner->numKeys++;
+                parent->keys[idx] = right->keys[0];
+                memmove(&right->keys[0], &right->keys[1], (right->numKeys - 1) * sizeof(TKey));
+                memmove(&right->children[0], &right->children[1],
+                        right->numKeys * sizeof(Node *));
+                right->numKeys--;
+                return false;
+            }
+        }
+        if (idx) {
+            idx--;
+        }
+        Inner *left = static_cast<Inner *>(parent->children[idx]);
+        Inner *right = static_cast<Inner *>(parent->children[idx + 1]);
+        left->keys[left->numKeys] = parent->keys[idx];
+        memcpy(&left->keys[left->numKeys + 1], right->keys, right->numKeys * sizeof(TKey));
+        memcpy(&left->children[left->numKeys + 1], right->children,
+               (right->numKeys + 1) * sizeof(Node *));
+        left->numKeys += right->numKeys + 1;
+        _FreeNode(right);
+        _InnerRemove(parent, idx);
+        return true;
+    }
+
+    /** Validate subtree.
+     *
+     * @param low Exclusive lower bound of the keys, NULL if not bounded.
+     * @param high Inclusive upper bound of the keys, NULL if not bounded.
+     * @param prevLeaf Previously visited leaf, updated by the call.
+     * @param numItems Items counter, updated by the call.
+     */
+    bool
+    _ValidateNode(const Node *node, size_t depth, const TKey *low, const TKey *high,
+                  Leaf *&prevLeaf, size_t &numItems) const
+    {
+        if (!node->numKeys && (node->isLeaf || node != _root)) {
+            return false;
+        }
+        const TKey *keys = node->isLeaf ? static_cast<const Leaf *>(node)->keys :
+            static_cast<const Inner *>(node)->keys;
+        for (size_t i = 0; i < node->numKeys; i++) {
+            if ((i && !_cmp(keys[i - 1], keys[i])) ||
+                (low && !_cmp(*low, keys[i])) || (high && _cmp(*high, keys[i]))) {
+
+                return false;
+            }
+        }
+        if (node->isLeaf) {
+            const Leaf *leaf = static_cast<const Leaf *>(node);
+            if (depth != _height || node->numKeys > LEAF_CAPACITY ||
+                leaf->prev != prevLeaf || (prevLeaf && prevLeaf->next != leaf) ||
+                (!prevLeaf && _firstLeaf != leaf)) {
+
+                return false;
+            }
+            prevLeaf = const_cast<Leaf *>(leaf);
+            numItems += node->numKeys;
+            return true;
+        }
+        const Inner *inner = static_cast<const Inner *>(node);
+        if (node->numKeys > INNER_CAPACITY) {
+            return false;
+        }
+        for (size_t i = 0; i <= inner->numKeys; i++) {
+            if (!_ValidateNode(inner->children[i], depth + 1,
+                               i ? &inner->keys[i - 1] : low,
+                               i < inner->numKeys ? &inner->keys[i] : high,
+                               prevLeaf, numItems)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /** Take the tree from another one leaving it empty. */
+    void
+    _Steal(BTree &other)
+    {
+        _root = other._root;
+        _firstLeaf = other._firstLeaf;
+        _lastLeaf = other._lastLeaf;
+        _size = other._size;
+        _height = other._height;
+        _chunks = std::move(other._chunks);
+        _chunkNodes = other._chunkNodes;
+        _numChunkNodes = other._numChunkNodes;
+        _freeNodes = other._freeNodes;
+        _numAllocatedNodes = other._numAllocatedNodes;
+        other._chunks.clear();
+        other.Clear();
+    }
+};
+
+} /* namespace internal */
+
+/** Ordered map based on B+-tree. Items are stored in nodes of the specified
+ * size, so a lookup takes one or two cache misses per level and there are
+ * several times less levels than in a binary tree. The memory overhead is
+ * a fraction of a pointer per item. See internal::BTree for the details.
+ *
+ * @param nodeSize Node size in bytes, multiple of the cache line size. Larger
+ *      nodes make the tree lower but increase insertion cost.
+ */
+template <class TKey, class T, class Compare = std::less<TKey>, size_t nodeSize = 256>
+class BTreeMap: public internal::BTree<TKey, T, Compare, nodeSize> {
+private:
+    typedef internal::BTree<TKey, T, Compare, nodeSize> BaseT;
+
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Value type should be trivially copyable");
+public:
+    typedef T mapped_type;
+    using typename BaseT::iterator;
+    using typename BaseT::const_iterator;
+
+    using BaseT::BaseT;
+
+    /** Create map from the items in strictly ascending keys order. See
+     * @ref Assign.
+     */
+    template <class TIter>
+    BTreeMap(TIter first, TIter last, const Compare &cmp = Compare()):
+        BaseT(cmp)
+    {
+        Assign(first, last);
+    }
+
+    /** Insert the item if its key is not yet in the map.
+     *
+     * @return Iterator pointing to the item with the key and @a true if the
+     *      item was inserted.
+     */
+    std::pair<iterator, bool>
+    Insert(const TKey &key, const T &value)
+    {
+        auto result = BaseT::_FindOrInsert(key);
+        if (result.second) {
+            result.first.GetValue() = value;
+        }
+        return result;
+    }
+
+    /** Get reference to the mapped value, value-initialized one is inserted
+     * if the key is not found.
+     */
+    T &
+    operator [](const TKey &key)
+    {
+        auto result = BaseT::_FindOrInsert(key);
+        if (result.second) {
+            result.first.GetValue() = T();
+        }
+        return result.first.GetValue();
+    }
+
+    /** Get reference to the mapped value.
+     *
+     * @throws InvalidParamException if the key is not found.
+     */
+    T &
+    At(const TKey &key)
+    {
+        auto it = this->Find(key);
+        if (it == this->end()) {
+            ADK_EXCEPTION(InvalidParamException, "Key not found");
+        }
+        return it.GetValue();
+    }
+
+    const T &
+    At(const TKey &key) const
+    {
+        return const_cast<BTreeMap *>(this)->At(key);
+    }
+
+    /** Replace the map content with the items in strictly ascending keys
+     * order. The tree is built in O(n) time with fully packed nodes.
+     *
+     * @param first Iterator to the first item, dereferenced to a pair of key
+     *      and value.
+     * @param last End of the items range.
+     */
+    template <class TIter>
+    void
+    Assign(TIter first, TIter last)
+    {
+        BaseT::_Build(std::distance(first, last), [&](auto *leaf, size_t idx) {
+            leaf->keys[idx] = first->first;
+            *leaf->values.Get(idx) = first->second;
+            ++first;
+        });
+    }
+};
+
+/** Ordered set based on B+-tree. See @ref BTreeMap for details. */
+template <class TKey, class Compare = std::less<TKey>, size_t nodeSize = 256>
+class BTreeSet: public internal::BTree<TKey, void, Compare, nodeSize> {
+private:
+    typedef internal::BTree<TKey, void, Compare, nodeSize> BaseT;
+public:
+    using typename BaseT::iterator;
+    using typename BaseT::const_iterator;
+
+    using BaseT::BaseT;
+
+    /** Create set from the keys in strictly ascending order. See
+     * @ref Assign.
+     */
+    template <class TIter>
+    BTreeSet(TIter first, TIter last, const Compare &cmp = Compare()):
+        BaseT(cmp)
+    {
+        Assign(first, last);
+    }
+
+    /** Insert the key if it is not yet in the set.
+     *
+     * @return Iterator pointing to the key and @a true if it was inserted.
+     */
+    std::pair<iterator, bool>
+    Insert(const TKey &key)
+    {
+        return BaseT::_FindOrInsert(key);
+    }
+
+    /** Replace the set content with the keys in strictly ascending order.
+     * The tree is built in O(n) time with fully packed nodes.
+     */
+    template <class TIter>
+    void
+    Assign(TIter first, TIter last)
+    {
+        BaseT::_Build(std::distance(first, last), [&](auto *leaf, size_t idx) {
+            leaf->keys[idx] = *first;
+            ++first;
+        });
+    }
+};
+
+} /* namespace adk */
+
+#endif /* BTREE_H_ */
@@ -0,0 +1,257 @@
+/* This file is a part of ADK library.
+ * Copyright (c) 2012-2015, Artyom Lebedev <artyom.lebedev@gmail.com>
+ * All rights reserved.
+ * See LICENSE file for copyright details.
+ */
+
+/** @file compressed_bitmap.h
+ * Compressed bitmap for sparse sets of 32-bits integers.
+ */
+
+#ifndef ADK_COMPRESSED_BITMAP_H_
+#define ADK_COMPRESSED_BITMAP_H_
+
+namespace adk {
+
+/** Compressed bitmap over 32-bits integers (Roaring bitmap layout). The key
+ * space is split into 64K chunks by high 16 bits of the value, each non-empty
+ * chunk has a container of one of the following types:
+ * @li Array - sorted array of low 16 bits of the values. Used when the chunk
+ *      has no more than 4096 values.
+ * @li Bitset - plain 8KB bitmap. Used for denser chunks.
+ * @li Run - sorted array of runs of consecutive values. Produced by
+ *      @ref RunOptimize for chunks where it is more compact. Run container is
+ *      converted to array or bitset when modified.
+ *
+ * Serialized form is portable (little-endian, fixed layout with 8 bytes
+ * aligned payloads), so it can be persisted and queried directly from a
+ * memory-mapped file using @ref IsSetSerialized.
+ */
+class CompressedBitmap {
+public:
+    /** Thrown when serialized data is malformed. */
+    ADK_DEFINE_EXCEPTION(FormatException);
+
+    CompressedBitmap() = default;
+
+    /** Set bit with specified index. */
+    void
+    Set(u32 bitIdx);
+
+    /** Clear bit with specified index. */
+    void
+    Clear(u32 bitIdx);
+
+    /** Set or clear bit with specified index.
+     *
+     * @param bitIdx Index of bit to change.
+     * @param value @a true to set, @a false to clear.
+     */
+    void
+    SetValue(u32 bitIdx, bool value)
+    {
+        if (value) {
+            Set(bitIdx);
+        } else {
+            Clear(bitIdx);
+        }
+    }
+
+    /** Check if bit is set at specified position. */
+    bool
+    IsSet(u32 bitIdx) const;
+
+    /** Check if bit is clear at specified position. */
+    bool
+    IsClear(u32 bitIdx) const
+    {
+        return !IsSet(bitIdx);
+    }
+
+    bool
+    operator[](u32 bitIdx) const
+    {
+        return IsSet(bitIdx);
+    }
+
+    /** Get first set bit index.
+     *
+     * @param startBit Bit index to start search from.
+     * @return First set bit index, -1 if set bit not found.
+     */
+    size_t
+    FirstSet(size_t startBit = 0) const;
+
+    /** Get number of set bits. */
+    size_t
+    Count() const;
+
+    /** Check if there are no set bits. */
+    bool
+    IsEmpty() const
+    {
+        return _keys.empty();
+    }
+
+    /** Clear all bits. */
+    void
+    ClearAll()
+    {
+        _keys.clear();
+        _containers.clear();
+    }
+
+    /** Intersect with another bitmap (this &= other). */
+    void
+    And(const CompressedBitmap &other);
+
+    /** Unite with another bitmap (this |= other). */
+    void
+    Or(const CompressedBitmap &other);
+
+    /** Symmetric difference with another bitmap (this ^= other). */
+    void
+    Xor(const CompressedBitmap &other);
+
+    /** Subtract another bitmap (this &= ~other). */
+    void
+    AndNot(const CompressedBitmap &other);
+
+    /** Check if this bitmap has any set bit in common with another bitmap. */
+    bool
+    Intersects(const CompressedBitmap &other) const;
+
+    /** Convert containers to run containers where it makes them smaller.
+     * Should be called after bulk population of the bitmap, e.g. before
+     * serialization.
+     */
+    void
+    RunOptimize();
+
+    /** Get approximate number of bytes used by the bitmap storage. */
+    size_t
+    GetMemoryUsage() const;
+
+    /** Get size in bytes of the serialized form. */
+    size_t
+    GetSerializedSize() const;
+
+    /** Serialize the bitmap into the provided buffer.
+     *
+     * @param buf Buffer of at least @ref GetSerializedSize bytes. It should be
+     *      8 bytes aligned if it is going to be accessed in-place.
+     */
+    void
+    Serialize(void *buf) const;
+
+    /** Serialize the bitmap. */
+    std::vector<u8>
+    Serialize() const;
+
+    /** Restore the bitmap from its serialized form.
+     *
+     * @throws FormatException if the data is malformed.
+     */
+    static CompressedBitmap
+    Deserialize(const void *data, size_t size);
+
+    /** Check if bit is set directly in the serialized form without
+     * deserializing it (e.g. in a memory-mapped file).
+     *
+     * @throws FormatException if the data is malformed.
+     */
+    static bool
+    IsSetSerialized(const void *data, size_t size, u32 bitIdx);
+
+private:
+    /** Container for one 64K chunk. */
+    class Container {
+    public:
+        enum class Type: u8 {
+            ARRAY,
+            BITSET,
+            RUN
+        };
+
+        /** Maximal number of values in array container. */
+        static constexpr size_t MAX_ARRAY_SIZE = 4096;
+        /** Number of words in bitset container. */
+        static constexpr size_t BITSET_WORDS = 65536 / 64;
+
+        Type type = Type::ARRAY;
+        /** Number of values in the container. */
+        u32 cardinality = 0;
+        /** Sorted values for array container, pairs of run start and run length
+         * minus one for run container.
+         */
+        std::vector<u16> values;
+        /** Bitset container words. */
+        std::vector<u64> bits;
+
+        /** @return @a true if the value was added. */
+        bool
+        Add(u16 value);
+
+        /** @return @a true if the value was removed. */
+        bool
+        Remove(u16 value);
+
+        bool
+        Contains(u16 value) const;
+
+        /** Find first value not less than the specified one.
+         *
+         * @return Found value, -1 if not found.
+         */
+        int
+        FindFirst(u16 value) const;
+
+        /** Convert to bitset container. */
+        void
+        ToBitset();
+
+        /** Choose between array and bitset representation based on
+         * cardinality.
+         */
+        void
+        Normalize();
+
+        /** Convert to run container if it is more compact. */
+        void
+        RunOptimize();
+
+        /** Get payload size in bytes. */
+        size_t
+        GetPayloadSize() const;
+
+        /** Get bitset words of the container, either own ones or converted
+         * to the provided buffer.
+         */
+        const u64 *
+        GetBits(std::vector<u64> &buf) const;
+    };
+
+    /** High 16 bits of values for each container, sorted. */
+    std::vector<u16> _keys;
+    /** Containers corresponding to the keys. */
+    std::vector<Container> _containers;
+
+    /** Get index of container for the key, or insertion position if not
+     * found.
+     */
+    size_t
+    _FindKey(u16 key) const;
+
+    /** Apply binary operation to all containers.
+     *
+     * @param keepThis Keep containers which exist only in this bitmap.
+     * @param keepOther Copy containers which exist only in the other bitmap.
+     */
+    template <class Op>
+    void
+    _Apply(const CompressedBitmap &other, bool keepThis, bool keepOther, Op op);
+};
+
+} /* namespace adk */
+
+#endif /* ADK_COMPRESSED_BITMAP_H_ */
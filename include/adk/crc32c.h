@@ -0,0 +1,107 @@
+/* This file is a part of ADK library.
+ * Copyright (c) 2012-2015, Artyom Lebedev <artyom.lebedev@gmail.com>
+ * All rights reserved.
+ * See LICENSE file for copyright details.
+ */
+
+/** @file crc32c.h
+ * CRC32C checksum calculation.
+ */
+
+#ifndef CRC32C_H_
+#define CRC32C_H_
+
+namespace adk {
+
+/** CRC-32C (Castagnoli) checksum calculation class. SSE4.2 @a crc32
+ * instruction is used when it is supported by the CPU (detected at run time),
+ * slicing-by-8 table implementation is used otherwise.
+ */
+class Crc32c {
+public:
+    /** Create checksum calculator.
+     *
+     * @param crc Checksum of preceding data if the calculation is continued,
+     *      zero for a new calculation.
+     */
+    Crc32c(u32 crc = 0):
+        _state(~crc)
+    {}
+
+    /** Reset the calculator state.
+     *
+     * @param crc Checksum of preceding data if the calculation is continued,
+     *      zero for a new calculation.
+     */
+    void
+    Reset(u32 crc = 0)
+    {
+        _state = ~crc;
+        _length = 0;
+    }
+
+    /** Feed input data to checksum calculator. This method can be called any
+     * number of times providing next portion of input data. At any time
+     * @ref Get32 method can be called to get current value of checksum.
+     *
+     * @param data Next portion of input data.
+     * @param size Size in bytes of provided data.
+     */
+    void
+    Feed(const void *data, size_t size);
+
+    /** Get checksum of data fed so far. */
+    u32
+    Get32() const
+    {
+        return ~_state;
+    }
+
+    /** Get total length of data fed to the calculator input so far. */
+    size_t
+    GetLength() const
+    {
+        return _length;
+    }
+
+    /** Calculate checksum of the data in one shot.
+     *
+     * @param data Input data.
+     * @param size Size in bytes of the data.
+     * @param crc Checksum of preceding data if the calculation is continued.
+     */
+    static u32
+    Compute(const void *data, size_t size, u32 crc = 0);
+
+    /** Calculate checksum with the table implementation regardless of
+     * hardware support.
+     */
+    static u32
+    ComputeSoftware(const void *data, size_t size, u32 crc = 0);
+
+    /** Get checksum of two concatenated data chunks from checksums of the
+     * chunks. Can be used for merging checksums of chunks calculated in
+     * parallel.
+     *
+     * @param crc1 Checksum of the first chunk.
+     * @param crc2 Checksum of the second chunk.
+     * @param size2 Size in bytes of the second chunk.
+     * @return Checksum of the first chunk followed by the second one.
+     */
+    static u32
+    Combine(u32 crc1, u32 crc2, size_t size2);
+
+    /** Check if hardware accelerated implementation is used. */
+    static bool
+    IsHardwareAccelerated();
+
+private:
+    /** Current CRC register value (inverted checksum). */
+    u32 _state;
+    /** Total length of data consumed by the calculator so far. */
+    size_t _length = 0;
+};
+
+} /* namespace adk */
+
+#endif /* CRC32C_H_ */
@@ -0,0 +1,890 @@
+/* This file is a part of ADK library.
+ * Copyright (c) 2012-2015, Artyom Lebedev <artyom.lebedev@gmail.com>
+ * All rights reserved.
+ * See LICENSE file for copyright details.
+ */
+
+/** @file flat_hash_map.h
+ * Flat open-addressing hash map and set.
+ */
+
+#ifndef FLAT_HASH_MAP_H_
+#define FLAT_HASH_MAP_H_
+
+namespace adk {
+
+/** Default hasher for flat hash containers. Hashes object representation
+ * with @ref Hash so it is suitable for integral, enumeration and pointer
+ * types.
+ */
+template <typename T>
+struct DefaultHash {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Type should be trivially copyable to be hashed by value");
+
+    u64
+    operator()(const T &value) const
+    {
+        return Hash::Compute64(&value, sizeof(value));
+    }
+};
+
+/** Hasher for strings. It is transparent, so lookups can be done by
+ * @ref StringView or C string without creating temporary std::string.
+ */
+template <>
+struct DefaultHash<std::string> {
+    typedef void is_transparent;
+
+    u64
+    operator()(StringView str) const
+    {
+        return Hash::Compute64(str.data(), str.size());
+    }
+};
+
+/** Default equality predicate for flat hash containers. */
+template <typename T>
+struct DefaultEqual: std::equal_to<T> {};
+
+/** Transparent equality predicate for strings. */
+template <>
+struct DefaultEqual<std::string> {
+    typedef void is_transparent;
+
+    bool
+    operator()(StringView a, StringView b) const
+    {
+        return a == b;
+    }
+};
+
+namespace internal {
+
+/** Control byte values. Full slots have non-negative values with seven low
+ * bits of the element hash.
+ */
+enum FlatHashCtrl: i8 {
+    FLAT_HASH_EMPTY = -128,
+    FLAT_HASH_DELETED = -2
+};
+
+/** Group of control bytes which are probed at once. */
+class FlatHashGroup {
+public:
+    /** Number of control bytes in a group. */
+    static constexpr size_t WIDTH = 16;
+
+    FlatHashGroup(const i8 *ctrl)
+    {
+#ifdef __SSE2__
+        _ctrl = _mm_load_si128(reinterpret_cast<const __m128i *>(ctrl));
+#else
+        _ctrl = ctrl;
+#endif
+    }
+
+    /** Get bit mask of slots having the specified control value. */
+    u32
+    Match(i8 value) const
+    {
+#ifdef __SSE2__
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(_ctrl, _mm_set1_epi8(value)));
+#else
+        u32 mask = 0;
+        for (size_t i = 0; i < WIDTH; i++) {
+            if (_ctrl[i] == value) {
+                mask |= 1u << i;
+            }
+        }
+        return mask;
+#endif
+    }
+
+    /** Get bit mask of empty slots. */
+    u32
+    MatchEmpty() const
+    {
+        return Match(FLAT_HASH_EMPTY);
+    }
+
+    /** Get bit mask of empty or deleted slots. */
+    u32
+    MatchFree() const
+    {
+#ifdef __SSE2__
+        /* Only free slots have the sign bit set. */
+        return _mm_movemask_epi8(_ctrl);
+#else
+        u32 mask = 0;
+        for (size_t i = 0; i < WIDTH; i++) {
+            if (_ctrl[i] < 0) {
+                mask |= 1u << i;
+            }
+        }
+        return mask;
+#endif
+    }
+
+private:
+#ifdef __SSE2__
+    __m128i _ctrl;
+#else
+    const i8 *_ctrl;
+#endif
+};
+
+/** Helper for detecting member types. */
+template <class... T>
+struct FlatHashVoid {
+    typedef void type;
+};
+
+/** Check whether the hasher and the predicate allow heterogeneous lookup. */
+template <class THash, class TEqual, class = void>
+struct FlatHashIsTransparent: std::false_type {};
+
+template <class THash, class TEqual>
+struct FlatHashIsTransparent<
+    THash, TEqual,
+    typename FlatHashVoid<typename THash::is_transparent,
+                          typename TEqual::is_transparent>::type>: std::true_type {};
+
+/** Open-addressing hash table with SwissTable-style control bytes. Slots are
+ * split into groups of 16, each slot has a control byte which is either
+ * empty, deleted or holds seven bits of the element hash. Probing compares
+ * the whole group of control bytes with one SIMD instruction and checks keys
+ * only for matching bytes. Groups are probed in triangular sequence, the
+ * maximal load factor is 7/8.
+ *
+ * @param TValue Stored value type.
+ * @param TKeyOf Functor which extracts key from the value.
+ */
+template <class TKey, class TValue, class TKeyOf, class THash, class TEqual,
+          class Allocator>
+class FlatHashTable {
+private:
+    /** Lookup key type. Keys of other types are converted to the table key
+     * type once per lookup unless heterogeneous lookup is supported.
+     */
+    template <class K>
+    using LookupKey = typename std::conditional<
+        FlatHashIsTransparent<THash, TEqual>::value || std::is_same<K, TKey>::value,
+        const K &, TKey>::type;
+
+public:
+    typedef TKey key_type;
+    typedef TValue value_type;
+    typedef size_t size_type;
+
+    /** Forward iterator over the table elements. */
+    template <bool isConst>
+    class Iterator {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef TValue value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef typename std::conditional<isConst, const TValue *, TValue *>::type pointer;
+        typedef typename std::conditional<isConst, const TValue &, TValue &>::type reference;
+
+        Iterator() = default;
+
+        /** Mutable iterator is convertible to constant one. */
+        template <bool otherConst,
+                  typename = typename std::enable_if<isConst && !otherConst>::type>
+        Iterator(const Iterator<otherConst> &other):
+            _ctrl(other._ctrl), _ctrlEnd(other._ctrlEnd), _slot(other._slot)
+        {}
+
+        reference
+        operator *() const
+        {
+            return *_slot;
+        }
+
+        pointer
+        operator ->() const
+        {
+            return _slot;
+        }
+
+        Iterator &
+        operator ++()
+        {
+            _ctrl++;
+            _slot++;
+            _SkipFree();
+            return *this;
+        }
+
+        Iterator
+        operator ++(int)
+        {
+            Iterator it = *this;
+            ++*this;
+            return it;
+        }
+
+        bool
+        operator ==(const Iterator &other) const
+        {
+            return _ctrl == other._ctrl;
+        }
+
+        bool
+        operator !=(const Iterator &other) const
+        {
+            return _ctrl != other._ctrl;
+        }
+
+    private:
+        friend class FlatHashTable;
+        template <bool>
+        friend class Iterator;
+
+        const i8 *_ctrl = nullptr, *_ctrlEnd = nullptr;
+        pointer _slot = nullptr;
+
+        Iterator(const i8 *ctrl, const i8 *ctrlEnd, pointer slot):
+            _ctrl(ctrl), _ctrlEnd(ctrlEnd), _slot(slot)
+        {}
+
+        void
+        _SkipFree()
+        {
+            while (_ctrl < _ctrlEnd && *_ctrl < 0) {
+                _ctrl++;
+                _slot++;
+            }
+        }
+    };
+
+    typedef Iterator<false> iterator;
+    typedef Iterator<true> const_iterator;
+
+    FlatHashTable(size_t capacity = 0, const THash &hasher = THash(),
+                  const TEqual &equal = TEqual(), const Allocator &alloc = Allocator()):
+        _hasher(hasher), _equal(equal), _ctrlAlloc(alloc), _slotAlloc(alloc)
+    {
+        Reserve(capacity);
+    }
+
+    FlatHashTable(const FlatHashTable &other):
+        FlatHashTable(other._size, other._hasher, other._equal,
+                      Allocator(SlotAllocTraits::select_on_container_copy_construction(
+                          other._slotAlloc)))
+    {
+        for (const TValue &value: other) {
+            _InsertUnique(_hasher(_keyOf(value)), value);
+        }
+    }
+
+    FlatHashTable(FlatHashTable &&other):
+        _hasher(std::move(other._hasher)), _equal(std::move(other._equal)),
+        _ctrlAlloc(std::move(other._ctrlAlloc)), _slotAlloc(std::move(other._slotAlloc))
+    {
+        _Steal(other);
+    }
+
+    ~FlatHashTable()
+    {
+        _Destroy();
+    }
+
+    FlatHashTable &
+    operator =(const FlatHashTable &other)
+    {
+        if (this != &other) {
+            FlatHashTable tmp(other);
+            *this = std::move(tmp);
+        }
+        return *this;
+    }
+
+    FlatHashTable &
+    operator =(FlatHashTable &&other)
+    {
+        if (this != &other) {
+            _Destroy();
+            _hasher = std::move(other._hasher);
+            _equal = std::move(other._equal);
+            _MoveAssign(other,
+                        typename SlotAllocTraits::propagate_on_container_move_assignment());
+        }
+        return *this;
+    }
+
+    /** Get number of elements. */
+    size_t
+    Size() const
+    {
+        return _size;
+    }
+
+    bool
+    IsEmpty() const
+    {
+        return !_size;
+    }
+
+    /** Get number of slots in the table. */
+    size_t
+    Capacity() const
+    {
+        return _capacity;
+    }
+
+    /** Remove all elements. Storage is not released. */
+    void
+    Clear()
+    {
+        if (!_capacity) {
+            return;
+        }
+        for (size_t i = 0; i < _capacity; i++) {
+            if (_ctrl[i] >= 0) {
+                _slots[i].~TValue();
+            }
+        }
+        memset(_ctrl, FLAT_HASH_EMPTY, _capacity);
+        _size = 0;
+        _growthLeft = _MaxLoad(_capacity);
+    }
+
+    /** Ensure the table can hold the specified number of elements without
+     * rehashing.
+     */
+    void
+    Reserve(size_t numElements)
+    {
+        if (numElements > _size + _growthLeft) {
+            size_t capacity = FlatHashGroup::WIDTH;
+            while (_MaxLoad(capacity) < numElements) {
+                capacity *= 2;
+            }
+            _Rehash(capacity);
+        }
+    }
+
+    iterator
+    begin()
+    {
+        iterator it(_ctrl, _ctrl + _capacity, _slots);
+        it._SkipFree();
+        return it;
+    }
+
+    iterator
+    end()
+    {
+        return iterator(_ctrl + _capacity, _ctrl + _capacity, _slots + _capacity);
+    }
+
+    const_iterator
+    begin() const
+    {
+        return const_cast<FlatHashTable *>(this)->begin();
+    }
+
+    const_iterator
+    end() const
+    {
+        return const_cast<FlatHashTable *>(this)->end();
+    }
+
+    /** Find element by key.
+     *
+     * @return Iterator pointing to the found element, @ref end if not found.
+     */
+    template <class K>
+    iterator
+    Find(const K &key)
+    {
+        LookupKey<K> k = key;
+        size_t idx = _Find(k, _hasher(k));
+        return idx == NOT_FOUND ? end() : _MakeIterator(idx);
+    }
+
+    template <class K>
+    const_iterator
+    Find(const K &key) const
+    {
+        return const_cast<FlatHashTable *>(this)->Find(key);
+    }
+
+    /** Check if element with the specified key exists. */
+    template <class K>
+    bool
+    Contains(const K &key) const
+    {
+        LookupKey<K> k = key;
+        return _Find(k, _hasher(k)) != NOT_FOUND;
+    }
+
+    /** Remove element with the specified key.
+     *
+     * @return Number of removed elements.
+     */
+    template <class K>
+    size_t
+    Erase(const K &key)
+    {
+        LookupKey<K> k = key;
+        size_t idx = _Find(k, _hasher(k));
+        if (idx == NOT_FOUND) {
+            return 0;
+        }
+        _EraseSlot(idx);
+        return 1;
+    }
+
+    /** Remove element pointed by the iterator. */
+    void
+    Erase(const_iterator it)
+    {
+        _EraseSlot(it._ctrl - _ctrl);
+    }
+
+    void
+    Erase(iterator it)
+    {
+        _EraseSlot(it._ctrl - _ctrl);
+    }
+
+protected:
+    /** Find element by key or insert a new one if not found.
+     *
+     * @param key Key to look up.
+     * @param construct Functor which is called with slot address for
+     *      constructing a new element in-place.
+     * @return Iterator pointing to the element and @a true if it was
+     *      inserted.
+     */
+    template <class K, class Construct>
+    std::pair<iterator, bool>
+    _FindOrInsert(const K &key, Construct &&construct)
+    {
+        LookupKey<K> k = key;
+        u64 hash = _hasher(k);
+        size_t idx = _Find(k, hash);
+        if (idx != NOT_FOUND) {
+            return std::make_pair(_MakeIterator(idx), false);
+        }
+        idx = _PrepareInsert(hash);
+        construct(&_slots[idx]);
+        _ctrl[idx] = _H2(hash);
+        _size++;
+        return std::make_pair(_MakeIterator(idx), true);
+    }
+
+private:
+    static constexpr size_t NOT_FOUND = static_cast<size_t>(-1);
+
+    typedef typename std::allocator_traits<Allocator>::template rebind_alloc<i8> CtrlAllocator;
+    typedef typename std::allocator_traits<Allocator>::template rebind_alloc<TValue> SlotAllocator;
+    typedef std::allocator_traits<SlotAllocator> SlotAllocTraits;
+
+    THash _hasher;
+    TEqual _equal;
+    TKeyOf _keyOf;
+    CtrlAllocator _ctrlAlloc;
+    SlotAllocator _slotAlloc;
+    /** Control bytes, aligned to the group size. */
+    i8 *_ctrl = nullptr;
+    /** Elements storage. */
+    TValue *_slots = nullptr;
+    /** Number of slots, zero or power of two not less than group size. */
+    size_t _capacity = 0;
+    /** Number of elements. */
+    size_t _size = 0;
+    /** Number of elements which can be inserted into empty slots before
+     * rehashing is required.
+     */
+    size_t _growthLeft = 0;
+    /** Original pointer to control bytes storage for deallocation. */
+    i8 *_ctrlStorage = nullptr;
+
+    /** Maximal number of elements for the capacity. */
+    static constexpr size_t
+    _MaxLoad(size_t capacity)
+    {
+        return capacity - capacity / 8;
+    }
+
+    /** Hash bits used for group index. */
+    static constexpr size_t
+    _H1(u64 hash)
+    {
+        return hash >> 7;
+    }
+
+    /** Hash bits stored in control byte. */
+    static constexpr i8
+    _H2(u64 hash)
+    {
+        return static_cast<i8>(hash & 0x7f);
+    }
+
+    iterator
+    _MakeIterator(size_t idx)
+    {
+        return iterator(&_ctrl[idx], _ctrl + _capacity, &_slots[idx]);
+    }
+
+    /** Find slot index of the element. */
+    template <class K>
+    size_t
+    _Find(const K &key, u64 hash) const
+    {
+        if (!_capacity) {
+            return NOT_FOUND;
+        }
+        size_t groupMask = _capacity / FlatHashGroup::WIDTH - 1;
+        size_t groupIdx = _H1(hash) & groupMask;
+        i8 h2 = _H2(hash);
+        for (size_t step = 1; ; step++) {
+            size_t base = groupIdx * FlatHashGroup::WIDTH;
+            FlatHashGroup group(&_ctrl[base]);
+            for (u32 mask = group.Match(h2); mask; mask &= mask - 1) {
+                size_t idx = base + CountTrailingZeros(mask);
+                if (_equal(_keyOf(_slots[idx]), key)) {
+                    return idx;
+                }
+            }
+            if (group.MatchEmpty()) {
+                return NOT_FOUND;
+            }
+            groupIdx = (groupIdx + step) & groupMask;
+        }
+    }
+
+    /** Find first free slot in the probe sequence for the hash. */
+    size_t
+    _FindFree(u64 hash) const
+    {
+        size_t groupMask = _capacity / FlatHashGroup::WIDTH - 1;
+        size_t groupIdx = _H1(hash) & groupMask;
+        for (size_t step = 1; ; step++) {
+            size_t base = groupIdx * FlatHashGroup::WIDTH;
+            u32 mask = FlatHashGroup(&_ctrl[base]).MatchFree();
+            if (mask) {
+                return base + CountTrailingZeros(mask);
+            }
+            groupIdx = (groupIdx + step) & groupMask;
+        }
+    }
+
+    /** Get slot for a new element, growing the table if necessary. */
+    size_t
+    _PrepareInsert(u64 hash)
+    {
+        if (!_growthLeft) {
+            /* Rehash in place if most of the load is tombstones. */
+            if (_capacity && _size <= _MaxLoad(_capacity) / 2) {
+                _Rehash(_capacity);
+            } else {
+                _Rehash(_capacity ? _capacity * 2 : FlatHashGroup::WIDTH);
+            }
+        }
+        size_t idx = _FindFree(hash);
+        if (_ctrl[idx] == FLAT_HASH_EMPTY) {
+            _growthLeft--;
+        }
+        return idx;
+    }
+
+    /** Insert element which is known to be absent. */
+    template <class V>
+    void
+    _InsertUnique(u64 hash, V &&value)
+    {
+        size_t idx = _PrepareInsert(hash);
+        new(&_slots[idx]) TValue(std::forward<V>(value));
+        _ctrl[idx] = _H2(hash);
+        _size++;
+    }
+
+    void
+    _EraseSlot(size_t idx)
+    {
+        ASSERT(_ctrl[idx] >= 0);
+        _slots[idx].~TValue();
+        _size--;
+        /* If the group has an empty slot, no probe sequence has ever passed
+         * through it, so the slot can be made empty instead of tombstone.
+         */
+        size_t base = idx & ~(FlatHashGroup::WIDTH - 1);
+        if (FlatHashGroup(&_ctrl[base]).MatchEmpty()) {
+            _ctrl[idx] = FLAT_HASH_EMPTY;
+            _growthLeft++;
+        } else {
+            _ctrl[idx] = FLAT_HASH_DELETED;
+        }
+    }
+
+    /** Move all elements to new storage with the specified capacity. */
+    void
+    _Rehash(size_t capacity)
+    {
+        i8 *oldCtrl = _ctrl, *oldCtrlStorage = _ctrlStorage;
+        TValue *oldSlots = _slots;
+        size_t oldCapacity = _capacity;
+
+        /* Over-allocate control bytes to align them for group loads. */
+        _ctrlStorage = _ctrlAlloc.allocate(capacity + FlatHashGroup::WIDTH);
+        _ctrl = reinterpret_cast<i8 *>(
+            RoundUp2(reinterpret_cast<uintptr_t>(_ctrlStorage), FlatHashGroup::WIDTH));
+        memset(_ctrl, FLAT_HASH_EMPTY, capacity);
+        _slots = _slotAlloc.allocate(capacity);
+        _capacity = capacity;
+        _growthLeft = _MaxLoad(capacity) - _size;
+
+        for (size_t i = 0; i < oldCapacity; i++) {
+            if (oldCtrl[i] < 0) {
+                continue;
+            }
+            TValue &value = oldSlots[i];
+            u64 hash = _hasher(_keyOf(value));
+            size_t idx = _FindFree(hash);
+            new(&_slots[idx]) TValue(_keyOf.Move(value));
+            _ctrl[idx] = _H2(hash);
+            value.~TValue();
+        }
+        if (oldCapacity) {
+            _ctrlAlloc.deallocate(oldCtrlStorage, oldCapacity + FlatHashGroup::WIDTH);
+            _slotAlloc.deallocate(oldSlots, oldCapacity);
+        }
+    }
+
+    void
+    _Destroy()
+    {
+        if (!_capacity) {
+            return;
+        }
+        for (size_t i = 0; i < _capacity; i++) {
+            if (_ctrl[i] >= 0) {
+                _slots[i].~TValue();
+            }
+        }
+        _ctrlAlloc.deallocate(_ctrlStorage, _capacity + FlatHashGroup::WIDTH);
+        _slotAlloc.deallocate(_slots, _capacity);
+        _ctrl = _ctrlStorage = nullptr;
+        _slots = nullptr;
+        _capacity = _size = _growthLeft = 0;
+    }
+
+    void
+    _MoveAssign(FlatHashTable &other, std::true_type)
+    {
+        _ctrlAlloc = std::move(other._ctrlAlloc);
+        _slotAlloc = std::move(other._slotAlloc);
+        _Steal(other);
+    }
+
+    /** Allocators are not propagated, so the storage can be taken only if it
+     * can be released by this table allocators, otherwise the elements are
+     * moved one by one.
+     */
+    void
+    _MoveAssign(FlatHashTable &other, std::false_type)
+    {
+        if (_ctrlAlloc == other._ctrlAlloc && _slotAlloc == other._slotAlloc) {
+            _Steal(other);
+            return;
+        }
+        Reserve(other._size);
+        for (size_t i = 0; i < other._capacity; i++) {
+            if (other._ctrl[i] >= 0) {
+                TValue &value = other._slots[i];
+                _InsertUnique(_hasher(_keyOf(value)), _keyOf.Move(value));
+            }
+        }
+        other._Destroy();
+    }
+
+    /** Take storage from another table leaving it empty. */
+    void
+    _Steal(FlatHashTable &other)
+    {
+        _ctrl = other._ctrl;
+        _ctrlStorage = other._ctrlStorage;
+        _slots = other._slots;
+        _capacity = other._capacity;
+        _size = other._size;
+        _growthLeft = other._growthLeft;
+        other._ctrl = other._ctrlStorage = nullptr;
+        other._slots = nullptr;
+        other._capacity = other._size = other._growthLeft = 0;
+    }
+};
+
+/** Key extractor for map elements. */
+template <class TKey, class TValue>
+struct FlatHashMapKeyOf {
+    const TKey &
+    operator()(const TValue &value) const
+    {
+        return value.first;
+    }
+
+    /** Get rvalue for moving the element during rehash. Key is constant in
+     * the element type but the source is destroyed right after the move.
+     */
+    std::pair<TKey &&, typename TValue::second_type &&>
+    Move(TValue &value) const
+    {
+        return std::pair<TKey &&, typename TValue::second_type &&>(
+            std::move(const_cast<TKey &>(value.first)), std::move(value.second));
+    }
+};
+
+/** Key extractor for set elements. */
+template <class TKey>
+struct FlatHashSetKeyOf {
+    const TKey &
+    operator()(const TKey &value) const
+    {
+        return value;
+    }
+
+    TKey &&
+    Move(TKey &value) const
+    {
+        return std::move(value);
+    }
+};
+
+} /* namespace internal */
+
+/** Flat open-addressing hash map. Elements are stored in a single array so
+ * lookups do not chase pointers, see internal::FlatHashTable for the layout.
+ * Iterators and references are invalidated by insertions which cause
+ * rehashing. Lookup methods accept any key type supported by the hasher and
+ * the predicate when both are transparent, e.g. @ref StringView or C string
+ * for std::string keys.
+ */
+template <class TKey, class T, class THash = DefaultHash<TKey>,
+          class TEqual = DefaultEqual<TKey>,
+          class Allocator = std::allocator<std::pair<const TKey, T>>>
+class FlatHashMap:
+    public internal::FlatHashTable<TKey, std::pair<const TKey, T>,
+                                   internal::FlatHashMapKeyOf<TKey, std::pair<const TKey, T>>,
+                                   THash, TEqual, Allocator> {
+private:
+    typedef internal::FlatHashTable<TKey, std::pair<const TKey, T>,
+                                    internal::FlatHashMapKeyOf<TKey, std::pair<const TKey, T>>,
+                                    THash, TEqual, Allocator> BaseT;
+public:
+    typedef T mapped_type;
+    using typename BaseT::value_type;
+    using typename BaseT::iterator;
+    using typename BaseT::const_iterator;
+
+    using BaseT::BaseT;
+
+    /** Insert the element if its key is not yet in the map.
+     *
+     * @return Iterator pointing to the element with the key and @a true if
+     *      the element was inserted.
+     */
+    std::pair<iterator, bool>
+    Insert(const value_type &value)
+    {
+        return BaseT::_FindOrInsert(value.first, [&](void *slot) {
+            new(slot) value_type(value);
+        });
+    }
+
+    std::pair<iterator, bool>
+    Insert(value_type &&value)
+    {
+        return BaseT::_FindOrInsert(value.first, [&](void *slot) {
+            new(slot) value_type(std::move(value));
+        });
+    }
+
+    /** Construct the mapped value from the arguments if the key is not yet in
+     * the map. The arguments are not used if the key exists.
+     *
+     * @return Iterator pointing to the element with the key and @a true if
+     *      the element was inserted.
+     */
+    template <class K, class... Args>
+    std::pair<iterator, bool>
+    TryEmplace(K &&key, Args &&... args)
+    {
+        return BaseT::_FindOrInsert(key, [&](void *slot) {
+            new(slot) value_type(std::piecewise_construct,
+                                 std::forward_as_tuple(std::forward<K>(key)),
+                                 std::forward_as_tuple(std::forward<Args>(args)...));
+        });
+    }
+
+    /** Get reference to the mapped value, default-constructed one is
+     * inserted if the key is not found.
+     */
+    template <class K>
+    T &
+    operator [](K &&key)
+    {
+        return TryEmplace(std::forward<K>(key)).first->second;
+    }
+
+    /** Get reference to the mapped value.
+     *
+     * @throws InvalidParamException if the key is not found.
+     */
+    template <class K>
+    T &
+    At(const K &key)
+    {
+        auto it = this->Find(key);
+        if (it == this->end()) {
+            ADK_EXCEPTION(InvalidParamException, "Key not found");
+        }
+        return it->second;
+    }
+
+    template <class K>
+    const T &
+    At(const K &key) const
+    {
+        return const_cast<FlatHashMap *>(this)->At(key);
+    }
+};
+
+/** Flat open-addressing hash set. See @ref FlatHashMap for details. */
+template <class TKey, class THash = DefaultHash<TKey>, class TEqual = DefaultEqual<TKey>,
+          class Allocator = std::allocator<TKey>>
+class FlatHashSet:
+    public internal::FlatHashTable<TKey, TKey, internal::FlatHashSetKeyOf<TKey>,
+                                   THash, TEqual, Allocator> {
+private:
+    typedef internal::FlatHashTable<TKey, TKey, internal::FlatHashSetKeyOf<TKey>,
+                                    THash, TEqual, Allocator> BaseT;
+public:
+    using typename BaseT::iterator;
+    using typename BaseT::const_iterator;
+
+    using BaseT::BaseT;
+
+    /** Insert the key if it is not yet in the set. Key of other type is
+     * converted to the set key type only if it is inserted.
+     *
+     * @return Iterator pointing to the element and @a true if it was
+     *      inserted.
+     */
+    template <class K>
+    std::pair<iterator, bool>
+    Insert(K &&key)
+    {
+        return BaseT::_FindOrInsert(key, [&](void *slot) {
+            new(slot) TKey(std::forward<K>(key));
+        });
+    }
+};
+
+} /* namespace adk */
+
+#endif /* FLAT_HASH_MAP_H_ */
@@ -44,8 +44,16 @@ public:
      * @param b The second word.
      * @param c The third word.
      */
-    static void
-    Mix(u32 &a, u32 &b, u32 &c);
+    static constexpr void
+    Mix(u32 &a, u32 &b, u32 &c)
+    {
+        a -= c; a ^= RotL(c, 4);    c += b;
+        b -= a; b ^= RotL(a, 6);    a += c;
+        c -= b; c ^= RotL(b, 8);    b += a;
+        a -= c; a ^= RotL(c, 16);   c += b;
+        b -= a; b ^= RotL(a, 19);   a += c;
+        c -= b; c ^= RotL(b, 4);    b += a;
+    }
 
     /** Final mixing of three 32-bits words.
      *
@@ -53,8 +61,83 @@ public:
      * @param b The second word.
      * @param c The third word. Result is returned in this argument.
      */
-    static void
-    Final(u32 &a, u32 &b, u32 &c);
+    static constexpr void
+    Final(u32 &a, u32 &b, u32 &c)
+    {
+        c ^= b; c -= RotL(b, 14);
+        a ^= c; a -= RotL(c, 11);
+        b ^= a; b -= RotL(a, 25);
+        c ^= b; c -= RotL(b, 16);
+        a ^= c; a -= RotL(c, 4);
+        b ^= a; b -= RotL(a, 14);
+        c ^= b; c -= RotL(b, 24);
+    }
+
+    /** Calculate 32-bits hash of a characters string at compile time. The
+     * result is the same as @ref Compute32 for the same data, so it can be
+     * used for dispatching strings in a @a switch statement.
+     *
+     * @param str Characters string.
+     * @param size Number of characters.
+     * @param initial Initial value for a hash. It can be used as salt.
+     * @return 32-bits hash value.
+     */
+    static constexpr u32
+    ConstCompute32(const char *str, size_t size, u32 initial = 0)
+    {
+        u32 a = INITIAL_VALUE + initial, b = a, c = a;
+        size_t offset = 0;
+        for (; size - offset >= 12; offset += 12) {
+            a += _ConstGetWord(&str[offset]);
+            b += _ConstGetWord(&str[offset + 4]);
+            c += _ConstGetWord(&str[offset + 8]);
+            Mix(a, b, c);
+        }
+        /* Trailing remainder is applied in little-endian order. */
+        u32 tail[3] = {0, 0, 0};
+        for (size_t i = 0; offset + i < size; i++) {
+            tail[i / 4] += static_cast<u32>(static_cast<u8>(str[offset + i])) << (i % 4 * NBBY);
+        }
+        a += tail[0] + size;
+        b += tail[1] + size;
+        c += tail[2] + size;
+        Final(a, b, c);
+        return c;
+    }
+
+    /** Calculate 32-bits hash of the data in one shot. The result is the
+     * same as feeding the data to a new hash object and calling @ref Get32
+     * but it avoids incremental state bookkeeping, so it is preferable for
+     * hashing many short keys.
+     *
+     * @param data Input data.
+     * @param size Size in bytes of the data.
+     * @param initial Initial value for a hash. It can be used as salt.
+     * @return 32-bits hash value.
+     */
+    static u32
+    Compute32(const void *data, size_t size, u32 initial = 0)
+    {
+        u32 a, b, c;
+        _Compute(data, size, initial, a, b, c);
+        return c;
+    }
+
+    /** Calculate 64-bits hash of the data in one shot. The result is the
+     * same as feeding the data to a new hash object and calling @ref Get64.
+     *
+     * @param data Input data.
+     * @param size Size in bytes of the data.
+     * @param initial Initial value for a hash. It can be used as salt.
+     * @return 64-bits hash value.
+     */
+    static u64
+    Compute64(const void *data, size_t size, u32 initial = 0)
+    {
+        u32 a, b, c;
+        _Compute(data, size, initial, a, b, c);
+        return (static_cast<u64>(b) << 32) | c;
+    }
 
     /** Feed input data to hash calculator. This method can be called any number
      * of times providing next portion of input data. At any time @ref Get32 or
@@ -146,6 +229,214 @@ private:
      */
     void
     _Finalize(u32 &a, u32 &b, u32 &c);
+
+    /** Get 32-bits word in native byte order at compile time. */
+    static constexpr u32
+    _ConstGetWord(const char *p)
+    {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        return (static_cast<u32>(static_cast<u8>(p[0])) << 24) |
+               (static_cast<u32>(static_cast<u8>(p[1])) << 16) |
+               (static_cast<u32>(static_cast<u8>(p[2])) << 8) |
+               static_cast<u32>(static_cast<u8>(p[3]));
+#else
+        return static_cast<u32>(static_cast<u8>(p[0])) |
+               (static_cast<u32>(static_cast<u8>(p[1])) << 8) |
+               (static_cast<u32>(static_cast<u8>(p[2])) << 16) |
+               (static_cast<u32>(static_cast<u8>(p[3])) << 24);
+#endif
+    }
+
+    /** Calculate final accumulators values for the data in one shot.
+     * Arguments should not be initialized - the method returns result in
+     * them.
+     */
+    static void
+    _Compute(const void *data, size_t size, u32 initial, u32 &a, u32 &b, u32 &c);
+};
+
+/** Compile-time string hash literal, e.g. "name"_adkhash. The value is equal
+ * to Hash::Compute32() of the string characters (without terminating null
+ * character).
+ */
+constexpr u32
+operator "" _adkhash(const char *str, size_t size)
+{
+    return Hash::ConstCompute32(str, size);
+}
+
+/** High-throughput 64-bits non-cryptographic hash based on 64x64->128 bits
+ * multiply-mix operation. The input is processed in 32 bytes blocks by two
+ * independent lanes. Streaming interface mirrors @ref Hash.
+ */
+class MumHash {
+public:
+    /** Create hash object.
+     *
+     * @param seed Seed value for a hash.
+     */
+    MumHash(u64 seed = 0)
+    {
+        Reset(seed);
+    }
+
+    /** Reset the calculator state to the initial one.
+     *
+     * @param seed Seed value for a hash.
+     */
+    void
+    Reset(u64 seed = 0);
+
+    /** Feed input data to hash calculator. This method can be called any number
+     * of times providing next portion of input data. At any time @ref Get64
+     * can be called to get current value of hash.
+     *
+     * @param data Next portion of input data.
+     * @param size Size in bytes of provided data.
+     */
+    void
+    Feed(const void *data, size_t size);
+
+    /** Get 64-bits hash value based on data fed so far. */
+    u64
+    Get64() const;
+
+    /** Get total length of data fed to the calculator input so far. */
+    size_t
+    GetLength() const
+    {
+        return _length;
+    }
+
+    /** Calculate hash of the data in one shot. The result is the same as
+     * feeding the data to a new hash object and calling @ref Get64.
+     */
+    static u64
+    Compute64(const void *data, size_t size, u64 seed = 0);
+
+private:
+    enum {
+        /** Size of input block. */
+        BLOCK_SIZE = 32
+    };
+
+    /** Lanes state. */
+    u64 _s0, _s1;
+    /** Buffered bytes of incomplete block. */
+    u8 _buf[BLOCK_SIZE];
+    /** Number of bytes in the buffer. */
+    size_t _bufSize;
+    /** Total length of data consumed by the calculator so far. */
+    size_t _length;
+};
+
+/** High-throughput 128-bits non-cryptographic hash. The input is processed in
+ * 64 bytes stripes by eight 64-bits accumulators using 32x32->64 bits
+ * multiplications, so the main loop maps directly onto SSE2/AVX2 vector
+ * instructions. Streaming interface mirrors @ref Hash.
+ */
+class Hash128 {
+public:
+    /** 128-bits hash value. */
+    struct Value {
+        u64 low, high;
+
+        bool
+        operator==(const Value &other) const
+        {
+            return low == other.low && high == other.high;
+        }
+
+        bool
+        operator!=(const Value &other) const
+        {
+            return !(*this == other);
+        }
+    };
+
+    /** Create hash object.
+     *
+     * @param seed Seed value for a hash.
+     */
+    Hash128(u64 seed = 0)
+    {
+        Reset(seed);
+    }
+
+    /** Reset the calculator state to the initial one.
+     *
+     * @param seed Seed value for a hash.
+     */
+    void
+    Reset(u64 seed = 0);
+
+    /** Feed input data to hash calculator. This method can be called any number
+     * of times providing next portion of input data. At any time @ref Get64
+     * or @ref Get128 can be called to get current value of hash.
+     *
+     * @param data Next portion of input data.
+     * @param size Size in bytes of provided data.
+     */
+    void
+    Feed(const void *data, size_t size);
+
+    /** Get 128-bits hash value based on data fed so far. */
+    Value
+    Get128() const;
+
+    /** Get 64-bits hash value based on data fed so far. It is the low part of
+     * the 128-bits value.
+     */
+    u64
+    Get64() const
+    {
+        return Get128().low;
+    }
+
+    /** Get total length of data consumed by the calculator so far. */
+    size_t
+    GetLength() const
+    {
+        return _length;
+    }
+
+    /** Calculate hash of the data in one shot. The result is the same as
+     * feeding the data to a new hash object and calling @ref Get128.
+     */
+    static Value
+    Compute128(const void *data, size_t size, u64 seed = 0);
+
+private:
+    enum {
+        /** Number of accumulators. */
+        NUM_ACC = 8,
+        /** Size of input stripe. */
+        STRIPE_SIZE = NUM_ACC * sizeof(u64),
+        /** Accumulators are scrambled after this number of stripes. */
+        STRIPES_PER_BLOCK = 16
+    };
+
+    /** Accumulators. */
+    u64 _acc[NUM_ACC];
+    /** Seed-dependent keys for accumulators. */
+    u64 _secret[NUM_ACC];
+    /** Buffered bytes of incomplete stripe. */
+    u8 _buf[STRIPE_SIZE];
+    /** Number of bytes in the buffer. */
+    size_t _bufSize;
+    /** Number of stripes processed in the current block. */
+    size_t _numStripes;
+    /** Total length of data consumed by the calculator so far. */
+    size_t _length;
+
+    /** Consume one stripe. */
+    void
+    _Stripe(const u8 *data);
+
+    /** Calculate final value from the accumulators and trailing data. */
+    static Value
+    _Finalize(const u64 *acc, const u64 *secret, const u8 *tail, size_t tailSize,
+              size_t length);
 };
 
 } /* namespace adk */
@@ -11,6 +11,245 @@
 
 namespace adk {
 
+namespace internal {
+
+/** Ziggurat algorithm tables for a monotonically decreasing density. */
+struct ZigguratTable {
+    enum {
+        NUM_LAYERS = 256
+    };
+
+    /** Layers right edges, decreasing. The base layer width includes the
+     * tail area, the last edge is zero.
+     */
+    double x[NUM_LAYERS + 1];
+    /** Density values at the layers edges. */
+    double f[NUM_LAYERS + 1];
+    /** Tail start. */
+    double r;
+};
+
+/** Tables for standard normal distribution. */
+const ZigguratTable &
+GetNormalZigguratTable();
+
+/** Tables for standard exponential distribution. */
+const ZigguratTable &
+GetExponentialZigguratTable();
+
+/** Convert random bits to double in range [0; 1). */
+inline double
+BitsToDouble(u64 bits)
+{
+    return static_cast<double>(bits >> 11) * (1.0 / (static_cast<u64>(1) << 53));
+}
+
+/** Multiply two 64-bits values into 128-bits result.
+ *
+ * @param hi Receives high 64 bits of the product.
+ * @return Low 64 bits of the product.
+ */
+inline u64
+MulWide(u64 a, u64 b, u64 &hi)
+{
+#ifdef __SIZEOF_INT128__
+    unsigned __int128 p = static_cast<unsigned __int128>(a) * b;
+    hi = static_cast<u64>(p >> 64);
+    return static_cast<u64>(p);
+#else
+    u64 aLo = a & 0xffffffff, aHi = a >> 32, bLo = b & 0xffffffff, bHi = b >> 32;
+    u64 pLo = aLo * bLo, mid1 = aHi * bLo, mid2 = aLo * bHi;
+    u64 carry = ((pLo >> 32) + (mid1 & 0xffffffff) + (mid2 & 0xffffffff)) >> 32;
+    hi = aHi * bHi + (mid1 >> 32) + (mid2 >> 32) + carry;
+    return pLo + (mid1 << 32) + (mid2 << 32);
+#endif
+}
+
+/** Get unbiased random integer in range [0; range) by Lemire's
+ * multiply-shift method. Division is needed only when the first candidate
+ * falls into the possibly biased zone, which is rare for small ranges.
+ *
+ * @param bits Callable returning random 32-bits values.
+ * @param range Number of values, non-zero.
+ */
+template <class TBits>
+u32
+Bounded32(TBits &&bits, u32 range)
+{
+    u64 m = static_cast<u64>(bits()) * range;
+    u32 low = static_cast<u32>(m);
+    if (low < range) {
+        u32 threshold = -range % range;
+        while (low < threshold) {
+            m = static_cast<u64>(bits()) * range;
+            low = static_cast<u32>(m);
+        }
+    }
+    return m >> 32;
+}
+
+/** 64-bits version of @ref Bounded32.
+ *
+ * @param bits Callable returning random 64-bits values.
+ * @param range Number of values, non-zero.
+ */
+template <class TBits>
+u64
+Bounded64(TBits &&bits, u64 range)
+{
+    u64 hi, low = MulWide(bits(), range, hi);
+    if (low < range) {
+        u64 threshold = -range % range;
+        while (low < threshold) {
+            low = MulWide(bits(), range, hi);
+        }
+    }
+    return hi;
+}
+
+/** Get unbiased random integer in range [lo; hi].
+ *
+ * @param bits32 Callable returning random 32-bits values.
+ * @param bits64 Callable returning random 64-bits values.
+ */
+template <typename T, class TBits32, class TBits64>
+T
+Uniform(T lo, T hi, TBits32 &&bits32, TBits64 &&bits64)
+{
+    static_assert(std::is_integral<T>::value, "Integral type expected");
+    typedef typename std::make_unsigned<T>::type U;
+    ASSERT(lo <= hi);
+    u64 range = static_cast<U>(static_cast<U>(hi) - static_cast<U>(lo));
+    u64 offset;
+    if (range < MAX_U32) {
+        offset = Bounded32(bits32, range + 1);
+    } else if (range == MAX_U32) {
+        offset = bits32();
+    } else if (range < MAX_U64) {
+        offset = Bounded64(bits64, range + 1);
+    } else {
+        offset = bits64();
+    }
+    return static_cast<T>(static_cast<U>(static_cast<U>(lo) + offset));
+}
+
+/** Shuffle elements by Fisher-Yates algorithm. */
+template <class TRandom, class RandomIt>
+void
+Shuffle(TRandom &rnd, RandomIt first, RandomIt last)
+{
+    size_t n = last - first;
+    for (; n > 1; n--) {
+        size_t j = rnd.template GetUniform<size_t>(0, n - 1);
+        if (j != n - 1) {
+            std::swap(first[n - 1], first[j]);
+        }
+    }
+}
+
+/** Select random sample of elements from a sequence of unknown length by
+ * reservoir sampling (Algorithm L). The number of generated random values is
+ * proportional to k * log(n / k) rather than to the sequence length.
+ */
+template <class TRandom, class InputIt, class RandomIt>
+size_t
+Sample(TRandom &rnd, InputIt first, InputIt last, RandomIt out, size_t k)
+{
+    size_t size = 0;
+    for (; size < k && first != last; ++first, size++) {
+        out[size] = *first;
+    }
+    if (first == last || !k) {
+        return size;
+    }
+    double w = std::exp(std::log(1.0 - rnd.GetDouble()) / k);
+    while (true) {
+        /* Number of elements to skip has geometric distribution. */
+        double skip = std::floor(std::log(1.0 - rnd.GetDouble()) / std::log1p(-w));
+        for (; skip > 0 && first != last; skip--) {
+            ++first;
+        }
+        if (first == last) {
+            return k;
+        }
+        out[rnd.template GetUniform<size_t>(0, k - 1)] = *first;
+        ++first;
+        w *= std::exp(std::log(1.0 - rnd.GetDouble()) / k);
+    }
+}
+
+/** Sample standard normal distribution by ziggurat method. Most samples
+ * take one 64-bits random value, one multiplication and one comparison.
+ *
+ * @param bits Callable returning random 64-bits values. Low 8 bits select
+ *      the layer, bit 8 is the sign and high 53 bits are the position in the
+ *      layer.
+ */
+template <class TBits>
+double
+ZigguratNormal(TBits &&bits)
+{
+    const ZigguratTable &t = GetNormalZigguratTable();
+    while (true) {
+        u64 b = bits();
+        size_t i = b & 0xff;
+        double x = BitsToDouble(b) * t.x[i];
+        if (x >= t.x[i + 1]) {
+            if (i == 0) {
+                /* Base layer beyond the tail start, Marsaglia tail method. */
+                double y;
+                do {
+                    x = -std::log(1.0 - BitsToDouble(bits())) / t.r;
+                    y = -std::log(1.0 - BitsToDouble(bits()));
+                } while (y + y < x * x);
+                x += t.r;
+            } else if (t.f[i] + BitsToDouble(bits()) * (t.f[i + 1] - t.f[i]) >=
+                       std::exp(-0.5 * x * x)) {
+                /* Wedge point above the density curve. */
+                continue;
+            }
+        }
+        /* Sign is applied by bits manipulation since the branch would be
+         * unpredictable.
+         */
+        u64 xBits;
+        memcpy(&xBits, &x, sizeof(x));
+        xBits |= (b & 0x100) << 55;
+        memcpy(&x, &xBits, sizeof(x));
+        return x;
+    }
+}
+
+/** Sample standard exponential distribution by ziggurat method.
+ *
+ * @param bits Callable returning random 64-bits values.
+ */
+template <class TBits>
+double
+ZigguratExponential(TBits &&bits)
+{
+    const ZigguratTable &t = GetExponentialZigguratTable();
+    while (true) {
+        u64 b = bits();
+        size_t i = b & 0xff;
+        double x = BitsToDouble(b) * t.x[i];
+        if (x < t.x[i + 1]) {
+            return x;
+        }
+        if (i == 0) {
+            /* The distribution is memoryless so the tail is shifted
+             * exponential one.
+             */
+            return t.r - std::log(1.0 - BitsToDouble(bits()));
+        }
+        if (t.f[i] + BitsToDouble(bits()) * (t.f[i + 1] - t.f[i]) < std::exp(-x)) {
+            return x;
+        }
+    }
+}
+
+} /* namespace internal */
+
 /** Predictable, portable and fast random number generator based on CMWC4096
  * algorithm. Can be used to guarantee the same sequence on all platforms for
  * the same seed.
@@ -54,12 +293,508 @@ public:
     double
     GetGaussian(double median, double deviation);
 
+    /** Get random number from exponential distribution.
+     *
+     * @param rate Rate parameter of the distribution (inverse of the mean).
+     */
+    double
+    GetExponential(double rate = 1);
+
+    /** Get unbiased random integer in range [lo; hi] (both inclusive). Unlike
+     * modulo reduction it has no bias and mostly does not need division.
+     */
+    template <typename T>
+    T
+    GetUniform(T lo, T hi)
+    {
+        return internal::Uniform(lo, hi,
+                                 [this]() { return static_cast<u32>(GetInt32()); },
+                                 [this]() { return _GetBits(); });
+    }
+
+    /** Randomly permute elements in the range. */
+    template <class RandomIt>
+    void
+    Shuffle(RandomIt first, RandomIt last)
+    {
+        internal::Shuffle(*this, first, last);
+    }
+
+    /** Select uniform random sample of @a k elements from the sequence, which
+     * may be of unknown length (e.g. input stream). Each element is included
+     * with equal probability.
+     *
+     * @param first Sequence start.
+     * @param last Sequence end.
+     * @param out Output for the sample, should have space for @a k elements.
+     *      Order of the sampled elements is not defined.
+     * @param k Sample size.
+     * @return Number of sampled elements, less than @a k if the sequence is
+     *      shorter.
+     */
+    template <class InputIt, class RandomIt>
+    size_t
+    Sample(InputIt first, InputIt last, RandomIt out, size_t k)
+    {
+        return internal::Sample(*this, first, last, out, k);
+    }
+
+    /* UniformRandomBitGenerator interface for standard library algorithms
+     * and distributions.
+     */
+    typedef u32 result_type;
+
+    static constexpr result_type
+    min()
+    {
+        return 0;
+    }
+
+    static constexpr result_type
+    max()
+    {
+        return MAX_U32;
+    }
+
+    result_type
+    operator ()()
+    {
+        return static_cast<u32>(GetInt32());
+    }
+
 private:
     int Q[4096];
     int c = 362436;
     int idx = 4095;
-    double gauss1, gauss2;
-    bool gaussValid = false;
+
+    /** Get 64 random bits for ziggurat samplers. */
+    u64
+    _GetBits()
+    {
+        u64 hi = static_cast<u32>(GetInt32());
+        return (hi << 32) | static_cast<u32>(GetInt32());
+    }
+};
+
+/** Base class for small-state random engines. It provides common
+ * generation methods and UniformRandomBitGenerator interface based on
+ * 64-bits output of the engine @a Next() method, so the engines can be used
+ * with standard library algorithms and distributions.
+ *
+ * @param TEngine Derived engine class.
+ */
+template <class TEngine>
+class RandomEngine {
+public:
+    typedef u64 result_type;
+
+    static constexpr result_type
+    min()
+    {
+        return 0;
+    }
+
+    static constexpr result_type
+    max()
+    {
+        return MAX_U64;
+    }
+
+    result_type
+    operator ()()
+    {
+        return _Self().Next();
+    }
+
+    /** Get random 32-bits integer. */
+    i32
+    GetInt32()
+    {
+        /* High bits have the best quality in all the engines. */
+        return static_cast<i32>(_Self().Next() >> 32);
+    }
+
+    /** Get random 64-bits integer. */
+    i64
+    GetInt64()
+    {
+        return static_cast<i64>(_Self().Next());
+    }
+
+    /** Get random float in range [0; 1). */
+    float
+    GetFloat()
+    {
+        return static_cast<float>(_Self().Next() >> 40) *
+            (1.0f / (static_cast<u32>(1) << 24));
+    }
+
+    /** Get random double in range [0; 1). */
+    double
+    GetDouble()
+    {
+        return internal::BitsToDouble(_Self().Next());
+    }
+
+    /** Get random number from Gaussian distribution. Median is zero.
+     *
+     * @param variance Desired variance value of the distribution.
+     */
+    double
+    GetGaussian(double variance)
+    {
+        return std::sqrt(variance) * _GetNormal();
+    }
+
+    /** Get random number from Gaussian distribution.
+     *
+     * @param median Desired median value of the distribution.
+     * @param deviation Desired standard deviation of the distribution.
+     */
+    double
+    GetGaussian(double median, double deviation)
+    {
+        return median + deviation * _GetNormal();
+    }
+
+    /** Get random number from exponential distribution.
+     *
+     * @param rate Rate parameter of the distribution (inverse of the mean).
+     */
+    double
+    GetExponential(double rate = 1)
+    {
+        return internal::ZigguratExponential([this]() { return _Self().Next(); }) / rate;
+    }
+
+    /** Get unbiased random integer in range [lo; hi] (both inclusive). */
+    template <typename T>
+    T
+    GetUniform(T lo, T hi)
+    {
+        return internal::Uniform(lo, hi,
+                                 [this]() { return static_cast<u32>(_Self().Next() >> 32); },
+                                 [this]() { return _Self().Next(); });
+    }
+
+    /** Randomly permute elements in the range. */
+    template <class RandomIt>
+    void
+    Shuffle(RandomIt first, RandomIt last)
+    {
+        internal::Shuffle(*this, first, last);
+    }
+
+    /** Select uniform random sample of @a k elements from the sequence. See
+     * @ref Random::Sample.
+     */
+    template <class InputIt, class RandomIt>
+    size_t
+    Sample(InputIt first, InputIt last, RandomIt out, size_t k)
+    {
+        return internal::Sample(*this, first, last, out, k);
+    }
+
+private:
+    TEngine &
+    _Self()
+    {
+        return *static_cast<TEngine *>(this);
+    }
+
+    double
+    _GetNormal()
+    {
+        return internal::ZigguratNormal([this]() { return _Self().Next(); });
+    }
+};
+
+/** SplitMix64 generator. It has 64 bits of state and passes BigCrush, but it
+ * is mostly used for expanding a single seed value into the state of other
+ * engines.
+ */
+class SplitMix64: public RandomEngine<SplitMix64> {
+public:
+    SplitMix64(u64 seed):
+        _state(seed)
+    {}
+
+    /** Get next 64-bits value. */
+    u64
+    Next()
+    {
+        u64 z = (_state += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+
+private:
+    u64 _state;
+};
+
+/** xoshiro256** generator by David Blackman and Sebastiano Vigna. It has 256
+ * bits of state, period 2^256 - 1 and is the fastest all-purpose generator
+ * in the library. Non-overlapping streams for parallel generation are
+ * obtained by @ref Jump and @ref LongJump.
+ */
+class Xoshiro256: public RandomEngine<Xoshiro256> {
+public:
+    /** Initialize with the state expanded from the seed by @ref SplitMix64. */
+    Xoshiro256(u64 seed)
+    {
+        SplitMix64 sm(seed);
+        for (u64 &s: _s) {
+            s = sm.Next();
+        }
+    }
+
+    /** Initialize generator for the specified stream. Streams with the same
+     * seed do not overlap for 2^128 values each. The stream is selected by
+     * applying @ref Jump @a stream times, so the construction time is linear
+     * in the stream index.
+     */
+    Xoshiro256(u64 seed, u64 stream):
+        Xoshiro256(seed)
+    {
+        for (u64 i = 0; i < stream; i++) {
+            Jump();
+        }
+    }
+
+    /** Get next 64-bits value. */
+    u64
+    Next()
+    {
+        u64 result = RotL(_s[1] * 5, 7) * 9;
+        u64 t = _s[1] << 17;
+        _s[2] ^= _s[0];
+        _s[3] ^= _s[1];
+        _s[1] ^= _s[2];
+        _s[0] ^= _s[3];
+        _s[2] ^= t;
+        _s[3] = RotL(_s[3], 45);
+        return result;
+    }
+
+    /** Advance the state as if 2^128 values were generated. It allows
+     * getting 2^128 non-overlapping sequences for parallel computations.
+     */
+    void
+    Jump();
+
+    /** Advance the state as if 2^192 values were generated. It allows
+     * getting 2^64 starting points, from each of which @ref Jump generates
+     * 2^64 non-overlapping sequences.
+     */
+    void
+    LongJump();
+
+private:
+    friend class BulkRandom;
+
+    u64 _s[4];
+
+    /** Advance the state by jump polynomial. */
+    void
+    _Jump(const u64 *poly);
+};
+
+/** PCG64 generator (128-bits LCG with XSL-RR output function) by Melissa
+ * O'Neill. It has 128 bits of state and 2^127 selectable streams. The output
+ * is identical to the reference pcg64 engine.
+ */
+class Pcg64: public RandomEngine<Pcg64> {
+public:
+    /** Initialize generator.
+     *
+     * @param seed Initial state.
+     * @param stream Stream selector. Generators with different streams
+     *      produce different sequences for the same seed.
+     */
+    Pcg64(u64 seed, u64 stream = 0):
+        _stateHi(0), _stateLo(0), _incHi(stream >> 63), _incLo((stream << 1) | 1)
+    {
+        _Step();
+        _stateLo += seed;
+        _stateHi += _stateLo < seed;
+        _Step();
+    }
+
+    /** Get next 64-bits value. */
+    u64
+    Next()
+    {
+        _Step();
+        u64 x = _stateHi ^ _stateLo;
+        unsigned rot = _stateHi >> 58;
+        /* Rotation by zero bits is valid here unlike RotR(). */
+        return (x >> rot) | (x << (-rot & 63));
+    }
+
+    /** Advance the state as if the specified number of values were
+     * generated. It takes logarithmic time in the distance.
+     */
+    void
+    Advance(u64 delta);
+
+private:
+    enum: u64 {
+        MUL_HI = 0x2360ed051fc65da4ull,
+        MUL_LO = 0x4385df649fccf645ull
+    };
+
+    u64 _stateHi, _stateLo, _incHi, _incLo;
+
+    /** 128-bits multiply-add: x = x * m + a (mod 2^128). */
+    static void
+    _MulAdd(u64 &xHi, u64 &xLo, u64 mHi, u64 mLo, u64 aHi, u64 aLo)
+    {
+        u64 hi, lo = internal::MulWide(xLo, mLo, hi);
+        hi += xHi * mLo + xLo * mHi;
+        xLo = lo + aLo;
+        xHi = hi + aHi + (xLo < lo);
+    }
+
+    /** Advance LCG state: state = state * MUL + inc (mod 2^128). */
+    void
+    _Step()
+    {
+        _MulAdd(_stateHi, _stateLo, MUL_HI, MUL_LO, _incHi, _incLo);
+    }
+};
+
+/** Generator for bulk filling of arrays with random numbers. It runs eight
+ * interleaved xoshiro256** streams, so AVX2 instructions (when supported by
+ * the CPU, detected at run time) generate four values per instruction. The
+ * output is the same with and without AVX2 and depends only on the seed and
+ * the sequence of calls. Each call consumes whole blocks of
+ * @ref NUM_STREAMS values, unused generated values are discarded.
+ */
+class BulkRandom {
+public:
+    enum {
+        /** Number of interleaved streams. */
+        NUM_STREAMS = 8
+    };
+
+    /** Initialize the streams. Interleaved streams are obtained by
+     * @ref Xoshiro256::Jump so they never overlap. The first one is the same
+     * as @ref Xoshiro256 sequence for the same seed.
+     *
+     * @param seed Seed value.
+     * @param stream Index of the generator for parallel computations.
+     *      Generators with different indices and the same seed produce
+     *      non-overlapping sequences. Construction time is linear in the
+     *      index.
+     */
+    BulkRandom(u64 seed, u64 stream = 0);
+
+    /** Fill array with random 32-bits integers. */
+    void
+    Fill(u32 *out, size_t n);
+
+    /** Fill array with random 64-bits integers. Value with index @a i is
+     * generated by stream @a i % @ref NUM_STREAMS.
+     */
+    void
+    Fill(u64 *out, size_t n);
+
+    /** Fill array with random doubles in range [0; 1). */
+    void
+    FillDoubles(double *out, size_t n);
+
+    /** Fill array with random numbers from Gaussian distribution. Ziggurat
+     * method is used.
+     *
+     * @param out Array to fill.
+     * @param n Number of values to generate.
+     * @param median Desired median value of the distribution.
+     * @param deviation Desired standard deviation of the distribution.
+     */
+    void
+    FillGaussian(double *out, size_t n, double median = 0, double deviation = 1);
+
+private:
+    /** Streams state, the first index is state word, the second one is
+     * stream.
+     */
+    u64 _s[4][NUM_STREAMS];
+};
+
+/** Alias table for sampling from discrete distribution with arbitrary
+ * weights (Walker's alias method). The table is built in O(n) time by Vose's
+ * algorithm, each sample takes O(1) time.
+ */
+class AliasTable {
+public:
+    /** Build the table.
+     *
+     * @param weights Non-negative weights of the outcomes, at least one
+     *      should be positive.
+     * @throws InvalidParamException if the weights are not valid.
+     */
+    AliasTable(const std::vector<double> &weights);
+
+    /** Get random outcome index with probability proportional to its
+     * weight.
+     *
+     * @param rnd Random generator (@ref Random or small-state engine).
+     */
+    template <class TRandom>
+    size_t
+    Sample(TRandom &rnd) const
+    {
+        const Entry &e = _entries[rnd.template GetUniform<size_t>(0, _entries.size() - 1)];
+        return static_cast<u32>(rnd.GetInt32()) < e.threshold ? &e - _entries.data() : e.alias;
+    }
+
+    /** Get number of outcomes. */
+    size_t
+    GetSize() const
+    {
+        return _entries.size();
+    }
+
+private:
+    struct Entry {
+        /** The entry index is selected if 32 random bits are less than the
+         * threshold, the alias otherwise.
+         */
+        u64 threshold;
+        size_t alias;
+    };
+
+    std::vector<Entry> _entries;
+};
+
+/** Per-thread random generators. Each thread gets its own @ref Xoshiro256
+ * instance, so generation requires no synchronization. Streams are selected
+ * from the seed sequence as follows:
+ * - Each thread pool gets its own @ref Xoshiro256::LongJump segment by the
+ *   pool index (see @ref ThreadPoolExecutor::GetCurrentPoolIndex), workers
+ *   streams in the segment are separated by @ref Xoshiro256::Jump by the
+ *   worker index in the pool. So workers sequences are reproducible for the
+ *   same seed and order of pools creation.
+ * - Other threads share a separate segment, streams are assigned in order
+ *   of their first access.
+ * - The first segment is not used, so threads streams never overlap with
+ *   Xoshiro256(seed, stream) and @ref BulkRandom streams for the same seed.
+ */
+class ThreadLocalRandom {
+public:
+    /** Set seed for all the threads generators. Each thread re-initializes
+     * its generator on the next @ref Get call.
+     */
+    static void
+    SetSeed(u64 seed);
+
+    /** Get generator of the calling thread. The returned reference stays
+     * valid for the thread lifetime, it is recommended to keep it for a
+     * series of generations.
+     */
+    static Xoshiro256 &
+    Get();
 };
 
 } /* namespace adk */
@@ -6,7 +6,8 @@
 
 /** @file rb_tree.h
  * Generic red-black trees algorithms implementation which can be re-used
- * by custom tree structure implementations.
+ * by custom tree structure implementations, and intrusive containers based on
+ * it.
  */
 
 #ifndef RB_TREE_H_
@@ -14,6 +15,16 @@
 
 namespace adk {
 
+/** Default augmentation for @ref RBTree, no data is maintained. */
+struct RBTreeNoAugment {
+    template <class... Args>
+    static bool
+    Update(const Args &...)
+    {
+        return false;
+    }
+};
+
 /** All RB-trees algorithms are implemented inside this class. Since they are
  * parameterized and provided completely in this header file, the client code
  * should instantiate the implementation in one source file.
@@ -87,8 +98,19 @@ namespace adk {
  * It should return positive value if this @a node1 is greater than @a node2,
  * negative value if @a node1 is less than @a node2, zero if both nodes are
  * equal.
+ *
+ * @a Augment class allows maintaining per-node data which depends on the node
+ * subtree, e.g. subtree size or maximal value in the subtree. The algorithms
+ * call it for each node whose subtree is changed, children before parents:
+ * @code
+ * static bool
+ * Update(NodePtr node);
+ * @endcode
+ * It should re-calculate the node data from the node itself and its children
+ * data, and return @a true if the data changed. Propagation to the root is
+ * stopped when the data is not changed.
  */
-template <class NodePtr, class NodeCmp>
+template <class NodePtr, class NodeCmp, class Augment = RBTreeNoAugment>
 class RBTree {
 public:
     /** Tree node direction relatively to its parent node. */
@@ -161,6 +183,26 @@ private:
 
         x->SetChild(!dir, node);
         node->SetParent(x);
+
+        /* Subtree of the new top node contains the same nodes, so ancestors
+         * are not affected.
+         */
+        Augment::Update(node);
+        Augment::Update(x);
+    }
+
+    /** Update augmented data of the node and its ancestors until the data is
+     * not changed.
+     *
+     * @param node Node to start from, can be NULL. Its data should be
+     *      consistent with the tree state before the change.
+     */
+    static void
+    _PropagateAugment(NodePtr node)
+    {
+        while (node && Augment::Update(node)) {
+            node = node->GetParent();
+        }
     }
 
     /** Re-balance the tree after insertion. This function can be called
@@ -244,8 +286,9 @@ private:
      *
      * @param root Root node.
      * @param node Replacement node which must be detached.
+     * @return Parent node of the detached node, NULL if the tree became empty.
      */
-    static void
+    static NodePtr
     _RebalanceDeletion(NodePtr &root, NodePtr node)
     {
         NodePtr replNode = node, tmpNode;
@@ -253,7 +296,7 @@ private:
         if (!node->GetParent()) {
             ASSERT(node == root);
             root = nullptr;
-            return;
+            return nullptr;
         }
 
         do {
@@ -285,7 +328,7 @@ private:
                 node->GetParent()->SetChild(nodeDir, tmpNode);
                 tmpNode->SetColor(false);
                 /* Node detached, all done. */
-                return;
+                return node->GetParent();
             }
 
             do {
@@ -348,7 +391,7 @@ private:
                 node->GetParent()->SetColor(false);
 
                 /* Rotate around the parent. */
-                _Rotate(root, node->parent, !nodeDir);
+                _Rotate(root, node->GetParent(), !nodeDir);
                 break;
             } while (node);
         } while(false);
@@ -360,6 +403,76 @@ private:
             ASSERT(replNode->GetParent()->GetChild(DIR_RIGHT) == replNode);
             replNode->GetParent()->SetChild(DIR_RIGHT, nullptr);
         }
+        return replNode->GetParent();
+    }
+
+
+    /** Get the outermost node of the subtree in the specified direction. */
+    static NodePtr
+    _GetExtremeNode(NodePtr node, Dir dir)
+    {
+        if (!node) {
+            return node;
+        }
+        while (node->GetChild(dir)) {
+            node = node->GetChild(dir);
+        }
+        return node;
+    }
+
+    /** Get adjacent node in ascending order (@ref DIR_RIGHT) or descending
+     * order (@ref DIR_LEFT).
+     */
+    static NodePtr
+    _GetAdjacentNode(NodePtr node, Dir dir)
+    {
+        if (node->GetChild(dir)) {
+            return _GetExtremeNode(node->GetChild(dir), !dir);
+        }
+        /* Ascend while coming from the subtree in the specified direction. */
+        NodePtr parent = node->GetParent();
+        while (parent && parent->GetChild(dir) == node) {
+            node = parent;
+            parent = parent->GetParent();
+        }
+        return parent;
+    }
+
+    /** Build subtree for @ref BuildTree. Middle node becomes the subtree root
+     * so the tree is balanced.
+     *
+     * @param numNodes Number of nodes in the subtree.
+     * @param depth Depth of the subtree root.
+     * @param redDepth Depth of red nodes.
+     * @param getNode Nodes provider.
+     * @return Subtree root, NULL if the subtree is empty. Parent of the
+     *      returned node is not set.
+     */
+    template <class GetNode>
+    static NodePtr
+    _BuildSubtree(size_t numNodes, int depth, int redDepth, GetNode &getNode)
+    {
+        if (!numNodes) {
+            return nullptr;
+        }
+        size_t numLeft = (numNodes - 1) / 2;
+        NodePtr left = _BuildSubtree(numLeft, depth + 1, redDepth, getNode);
+        NodePtr node = getNode();
+        ASSERT(!node->IsWired());
+        NodePtr right = _BuildSubtree(numNodes - 1 - numLeft, depth + 1, redDepth,
+                                      getNode);
+        node->SetChild(DIR_LEFT, left);
+        node->SetChild(DIR_RIGHT, right);
+        if (left) {
+            left->SetParent(node);
+        }
+        if (right) {
+            right->SetParent(node);
+        }
+        node->SetColor(depth == redDepth);
+        node->SetWired(true);
+        Augment::Update(node);
+        return node;
     }
 
 
@@ -400,7 +513,7 @@ public:
         }
 
         /* Re-balance the tree and detach replacement entry. */
-        _RebalanceDeletion(root, replNode);
+        _PropagateAugment(_RebalanceDeletion(root, replNode));
 
         /* Replace target entry with detached replacement entry. */
         if (replNode == targetNode) {
@@ -436,6 +549,9 @@ public:
             ASSERT(replNode->GetChild(DIR_RIGHT)->GetParent() == targetNode);
             replNode->GetChild(DIR_RIGHT)->SetParent(replNode);
         }
+        /* Replacement node data corresponds to its previous position. */
+        Augment::Update(replNode);
+        _PropagateAugment(replNode->GetParent());
     }
 
     /** Insert node to the tree.
@@ -450,19 +566,13 @@ public:
     {
         ASSERT(!node->IsWired());
 
-        node->SetChild(DIR_LEFT, nullptr);
-        node->SetChild(DIR_RIGHT, nullptr);
-
         /* Special case - empty tree, insert root. */
         if (UNLIKELY(!root)) {
-            root = node;
-            node->SetParent(nullptr);
-            node->SetColor(false);
-            node->SetWired(true);
+            LinkNode(root, node, nullptr, DIR_LEFT);
             return node;
         }
 
-        /* Firstly search for insertion point and insert the node. */
+        /* Firstly search for insertion point. */
         NodePtr parent = root;
         while (true) {
             int cmp = comparator(node, parent);
@@ -474,22 +584,120 @@ public:
             if (parent->GetChild(dir)) {
                 parent = parent->GetChild(dir);
             } else {
-                parent->SetChild(dir, node);
-                node->SetParent(parent);
-                node->SetColor(true);
-                node->SetWired(true);
-                break;
+                LinkNode(root, node, parent, dir);
+                return node;
             }
         }
+    }
+
+    /** Insert node to the tree at the already found position. This allows
+     * the caller to do its own search, e.g. with a less-than predicate only.
+     *
+     * @param root Root node.
+     * @param node Node to insert.
+     * @param parent Parent node for the inserted one, NULL if the tree is
+     *      empty.
+     * @param dir Direction of the inserted node relatively to its parent.
+     *      The parent child in this direction should be empty.
+     */
+    static void
+    LinkNode(NodePtr &root, NodePtr node, NodePtr parent, Dir dir)
+    {
+        ASSERT(!node->IsWired());
+        node->SetChild(DIR_LEFT, nullptr);
+        node->SetChild(DIR_RIGHT, nullptr);
+        node->SetWired(true);
+        node->SetParent(parent);
+        if (!parent) {
+            ASSERT(!root);
+            root = node;
+            node->SetColor(false);
+            Augment::Update(node);
+            return;
+        }
+        ASSERT(!parent->GetChild(dir));
+        parent->SetChild(dir, node);
+        node->SetColor(true);
+        Augment::Update(node);
+        _PropagateAugment(parent);
 
         /* Re-balance the tree if necessary. */
-        if (node->GetParent()->IsRed()) {
+        if (parent->IsRed()) {
             _RebalanceInsertion(root, node);
         }
 
         /* Set root black if it was re-colored during re-balancing. */
         root->SetColor(false);
-        return node;
+    }
+
+    /** Build balanced tree from the nodes in ascending order. Nodes of the
+     * last level are colored red if it is not complete, all others are black.
+     * This takes O(n) time as opposed to O(n log n) for sequential insertion.
+     *
+     * @param root Root node. The tree should be empty.
+     * @param numNodes Number of nodes.
+     * @param getNode Functor which returns next node in ascending order on
+     *      each call. It is called exactly @a numNodes times.
+     */
+    template <class GetNode>
+    static void
+    BuildTree(NodePtr &root, size_t numNodes, GetNode &&getNode)
+    {
+        ASSERT(!root);
+        /* Depth of the last level if it is not complete. */
+        int redDepth = 0;
+        while ((static_cast<size_t>(2) << redDepth) <= numNodes + 1) {
+            redDepth++;
+        }
+        root = _BuildSubtree(numNodes, 0, redDepth, getNode);
+        if (root) {
+            root->SetParent(nullptr);
+        }
+    }
+
+    /** Get the least node in the tree.
+     *
+     * @param root Root node.
+     * @return The least node, NULL if the tree is empty.
+     */
+    static NodePtr
+    GetFirstNode(const NodePtr &root)
+    {
+        return _GetExtremeNode(root, DIR_LEFT);
+    }
+
+    /** Get the greatest node in the tree.
+     *
+     * @param root Root node.
+     * @return The greatest node, NULL if the tree is empty.
+     */
+    static NodePtr
+    GetLastNode(const NodePtr &root)
+    {
+        return _GetExtremeNode(root, DIR_RIGHT);
+    }
+
+    /** Get next node in ascending order. Amortized complexity is O(1) when
+     * traversing the whole tree.
+     *
+     * @param node Current node.
+     * @return Next node, NULL if the current node is the greatest one.
+     */
+    static NodePtr
+    GetSuccessor(NodePtr node)
+    {
+        return _GetAdjacentNode(node, DIR_RIGHT);
+    }
+
+    /** Get previous node in ascending order.
+     *
+     * @param node Current node.
+     * @return Previous node, NULL if the current node is the least one.
+     */
+    static NodePtr
+    GetPredecessor(NodePtr node)
+    {
+        return _GetAdjacentNode(node, DIR_LEFT);
     }
 
     /** Get next tree node during the tree traversal.
@@ -531,12 +739,12 @@ public:
      *      are some rules violations or dis-integrity.
      */
     static bool
-    Validate(const NodePtr &root __UNUSED, const NodeCmp &comparator)
+    Validate(const NodePtr &root, const NodeCmp &comparator)
     {
         /* Iterate all nodes and check balancing rules validity for each node. */
         NodePtr node = nullptr;
         int numBlackNodes = -1; /* Black nodes amount in a simple path. */
-        while ((node = GetNextNode(node))) {
+        while ((node = GetNextNode(root, node))) {
 
             /* Verify link with parent. */
             if (node->GetParent()) {
@@ -588,6 +796,897 @@ public:
     }
 };
 
+/** Node entry for intrusive red-black tree containers (@ref RBSet,
+ * @ref RBMap). It should be a member of the item class, one entry per each
+ * container the item can be simultaneously stored in. The entry satisfies
+ * node requirements of @ref RBTree. Color and wired flags are packed into the
+ * parent pointer, so the entry size is three pointers.
+ *
+ * Copying the item does not copy the entry, the copy is not inserted in any
+ * tree.
+ */
+class RBTreeEntry {
+public:
+    RBTreeEntry() = default;
+
+    RBTreeEntry(const RBTreeEntry &)
+    {}
+
+    RBTreeEntry &
+    operator =(const RBTreeEntry &)
+    {
+        return *this;
+    }
+
+    bool
+    IsRed() const
+    {
+        return _parent & RED_FLAG;
+    }
+
+    /** Check if the entry is currently inserted in a tree. */
+    bool
+    IsWired() const
+    {
+        return _parent & WIRED_FLAG;
+    }
+
+    void
+    SetColor(bool isRed)
+    {
+        _parent = isRed ? _parent | RED_FLAG : _parent & ~RED_FLAG;
+    }
+
+    void
+    SetWired(bool isWired)
+    {
+        _parent = isWired ? _parent | WIRED_FLAG : _parent & ~WIRED_FLAG;
+    }
+
+    RBTreeEntry *
+    GetChild(int dir) const
+    {
+        return _child[dir];
+    }
+
+    void
+    SetChild(int dir, RBTreeEntry *node)
+    {
+        _child[dir] = node;
+    }
+
+    RBTreeEntry *
+    GetParent() const
+    {
+        return reinterpret_cast<RBTreeEntry *>(_parent & ~FLAGS_MASK);
+    }
+
+    void
+    SetParent(RBTreeEntry *node)
+    {
+        _parent = reinterpret_cast<uintptr_t>(node) | (_parent & FLAGS_MASK);
+    }
+
+private:
+    enum: uintptr_t {
+        RED_FLAG = 0x1,
+        WIRED_FLAG = 0x2,
+        FLAGS_MASK = RED_FLAG | WIRED_FLAG
+    };
+
+    /** Parent pointer with flags in the low bits. */
+    uintptr_t _parent = 0;
+    RBTreeEntry *_child[2] = {nullptr, nullptr};
+};
+
+/** Subtree size augmentation for intrusive red-black tree containers. It
+ * enables order statistics queries: item by index (@a Select) and index of
+ * item (@a GetRank), both in O(log n) time.
+ *
+ * @param size Pointer to the item member which stores the subtree size.
+ */
+template <class T, size_t T::*size>
+struct RBTreeSizeAugment {
+    /** Get size of the subtree rooted at the item, zero for NULL. */
+    static size_t
+    GetSize(const T *item)
+    {
+        return item ? item->*size : 0;
+    }
+
+    static bool
+    Update(T &item, const T *left, const T *right)
+    {
+        size_t n = GetSize(left) + GetSize(right) + 1;
+        if (item.*size == n) {
+            return false;
+        }
+        item.*size = n;
+        return true;
+    }
+};
+
+/** Interval augmentation for intrusive red-black tree containers. Items are
+ * half-open intervals, the container key is the interval start and the item
+ * member stores the interval end. Maximal end in each subtree is maintained,
+ * which enables overlapping intervals search (@a FindOverlap,
+ * @a FindNextOverlap). Since keys are unique, intervals with the same start
+ * cannot be stored in one container.
+ *
+ * @param TValue Interval end type, the same as the container key type.
+ * @param high Pointer to the item member which stores the interval end.
+ * @param maxHigh Pointer to the item member which stores maximal interval
+ *      end in the subtree.
+ * @param Compare Less-than predicate, the same as the container one.
+ */
+template <class T, class TValue, TValue T::*high, TValue T::*maxHigh,
+          class Compare = std::less<TValue>>
+struct RBTreeIntervalAugment {
+    static const TValue &
+    GetHigh(const T &item)
+    {
+        return item.*high;
+    }
+
+    static const TValue &
+    GetMaxHigh(const T &item)
+    {
+        return item.*maxHigh;
+    }
+
+    static bool
+    Update(T &item, const T *left, const T *right)
+    {
+        Compare cmp;
+        const TValue *max = &(item.*high);
+        if (left && cmp(*max, left->*maxHigh)) {
+            max = &(left->*maxHigh);
+        }
+        if (right && cmp(*max, right->*maxHigh)) {
+            max = &(right->*maxHigh);
+        }
+        if (!cmp(item.*maxHigh, *max) && !cmp(*max, item.*maxHigh)) {
+            return false;
+        }
+        item.*maxHigh = *max;
+        return true;
+    }
+};
+
+namespace internal {
+
+/** Key extractor for @ref RBSet items. */
+template <class T>
+struct RBSetKeyOf {
+    const T &
+    operator()(const T &item) const
+    {
+        return item;
+    }
+};
+
+/** Key extractor for @ref RBMap items. */
+template <class TKey, class T, TKey T::*key>
+struct RBMapKeyOf {
+    const TKey &
+    operator()(const T &item) const
+    {
+        return item.*key;
+    }
+};
+
+/** Intrusive red-black tree container. Items are linked through the
+ * @ref RBTreeEntry member, so insertion and removal never allocate memory.
+ * The container does not own the items, they should outlive their presence
+ * in the container. Keys are unique and should not be modified while the
+ * item is in the container.
+ *
+ * Lookups use less-than predicate only, one comparison per tree level.
+ *
+ * @param entry Pointer to the entry member in the item class.
+ * @param TKeyOf Functor which extracts key from the item.
+ * @param Compare Less-than predicate for keys. Lookup methods accept any key
+ *      type supported by the predicate.
+ * @param TAugment Augmentation for maintaining per-item subtree data, e.g.
+ *      @ref RBTreeSizeAugment or @ref RBTreeIntervalAugment. It is the same as
+ *      @ref RBTree augmentation but operates on items:
+ *      @code
+ *      static bool
+ *      Update(T &item, const T *left, const T *right);
+ *      @endcode
+ */
+template <class T, RBTreeEntry T::*entry, class TKey, class TKeyOf, class Compare,
+          class TAugment>
+class RBTreeContainer {
+private:
+    /** Nodes comparator for @ref RBTree algorithms which require it. */
+    class NodeCmp {
+    public:
+        NodeCmp(const Compare &cmp):
+            _cmp(cmp)
+        {}
+
+        int
+        operator()(const RBTreeEntry *node1, const RBTreeEntry *node2) const
+        {
+            const TKey &key1 = _GetKey(node1), &key2 = _GetKey(node2);
+            if (_cmp(key1, key2)) {
+                return -1;
+            }
+            return _cmp(key2, key1) ? 1 : 0;
+        }
+
+    private:
+        const Compare &_cmp;
+    };
+
+    /** Adapter of items augmentation for @ref RBTree. */
+    class NodeAugment {
+    public:
+        static bool
+        Update(RBTreeEntry *node)
+        {
+            return TAugment::Update(*_GetItem(node), _GetChildItem(node, Tree::DIR_LEFT),
+                                    _GetChildItem(node, Tree::DIR_RIGHT));
+        }
+    };
+
+    typedef RBTree<RBTreeEntry *, NodeCmp, NodeAugment> Tree;
+
+public:
+    typedef TKey key_type;
+    typedef T value_type;
+    typedef size_t size_type;
+
+    /** Bidirectional iterator over the items in ascending order. */
+    template <bool isConst>
+    class Iterator {
+    public:
+        typedef std::bidirectional_iterator_tag iterator_category;
+        typedef T value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef typename std::conditional<isConst, const T *, T *>::type pointer;
+        typedef typename std::conditional<isConst, const T &, T &>::type reference;
+
+        Iterator() = default;
+
+        /** Mutable iterator is convertible to constant one. */
+        template <bool otherConst,
+                  typename = typename std::enable_if<isConst && !otherConst>::type>
+        Iterator(const Iterator<otherConst> &other):
+            _node(other._node), _container(other._container)
+        {}
+
+        reference
+        operator *() const
+        {
+            return *_GetItem(_node);
+        }
+
+        pointer
+        operator ->() const
+        {
+            return _GetItem(_node);
+        }
+
+        Iterator &
+        operator ++()
+        {
+            _node = Tree::GetSuccessor(_node);
+            return *this;
+        }
+
+        Iterator
+        operator ++(int)
+        {
+            Iterator it = *this;
+            ++*this;
+            return it;
+        }
+
+        /** Decrementing end iterator gives the last item. */
+        Iterator &
+        operator --()
+        {
+            _node = _node ? Tree::GetPredecessor(_node) :
+                Tree::GetLastNode(_container->_root);
+            return *this;
+        }
+
+        Iterator
+        operator --(int)
+        {
+            Iterator it = *this;
+            --*this;
+            return it;
+        }
+
+        bool
+        operator ==(const Iterator &other) const
+        {
+            return _node == other._node;
+        }
+
+        bool
+        operator !=(const Iterator &other) const
+        {
+            return _node != other._node;
+        }
+
+    private:
+        friend class RBTreeContainer;
+        template <bool>
+        friend class Iterator;
+
+        /** NULL for end iterator. */
+        RBTreeEntry *_node = nullptr;
+        /** Container is needed for decrementing end iterator. */
+        const RBTreeContainer *_container = nullptr;
+
+        Iterator(RBTreeEntry *node, const RBTreeContainer *container):
+            _node(node), _container(container)
+        {}
+    };
+
+    typedef Iterator<false> iterator;
+    typedef Iterator<true> const_iterator;
+
+    RBTreeContainer(const Compare &cmp = Compare()):
+        _cmp(cmp)
+    {}
+
+    /** Create container from the items in strictly ascending order. See
+     * @ref Assign.
+     */
+    template <class TIter>
+    RBTreeContainer(TIter first, TIter last, const Compare &cmp = Compare()):
+        _cmp(cmp)
+    {
+        Assign(first, last);
+    }
+
+    RBTreeContainer(const RBTreeContainer &) = delete;
+
+    RBTreeContainer(RBTreeContainer &&other):
+        _cmp(std::move(other._cmp)), _root(other._root), _size(other._size)
+    {
+        other._root = nullptr;
+        other._size = 0;
+    }
+
+    /** Items are removed from the container but not destroyed. */
+    ~RBTreeContainer()
+    {
+        Clear();
+    }
+
+    RBTreeContainer &
+    operator =(const RBTreeContainer &) = delete;
+
+    RBTreeContainer &
+    operator =(RBTreeContainer &&other)
+    {
+        if (this != &other) {
+            Clear();
+            _cmp = std::move(other._cmp);
+            _root = other._root;
+            _size = other._size;
+            other._root = nullptr;
+            other._size = 0;
+        }
+        return *this;
+    }
+
+    /** Get number of items. */
+    size_t
+    Size() const
+    {
+        return _size;
+    }
+
+    bool
+    IsEmpty() const
+    {
+        return !_size;
+    }
+
+    iterator
+    begin()
+    {
+        return iterator(Tree::GetFirstNode(_root), this);
+    }
+
+    iterator
+    end()
+    {
+        return iterator(nullptr, this);
+    }
+
+    const_iterator
+    begin() const
+    {
+        return const_cast<RBTreeContainer *>(this)->begin();
+    }
+
+    const_iterator
+    end() const
+    {
+        return const_cast<RBTreeContainer *>(this)->end();
+    }
+
+    /** Get iterator pointing to the item which is in the container. */
+    iterator
+    GetIterator(T &item)
+    {
+        ASSERT((item.*entry).IsWired());
+        return iterator(&(item.*entry), this);
+    }
+
+    /** Insert the item if its key is not yet in the container.
+     *
+     * @return Iterator pointing to the item with the key and @a true if the
+     *      provided item was inserted.
+     */
+    std::pair<iterator, bool>
+    Insert(T &item)
+    {
+        const TKey &key = TKeyOf()(item);
+        RBTreeEntry *parent = nullptr, *node = _root;
+        /* Last node the search turned right at. It is the only candidate for
+         * having equal key.
+         */
+        RBTreeEntry *lessNode = nullptr;
+        typename Tree::DirValue dir = Tree::DIR_LEFT;
+        while (node) {
+            parent = node;
+            if (_cmp(key, _GetKey(node))) {
+                dir = Tree::DIR_LEFT;
+            } else {
+                dir = Tree::DIR_RIGHT;
+                lessNode = node;
+            }
+            node = node->GetChild(dir);
+        }
+        if (lessNode && !_cmp(_GetKey(lessNode), key)) {
+            return std::make_pair(iterator(lessNode, this), false);
+        }
+        node = &(item.*entry);
+        Tree::LinkNode(_root, node, parent, dir);
+        _size++;
+        return std::make_pair(iterator(node, this), true);
+    }
+
+    /** Remove item pointed by the iterator.
+     *
+     * @return Iterator pointing to the next item.
+     */
+    iterator
+    Erase(const_iterator it)
+    {
+        ASSERT(it._node);
+        RBTreeEntry *next = Tree::GetSuccessor(it._node);
+        Tree::DeleteNode(_root, it._node);
+        _size--;
+        return iterator(next, this);
+    }
+
+    /** Remove the item which is in the container. */
+    void
+    Erase(T &item)
+    {
+        ASSERT((item.*entry).IsWired());
+        Tree::DeleteNode(_root, &(item.*entry));
+        _size--;
+    }
+
+    /** Remove item with the specified key.
+     *
+     * @return Number of removed items.
+     */
+    template <class K>
+    size_t
+    EraseKey(const K &key)
+    {
+        RBTreeEntry *node = _Find(key);
+        if (!node) {
+            return 0;
+        }
+        Tree::DeleteNode(_root, node);
+        _size--;
+        return 1;
+    }
+
+    /** Remove all items. The items are not destroyed. */
+    void
+    Clear()
+    {
+        RBTreeEntry *node = Tree::GetFirstNode(_root);
+        while (node) {
+            RBTreeEntry *next = Tree::GetSuccessor(node);
+            node->SetWired(false);
+            node = next;
+        }
+        _root = nullptr;
+        _size = 0;
+    }
+
+    /** Replace the container content with the items in strictly ascending
+     * order. The tree is built in O(n) time.
+     *
+     * @param first Iterator to the first item, dereferenced to item
+     *      reference.
+     * @param last End of the items range.
+     */
+    template <class TIter>
+    void
+    Assign(TIter first, TIter last)
+    {
+        Clear();
+        size_t numItems = std::distance(first, last);
+        Tree::BuildTree(_root, numItems, [&]() {
+            T &item = *first;
+            ++first;
+            return &(item.*entry);
+        });
+        _size = numItems;
+        ASSERT(_IsAscending());
+    }
+
+    /** Find item by key.
+     *
+     * @return Iterator pointing to the found item, @ref end if not found.
+     */
+    template <class K>
+    iterator
+    Find(const K &key)
+    {
+        return iterator(_Find(key), this);
+    }
+
+    template <class K>
+    const_iterator
+    Find(const K &key) const
+    {
+        return const_cast<RBTreeContainer *>(this)->Find(key);
+    }
+
+    /** Check if item with the specified key exists. */
+    template <class K>
+    bool
+    Contains(const K &key) const
+    {
+        return _Find(key);
+    }
+
+    /** Get iterator pointing to the first item with key not less than the
+     * specified one.
+     */
+    template <class K>
+    iterator
+    LowerBound(const K &key)
+    {
+        return iterator(_LowerBound(key), this);
+    }
+
+    template <class K>
+    const_iterator
+    LowerBound(const K &key) const
+    {
+        return const_cast<RBTreeContainer *>(this)->LowerBound(key);
+    }
+
+    /** Get iterator pointing to the first item with key greater than the
+     * specified one.
+     */
+    template <class K>
+    iterator
+    UpperBound(const K &key)
+    {
+        RBTreeEntry *node = _root, *result = nullptr;
+        while (node) {
+            if (_cmp(key, _GetKey(node))) {
+                result = node;
+                node = node->GetChild(Tree::DIR_LEFT);
+            } else {
+                node = node->GetChild(Tree::DIR_RIGHT);
+            }
+        }
+        return iterator(result, this);
+    }
+
+    template <class K>
+    const_iterator
+    UpperBound(const K &key) const
+    {
+        return const_cast<RBTreeContainer *>(this)->UpperBound(key);
+    }
+
+    /** Get item by its index in ascending order. Requires
+     * @ref RBTreeSizeAugment, takes O(log n) time.
+     *
+     * @return Iterator pointing to the item, @ref end if the index is out of
+     *      range.
+     */
+    iterator
+    Select(size_t index)
+    {
+        RBTreeEntry *node = _root;
+        while (node) {
+            size_t leftSize = TAugment::GetSize(_GetChildItem(node, Tree::DIR_LEFT));
+            if (index < leftSize) {
+                node = node->GetChild(Tree::DIR_LEFT);
+            } else if (index == leftSize) {
+                break;
+            } else {
+                index -= leftSize + 1;
+                node = node->GetChild(Tree::DIR_RIGHT);
+            }
+        }
+        return iterator(node, this);
+    }
+
+    const_iterator
+    Select(size_t index) const
+    {
+        return const_cast<RBTreeContainer *>(this)->Select(index);
+    }
+
+    /** Get index of the item in ascending order. Requires
+     * @ref RBTreeSizeAugment, takes O(log n) time.
+     *
+     * @param it Iterator pointing to the item. @ref end gives number of
+     *      items.
+     */
+    size_t
+    GetRank(const_iterator it) const
+    {
+        RBTreeEntry *node = it._node;
+        if (!node) {
+            return _size;
+        }
+        size_t rank = TAugment::GetSize(_GetChildItem(node, Tree::DIR_LEFT));
+        for (RBTreeEntry *parent = node->GetParent(); parent;
+             node = parent, parent = parent->GetParent()) {
+
+            if (parent->GetChild(Tree::DIR_RIGHT) == node) {
+                rank += TAugment::GetSize(_GetChildItem(parent, Tree::DIR_LEFT)) + 1;
+            }
+        }
+        return rank;
+    }
+
+    /** Find the first item (with the least key) which interval overlaps the
+     * specified one. Intervals are half-open, the key is the interval start.
+     * Requires @ref RBTreeIntervalAugment, takes O(log n) time.
+     *
+     * @param low Start of the interval to check.
+     * @param high End of the interval to check (exclusive).
+     * @return Iterator pointing to the found item, @ref end if there are no
+     *      overlapping items.
+     */
+    template <class K>
+    iterator
+    FindOverlap(const K &low, const K &high)
+    {
+        return iterator(_FindOverlap(_root, low, high), this);
+    }
+
+    /** Find the next item which interval overlaps the specified one. All
+     * overlapping items are enumerated in O(k log n) time by calling this
+     * method starting from the result of @ref FindOverlap.
+     *
+     * @param it Iterator pointing to previously found item.
+     * @param low Start of the interval to check.
+     * @param high End of the interval to check (exclusive).
+     * @return Iterator pointing to the found item, @ref end if there are no
+     *      more overlapping items.
+     */
+    template <class K>
+    iterator
+    FindNextOverlap(const_iterator it, const K &low, const K &high)
+    {
+        RBTreeEntry *node = it._node;
+        ASSERT(node);
+        RBTreeEntry *result = _FindOverlap(node->GetChild(Tree::DIR_RIGHT), low, high);
+        /* Ascend to the ancestors which are greater than the current node. */
+        for (RBTreeEntry *parent = node->GetParent(); !result && parent;
+             node = parent, parent = parent->GetParent()) {
+
+            if (parent->GetChild(Tree::DIR_LEFT) != node) {
+                continue;
+            }
+            if (!_cmp(_GetKey(parent), high)) {
+                break;
+            }
+            if (_cmp(low, TAugment::GetHigh(*_GetItem(parent)))) {
+                result = parent;
+            } else {
+                result = _FindOverlap(parent->GetChild(Tree::DIR_RIGHT), low, high);
+            }
+        }
+        return iterator(result, this);
+    }
+
+    /** Validate the tree structure. This method is intended for
+     * troubleshooting.
+     *
+     * @return @a true if the tree is valid red-black tree with the items in
+     *      ascending order.
+     */
+    bool
+    Validate() const
+    {
+        if (!Tree::Validate(_root, NodeCmp(_cmp)) || !_IsAscending()) {
+            return false;
+        }
+        size_t numItems = 0;
+        for (auto it = begin(); it != end(); ++it) {
+            /* Consistent data is not changed by update. */
+            if (NodeAugment::Update(it._node)) {
+                return false;
+            }
+            numItems++;
+        }
+        return numItems == _size;
+    }
+
+private:
+    Compare _cmp;
+    RBTreeEntry *_root = nullptr;
+    size_t _size = 0;
+
+    /** Get item by its entry. */
+    static T *
+    _GetItem(const RBTreeEntry *node)
+    {
+        /* Entry offset in the item, folded to a constant by the compiler. */
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+        const T *item = reinterpret_cast<const T *>(&storage);
+        std::ptrdiff_t offset = reinterpret_cast<const char *>(&(item->*entry)) -
+            reinterpret_cast<const char *>(item);
+        return reinterpret_cast<T *>(reinterpret_cast<uintptr_t>(node) - offset);
+    }
+
+    /** Get item of the node child, NULL if there is no child. */
+    static T *
+    _GetChildItem(const RBTreeEntry *node, int dir)
+    {
+        RBTreeEntry *child = node->GetChild(dir);
+        return child ? _GetItem(child) : nullptr;
+    }
+
+    static const TKey &
+    _GetKey(const RBTreeEntry *node)
+    {
+        return TKeyOf()(*_GetItem(node));
+    }
+
+    /** Find the first overlapping item in the subtree. The subtree is skipped
+     * if all its intervals end before the specified start, and the search
+     * stops at the first node starting after the specified end, so only
+     * O(log n) nodes are visited.
+     */
+    template <class K>
+    RBTreeEntry *
+    _FindOverlap(RBTreeEntry *node, const K &low, const K &high) const
+    {
+        while (node && _cmp(low, TAugment::GetMaxHigh(*_GetItem(node)))) {
+            RBTreeEntry *result = _FindOverlap(node->GetChild(Tree::DIR_LEFT), low, high);
+            if (result) {
+                return result;
+            }
+            if (!_cmp(_GetKey(node), high)) {
+                return nullptr;
+            }
+            if (_cmp(low, TAugment::GetHigh(*_GetItem(node)))) {
+                return node;
+            }
+            node = node->GetChild(Tree::DIR_RIGHT);
+        }
+        return nullptr;
+    }
+
+    template <class K>
+    RBTreeEntry *
+    _LowerBound(const K &key) const
+    {
+        RBTreeEntry *node = _root, *result = nullptr;
+        while (node) {
+            if (_cmp(_GetKey(node), key)) {
+                node = node->GetChild(Tree::DIR_RIGHT);
+            } else {
+                result = node;
+                node = node->GetChild(Tree::DIR_LEFT);
+            }
+        }
+        return result;
+    }
+
+    template <class K>
+    RBTreeEntry *
+    _Find(const K &key) const
+    {
+        RBTreeEntry *node = _LowerBound(key);
+        if (node && _cmp(key, _GetKey(node))) {
+            return nullptr;
+        }
+        return node;
+    }
+
+    /** Check if all items are in strictly ascending order. */
+    bool
+    _IsAscending() const
+    {
+        RBTreeEntry *node = Tree::GetFirstNode(_root);
+        while (node) {
+            RBTreeEntry *next = Tree::GetSuccessor(node);
+            if (next && !_cmp(_GetKey(node), _GetKey(next))) {
+                return false;
+            }
+            node = next;
+        }
+        return true;
+    }
+};
+
+} /* namespace internal */
+
+/** Intrusive ordered set. Items are compared by themselves, see
+ * internal::RBTreeContainer for details.
+ *
+ * @code
+ * struct Item {
+ *     int value;
+ *     RBTreeEntry entry;
+ *
+ *     bool
+ *     operator <(const Item &other) const
+ *     {
+ *         return value < other.value;
+ *     }
+ * };
+ *
+ * RBSet<Item, &Item::entry> set;
+ * @endcode
+ */
+template <class T, RBTreeEntry T::*entry, class Compare = std::less<T>,
+          class TAugment = RBTreeNoAugment>
+class RBSet:
+    public internal::RBTreeContainer<T, entry, T, internal::RBSetKeyOf<T>, Compare,
+                                     TAugment> {
+private:
+    typedef internal::RBTreeContainer<T, entry, T, internal::RBSetKeyOf<T>,
+                                      Compare, TAugment> BaseT;
+public:
+    using BaseT::BaseT;
+};
+
+/** Intrusive ordered map. Items are compared by the key member, see
+ * internal::RBTreeContainer for details.
+ *
+ * @code
+ * struct Timer {
+ *     u64 deadline;
+ *     RBTreeEntry entry;
+ * };
+ *
+ * RBMap<u64, Timer, &Timer::deadline, &Timer::entry> timers;
+ * @endcode
+ */
+template <class TKey, class T, TKey T::*key, RBTreeEntry T::*entry,
+          class Compare = std::less<TKey>, class TAugment = RBTreeNoAugment>
+class RBMap:
+    public internal::RBTreeContainer<T, entry, TKey,
+                                     internal::RBMapKeyOf<TKey, T, key>, Compare,
+                                     TAugment> {
+private:
+    typedef internal::RBTreeContainer<T, entry, TKey,
+                                      internal::RBMapKeyOf<TKey, T, key>,
+                                      Compare, TAugment> BaseT;
+public:
+    using BaseT::BaseT;
+};
+
 } /* namespace adk */
 
 #endif /* RB_TREE_H_ */
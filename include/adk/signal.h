@@ -17,6 +17,8 @@ namespace adk_internal {
 
 class SlotBase;
 class SignalBase;
+template <typename Signature>
+class SignalBaseSpec;
 
 } /* namespace adk_internal */
 
@@ -39,8 +41,9 @@ public:
 private:
     friend class adk_internal::SlotBase;
 
-    std::list<adk_internal::SlotBase *> _slots;
-    std::mutex _slotsMutex;
+    /** Head of intrusive list of slots bound to this object. */
+    adk_internal::SlotBase *_slots = nullptr;
+    Spinlock _slotsLock;
 
     void
     _RegisterSlot(adk_internal::SlotBase *slot);
@@ -192,6 +195,8 @@ protected:
 
     /** Target object if any. */
     SlotTarget *_target = nullptr;
+    /** Links in the target object slots list. Protected by the target lock. */
+    SlotBase *_prevSlot = nullptr, *_nextSlot = nullptr;
 
     SlotBase() = default;
 
@@ -269,8 +274,80 @@ protected:
 
 /** Base class for signal. */
 class SignalBase {
+public:
+    /** Statistics collected for one connected slot when profiling is
+     * enabled.
+     */
+    struct SlotProfile {
+        /** Slot target object if any. */
+        SlotTarget *target;
+        /** Number of slot invocations. */
+        u64 numCalls;
+        /** Cumulative time spent in the slot. */
+        std::chrono::nanoseconds totalTime;
+    };
+
+    /** Enable or disable per-slot profiling. It is disabled by default and
+     * costs only one atomic flag check per emission in such case.
+     */
+    void
+    EnableProfiling(bool enable = true)
+    {
+        _profilingEnabled.store(enable, std::memory_order_relaxed);
+    }
+
+    /** Check if per-slot profiling is enabled. */
+    bool
+    IsProfilingEnabled() const
+    {
+        return _profilingEnabled.load(std::memory_order_relaxed);
+    }
+
+protected:
+    /** Per-slot profiling counters. */
+    struct SlotStats {
+        std::atomic<u64> numCalls {0};
+        /** Nanoseconds. */
+        std::atomic<u64> totalTime {0};
+
+        void
+        Reset()
+        {
+            numCalls.store(0, std::memory_order_relaxed);
+            totalTime.store(0, std::memory_order_relaxed);
+        }
+    };
+
+    /** Accounts one slot invocation time on scope exit. */
+    class SlotTimer {
+    public:
+        SlotTimer(SlotStats *stats):
+            _stats(stats)
+        {
+            if (_stats) {
+                _start = std::chrono::steady_clock::now();
+            }
+        }
+
+        ~SlotTimer()
+        {
+            if (_stats) {
+                auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>
+                    (std::chrono::steady_clock::now() - _start);
+                _stats->numCalls.fetch_add(1, std::memory_order_relaxed);
+                _stats->totalTime.fetch_add(elapsed.count(), std::memory_order_relaxed);
+            }
+        }
+
+    private:
+        SlotStats *_stats;
+        std::chrono::steady_clock::time_point _start;
+    };
+
 private:
     friend SlotBase;
+
+    std::atomic<bool> _profilingEnabled {false};
 };
 
 } /* namespace adk_internal */
@@ -318,6 +395,8 @@ public:
     }
 
 private:
+    friend class adk_internal::SignalBaseSpec<Signature>;
+
     std::function<Signature> _func;
 
     /** @param func Created function.
@@ -360,6 +439,8 @@ private:
         /** Nullptr when removed. */
         SignalBaseSpec *signal;
         std::mutex mutex;
+        /** Profiling counters. */
+        SignalBase::SlotStats stats;
 
         SlotEntry(SignalBaseSpec *signal, SlotType slot):
             slot(slot), signal(signal)
@@ -448,9 +529,76 @@ public:
         }
     }
 
-    /** Get list of slots for signal emission. */
+    /** Get list of slots for deferred signal emission. Invocations of the
+     * returned slots are accounted in the profiling statistics if profiling
+     * is enabled.
+     */
     std::list<SlotType>
     GetEmitSlots()
+    {
+        std::list<SlotType> slots;
+        for (EmitSlot &e: _GetEmitEntries(IsProfilingEnabled())) {
+            if (!e.entry) {
+                slots.emplace_back(std::move(e.slot));
+                continue;
+            }
+            SlotTarget *target = e.slot.GetTarget();
+            slots.emplace_back(SlotType([e = std::move(e)](auto &&...args) mutable {
+                return e(std::forward<decltype(args)>(args)...);
+            }, target));
+        }
+        return slots;
+    }
+
+    /** Get profiling statistics for currently connected slots.
+     * @see SignalBase::EnableProfiling
+     */
+    std::list<SignalBase::SlotProfile>
+    GetProfile()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        std::list<SignalBase::SlotProfile> profile;
+        for (const std::shared_ptr<SlotEntry> &e: _slots) {
+            profile.push_back(SignalBase::SlotProfile {
+                e->slot.GetTarget(),
+                e->stats.numCalls.load(std::memory_order_relaxed),
+                std::chrono::nanoseconds(e->stats.totalTime.load(std::memory_order_relaxed))});
+        }
+        return profile;
+    }
+
+    /** Reset profiling statistics for all connected slots. */
+    void
+    ResetProfile()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        for (const std::shared_ptr<SlotEntry> &e: _slots) {
+            e->stats.Reset();
+        }
+    }
+
+protected:
+    /** Slot prepared for emission. */
+    struct EmitSlot {
+        SlotType slot;
+        /** Set only when profiling is enabled. */
+        std::shared_ptr<SlotEntry> entry;
+
+        template <typename... Args>
+        ResultType
+        operator ()(Args &&...args)
+        {
+            SignalBase::SlotTimer timer(entry ? &entry->stats : nullptr);
+            return slot(std::forward<Args>(args)...);
+        }
+    };
+
+    /** Get list of slots for signal emission.
+     *
+     * @param profile Attach profiling counters to the returned slots.
+     */
+    std::list<EmitSlot>
+    _GetEmitEntries(bool profile)
     {
         std::list<std::shared_ptr<SlotEntry>> entries;
         {
@@ -459,8 +607,8 @@ public:
                 entries.emplace_back(e);
             }
         }
-        std::list<SlotType> slots;
-        for (const std::shared_ptr<SlotEntry> &e: entries) {
+        std::list<EmitSlot> slots;
+        for (std::shared_ptr<SlotEntry> &e: entries) {
             std::unique_lock<std::mutex> lock(e->mutex);
             if (!e->signal) {
                 continue;
@@ -471,7 +619,7 @@ public:
                 e->signal = nullptr;
                 continue;
             }
-            slots.emplace_back(e->slot);
+            slots.push_back(EmitSlot {e->slot, profile ? std::move(e) : nullptr});
         }
         return slots;
     }
@@ -558,7 +706,7 @@ public:
     decltype(std::declval<ResultMapper>().GetResult())
     EmitMap(ResultMapper &&resultMapper, Args &&...args)
     {
-        auto slots = BaseType::GetEmitSlots();
+        auto slots = BaseType::_GetEmitEntries(BaseType::IsProfilingEnabled());
         for (auto &slot: slots) {
             if (!resultMapper.ProcessResult(slot(args...))) {
                 break;
@@ -606,7 +754,7 @@ public:
     void
     Emit(Args ... args)
     {
-        auto slots = BaseType::GetEmitSlots();
+        auto slots = BaseType::_GetEmitEntries(BaseType::IsProfilingEnabled());
         for (auto &slot: slots) {
             slot(args...);
         }
@@ -624,6 +772,9 @@ public:
 template <typename Signature>
 using SignalConnection = typename Signal<Signature>::Connection;
 
+/** Per-slot profiling statistics. */
+typedef adk_internal::SignalBase::SlotProfile SignalSlotProfile;
+
 /** Class which only allows connecting slots to an associated signal. */
 template <typename Signature>
 class SignalProxy {
@@ -649,11 +800,599 @@ public:
         return _signal.Connect(std::move(slot));
     }
 
+    /** @see SignalBase::EnableProfiling */
+    void
+    EnableProfiling(bool enable = true)
+    {
+        _signal.EnableProfiling(enable);
+    }
+
+    /** @see SignalBaseSpec::GetProfile */
+    std::list<SignalSlotProfile>
+    GetProfile()
+    {
+        return _signal.GetProfile();
+    }
+
+    /** @see SignalBaseSpec::ResetProfile */
+    void
+    ResetProfile()
+    {
+        _signal.ResetProfile();
+    }
+
 private:
     /** Associated signal. */
     SignalType &_signal;
 };
 
+/** Lightweight non-owning reference to a callable - a pair of function pointer
+ * and object pointer. It is trivially copyable and its invocation is a single
+ * indirect call which can be inlined by the compiler down to the target
+ * method body. The referenced object lifetime is not tracked.
+ *
+ * @param Signature Invocation signature.
+ */
+template <typename Signature>
+class Delegate;
+
+template <typename Result, typename... Args>
+class Delegate<Result(Args...)> {
+public:
+    /** Invocation signature. */
+    typedef Result SignatureType(Args...);
+    /** Invocation result type. */
+    typedef Result ResultType;
+    /** Function which is invoked with the bound object pointer. */
+    typedef Result (*Thunk)(void *, Args...);
+
+    constexpr Delegate() = default;
+
+    constexpr Delegate(Thunk thunk, void *obj):
+        _thunk(thunk), _obj(obj)
+    {}
+
+    /** Create delegate for a free function or static method. */
+    template <Result (*func)(Args...)>
+    static constexpr Delegate
+    Make()
+    {
+        return Delegate(&_FuncThunk<func>, nullptr);
+    }
+
+    /** Create delegate for a class method bound to the specified object. */
+    template <class Class, Result (Class::*method)(Args...)>
+    static constexpr Delegate
+    Make(Class *obj)
+    {
+        return Delegate(&_MethodThunk<Class, method>, obj);
+    }
+
+    /** Create delegate for a constant class method bound to the specified
+     * object.
+     */
+    template <class Class, Result (Class::*method)(Args...) const>
+    static constexpr Delegate
+    Make(const Class *obj)
+    {
+        return Delegate(&_ConstMethodThunk<Class, method>,
+                        const_cast<Class *>(obj));
+    }
+
+    /** Create delegate for a callable object (functor or lambda). The object
+     * should outlive the delegate.
+     */
+    template <class Callable>
+    static constexpr Delegate
+    Make(Callable *callable)
+    {
+        return Delegate(&_CallableThunk<Callable>, callable);
+    }
+
+    /** Check if delegate is bound. */
+    constexpr operator bool() const
+    {
+        return _thunk != nullptr;
+    }
+
+    constexpr bool
+    operator ==(const Delegate &other) const
+    {
+        return _thunk == other._thunk && _obj == other._obj;
+    }
+
+    constexpr bool
+    operator !=(const Delegate &other) const
+    {
+        return !(*this == other);
+    }
+
+    /** Invoke the delegate. */
+    Result
+    operator ()(Args... args) const
+    {
+        return _thunk(_obj, std::forward<Args>(args)...);
+    }
+
+    Thunk
+    GetThunk() const
+    {
+        return _thunk;
+    }
+
+    void *
+    GetObject() const
+    {
+        return _obj;
+    }
+
+private:
+    Thunk _thunk = nullptr;
+    void *_obj = nullptr;
+
+    template <Result (*func)(Args...)>
+    static Result
+    _FuncThunk(void *, Args... args)
+    {
+        return func(std::forward<Args>(args)...);
+    }
+
+    template <class Class, Result (Class::*method)(Args...)>
+    static Result
+    _MethodThunk(void *obj, Args... args)
+    {
+        return (static_cast<Class *>(obj)->*method)(std::forward<Args>(args)...);
+    }
+
+    template <class Class, Result (Class::*method)(Args...) const>
+    static Result
+    _ConstMethodThunk(void *obj, Args... args)
+    {
+        return (static_cast<const Class *>(obj)->*method)(std::forward<Args>(args)...);
+    }
+
+    template <class Callable>
+    static Result
+    _CallableThunk(void *obj, Args... args)
+    {
+        return (*static_cast<Callable *>(obj))(std::forward<Args>(args)...);
+    }
+};
+
+namespace adk_internal {
+
+/** Slots storage for static signal. Fixed-capacity inline array of delegates
+ * for single-threaded use.
+ */
+template <typename Signature, size_t maxSlots, bool isAtomic>
+class StaticSignalStorage {
+public:
+    typedef Delegate<Signature> DelegateType;
+
+    /** Connect delegate to the first free entry.
+     *
+     * @return @a true if connected, @a false if there is no free entry.
+     */
+    bool
+    Connect(const DelegateType &d)
+    {
+        ASSERT(d);
+        for (size_t i = 0; i < _numSlots; i++) {
+            if (!_slots[i]) {
+                _slots[i] = d;
+                return true;
+            }
+        }
+        if (_numSlots == maxSlots) {
+            return false;
+        }
+        _slots[_numSlots++] = d;
+        return true;
+    }
+
+    /** Disconnect delegate.
+     *
+     * @return @a true if disconnected, @a false if not found.
+     */
+    bool
+    Disconnect(const DelegateType &d)
+    {
+        for (size_t i = 0; i < _numSlots; i++) {
+            if (_slots[i] == d) {
+                _slots[i] = DelegateType();
+                while (_numSlots && !_slots[_numSlots - 1]) {
+                    _numSlots--;
+                }
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /** Disconnect all delegates. */
+    void
+    DisconnectAll()
+    {
+        for (size_t i = 0; i < _numSlots; i++) {
+            _slots[i] = DelegateType();
+        }
+        _numSlots = 0;
+    }
+
+    /** Invoke the provided function for each connected delegate. */
+    template <class Func>
+    void
+    ForEach(Func &&func) const
+    {
+        for (size_t i = 0; i < _numSlots; i++) {
+            if (_slots[i]) {
+                func(_slots[i]);
+            }
+        }
+    }
+
+private:
+    DelegateType _slots[maxSlots];
+    /** Number of used entries (including disconnected holes). */
+    size_t _numSlots = 0;
+};
+
+/** In-progress emission of atomic static signal. Frames are linked in
+ * per-thread stack so that disconnection from a slot does not wait for the
+ * emission it is called from.
+ */
+struct StaticSignalEmission {
+    const void *storage;
+    /** Epoch parity the emission is registered in. */
+    unsigned parity;
+    StaticSignalEmission *prev;
+
+    /** Get the innermost emission of the current thread. */
+    static StaticSignalEmission *&
+    GetTop()
+    {
+        static thread_local StaticSignalEmission *top = nullptr;
+        return top;
+    }
+};
+
+/** Atomic publication variant. Connection and disconnection are serialized by
+ * spin-lock, emission is lock-free and can be done concurrently from any
+ * number of threads. Each entry is guarded by sequence counter so that
+ * emitting thread never observes torn function and object pointers pair.
+ *
+ * Emitting threads copy delegates, so a disconnected delegate may still be
+ * invoked by an emission in progress. Disconnection waits for such emissions
+ * to complete: each emission is counted in one of two counters selected by
+ * epoch parity, disconnection switches the epoch away from each parity in
+ * turn and waits for its counter to drain, so new emissions do not delay it.
+ * The waiting is done outside of the lock, so slots may connect and disconnect
+ * on the same signal.
+ */
+template <typename Signature, size_t maxSlots>
+class StaticSignalStorage<Signature, maxSlots, true> {
+public:
+    typedef Delegate<Signature> DelegateType;
+
+    bool
+    Connect(const DelegateType &d)
+    {
+        ASSERT(d);
+        SpinlockGuard lock(_lock);
+        size_t numSlots = _numSlots.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < numSlots; i++) {
+            if (!_slots[i].thunk.load(std::memory_order_relaxed)) {
+                _slots[i].Store(d);
+                return true;
+            }
+        }
+        if (numSlots == maxSlots) {
+            return false;
+        }
+        _slots[numSlots].Store(d);
+        _numSlots.store(numSlots + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool
+    Disconnect(const DelegateType &d)
+    {
+        bool found = false;
+        {
+            SpinlockGuard lock(_lock);
+            size_t numSlots = _numSlots.load(std::memory_order_relaxed);
+            for (size_t i = 0; i < numSlots; i++) {
+                if (_slots[i].Load() == d) {
+                    _slots[i].Store(DelegateType());
+                    found = true;
+                    break;
+                }
+            }
+        }
+        /* Slots may connect or disconnect on this signal, so do not hold the
+         * lock while waiting for them.
+         */
+        if (found) {
+            _WaitEmissions();
+        }
+        return found;
+    }
+
+    void
+    DisconnectAll()
+    {
+        {
+            SpinlockGuard lock(_lock);
+            size_t numSlots = _numSlots.load(std::memory_order_relaxed);
+            for (size_t i = 0; i < numSlots; i++) {
+                _slots[i].Store(DelegateType());
+            }
+        }
+        _WaitEmissions();
+    }
+
+    template <class Func>
+    void
+    ForEach(Func &&func) const
+    {
+        EmissionGuard guard(*this);
+        size_t numSlots = _numSlots.load(std::memory_order_acquire);
+        for (size_t i = 0; i < numSlots; i++) {
+            DelegateType d = _slots[i].Load();
+            if (d) {
+                func(d);
+            }
+        }
+    }
+
+private:
+    struct Entry {
+        std::atomic<unsigned> seq {0};
+        std::atomic<typename DelegateType::Thunk> thunk {nullptr};
+        std::atomic<void *> obj {nullptr};
+
+        /** Should be called with the storage lock acquired. */
+        void
+        Store(const DelegateType &d)
+        {
+            unsigned s = seq.load(std::memory_order_relaxed);
+            seq.store(s + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            thunk.store(d.GetThunk(), std::memory_order_relaxed);
+            obj.store(d.GetObject(), std::memory_order_relaxed);
+            seq.store(s + 2, std::memory_order_release);
+        }
+
+        DelegateType
+        Load() const
+        {
+            while (true) {
+                unsigned s = seq.load(std::memory_order_acquire);
+                if (UNLIKELY(s & 1)) {
+                    continue;
+                }
+                DelegateType d(thunk.load(std::memory_order_relaxed),
+                               obj.load(std::memory_order_relaxed));
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (LIKELY(seq.load(std::memory_order_relaxed) == s)) {
+                    return d;
+                }
+            }
+        }
+    };
+
+    /** Registers emission for the scope lifetime. */
+    class EmissionGuard {
+    public:
+        EmissionGuard(const StaticSignalStorage &storage):
+            _storage(storage)
+        {
+            /* Re-check the epoch after registration, otherwise disconnection
+             * could miss the counter increment.
+             */
+            while (true) {
+                unsigned parity = storage._epoch.load() & 1;
+                storage._numEmissions[parity]++;
+                if ((storage._epoch.load() & 1) == parity) {
+                    _frame.parity = parity;
+                    break;
+                }
+                storage._numEmissions[parity]--;
+            }
+            StaticSignalEmission *&top = StaticSignalEmission::GetTop();
+            _frame.storage = &storage;
+            _frame.prev = top;
+            top = &_frame;
+        }
+
+        ~EmissionGuard()
+        {
+            StaticSignalEmission::GetTop() = _frame.prev;
+            _storage._numEmissions[_frame.parity]--;
+        }
+
+    private:
+        const StaticSignalStorage &_storage;
+        StaticSignalEmission _frame;
+    };
+
+    Entry _slots[maxSlots];
+    std::atomic<size_t> _numSlots {0};
+    Spinlock _lock;
+    /** Incremented by each disconnection, the lowest bit selects the counter
+     * for new emissions.
+     */
+    std::atomic<unsigned> _epoch {0};
+    mutable std::atomic<size_t> _numEmissions[2] {{0}, {0}};
+
+    /** Wait until all emissions started before the call are complete. The
+     * emissions of the calling thread are not waited for. Called without the
+     * lock held, so concurrent disconnections may flip the epoch as well -
+     * each parity is therefore waited for explicitly, switching the epoch
+     * away from it whenever it is current.
+     */
+    void
+    _WaitEmissions()
+    {
+        unsigned first = _epoch.load() & 1;
+        for (unsigned parity: {first, first ^ 1}) {
+            size_t numOwn = 0;
+            for (StaticSignalEmission *e = StaticSignalEmission::GetTop(); e; e = e->prev) {
+                if (e->storage == this && e->parity == parity) {
+                    numOwn++;
+                }
+            }
+            while (true) {
+                unsigned epoch = _epoch.load();
+                if ((epoch & 1) == parity) {
+                    _epoch.compare_exchange_weak(epoch, epoch + 1);
+                    continue;
+                }
+                if (_numEmissions[parity].load() == numOwn) {
+                    break;
+                }
+                std::this_thread::yield();
+            }
+        }
+    }
+};
+
+template <typename Signature, size_t maxSlots, bool isAtomic>
+class StaticSignalBase {
+public:
+    /** Invocation signature. */
+    typedef Signature SignatureType;
+    /** Corresponding delegate type. */
+    typedef Delegate<Signature> DelegateType;
+    /** Emission result type. */
+    typedef SignatureResult<Signature> ResultType;
+
+    /** Maximal number of simultaneously connected delegates. */
+    static constexpr size_t
+    MaxSlots()
+    {
+        return maxSlots;
+    }
+
+    /** Connect delegate.
+     *
+     * @return @a true if connected, @a false if the signal capacity is
+     *      exhausted.
+     */
+    bool
+    Connect(const DelegateType &d)
+    {
+        return _storage.Connect(d);
+    }
+
+    /** Disconnect previously connected delegate. For the atomic variant
+     * waits for the emissions in progress in other threads.
+     *
+     * @return @a true if disconnected, @a false if the delegate was not
+     *      connected.
+     */
+    bool
+    Disconnect(const DelegateType &d)
+    {
+        return _storage.Disconnect(d);
+    }
+
+    /** Disconnect all delegates. For the atomic variant waits for the
+     * emissions in progress in other threads.
+     */
+    void
+    DisconnectAll()
+    {
+        _storage.DisconnectAll();
+    }
+
+protected:
+    StaticSignalStorage<Signature, maxSlots, isAtomic> _storage;
+};
+
+} /* namespace adk_internal */
+
+/** Signal with compile-time fixed capacity of slots. Slots are delegates
+ * (function pointer and object pointer pairs) stored inline in the signal
+ * object, so no dynamic allocations, no reference counting and no mutexes
+ * are involved in the emission. It is intended for tight inner loops where
+ * @ref Signal overhead is not acceptable. Unlike @ref Signal, the slot targets
+ * lifetime is not tracked - it is a caller responsibility to disconnect
+ * delegates before the bound objects are destroyed. For the atomic variant
+ * @ref Disconnect and @ref DisconnectAll return only after all concurrent
+ * emissions which could still invoke the delegate have returned, so the
+ * target can be destroyed right after that. Emissions of the calling thread
+ * (when disconnecting from a slot) are not waited for, and disconnection
+ * should not be called while holding a lock which any slot may acquire.
+ *
+ * @param Signature Invocation signature.
+ * @param maxSlots Maximal number of simultaneously connected delegates.
+ * @param isAtomic Use atomic publication of slots so that the signal can be
+ *      emitted concurrently from several threads while slots are connected and
+ *      disconnected. When @a false the signal is for single-threaded use only.
+ */
+template <typename Signature, size_t maxSlots, bool isAtomic = false,
+          typename = void>
+class StaticSignal:
+    public adk_internal::StaticSignalBase<Signature, maxSlots, isAtomic> {
+public:
+    typedef adk_internal::StaticSignalBase<Signature, maxSlots, isAtomic> BaseType;
+
+    /** Emit the signal.
+     *
+     * @param args Arguments for connected slots.
+     * @return Last slot result, default constructed value if there are no
+     *      slots connected.
+     */
+    template <typename... Args>
+    typename BaseType::ResultType
+    Emit(Args &&...args) const
+    {
+        typename BaseType::ResultType result = typename BaseType::ResultType();
+        BaseType::_storage.ForEach(
+            [&](const typename BaseType::DelegateType &d) {
+                result = d(args...);
+            });
+        return result;
+    }
+
+    template <typename... Args>
+    typename BaseType::ResultType
+    operator()(Args &&...args) const
+    {
+        return Emit(std::forward<Args>(args)...);
+    }
+};
+
+template <typename Signature, size_t maxSlots, bool isAtomic>
+class StaticSignal<Signature, maxSlots, isAtomic,
+                   typename std::enable_if<adk_internal::SignatureResultIsVoid<Signature>()>::type>:
+    public adk_internal::StaticSignalBase<Signature, maxSlots, isAtomic> {
+public:
+    typedef adk_internal::StaticSignalBase<Signature, maxSlots, isAtomic> BaseType;
+
+    template <typename... Args>
+    void
+    Emit(Args &&...args) const
+    {
+        BaseType::_storage.ForEach(
+            [&](const typename BaseType::DelegateType &d) {
+                d(args...);
+            });
+    }
+
+    template <typename... Args>
+    void
+    operator()(Args &&...args) const
+    {
+        Emit(std::forward<Args>(args)...);
+    }
+};
+
+/** Static signal which can be emitted concurrently from several threads. */
+template <typename Signature, size_t maxSlots>
+using AtomicStaticSignal = StaticSignal<Signature, maxSlots, true>;
+
 } /* namespace adk */
 
 #endif /* SIGNAL_H_ */
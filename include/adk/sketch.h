@@ -0,0 +1,272 @@
+/* This file is a part of ADK library.
+ * Copyright (c) 2012-2015, Artyom Lebedev <artyom.lebedev@gmail.com>
+ * All rights reserved.
+ * See LICENSE file for copyright details.
+ */
+
+/** @file sketch.h
+ * Probabilistic data structures for membership, frequency and cardinality
+ * estimation.
+ */
+
+#ifndef SKETCH_H_
+#define SKETCH_H_
+
+namespace adk {
+
+/** Blocked Bloom filter. Each item sets bits in a single cache-line-sized
+ * block, so any operation touches one cache line only. This slightly
+ * increases false positive rate compared to the classic filter, the sizing
+ * compensates it.
+ *
+ * Items are hashed by @ref Hash::Compute64, the two 32-bits halves are used
+ * for double hashing. Filters created with the same parameters can be merged,
+ * so per-thread filters can be filled without locking and combined later.
+ */
+class BloomFilter {
+public:
+    /** Create empty filter.
+     *
+     * @param numItems Expected number of items.
+     * @param falsePositiveRate Desired false positive probability when the
+     *      expected number of items is added.
+     * @param seed Seed for hash function.
+     */
+    BloomFilter(size_t numItems, double falsePositiveRate = 0.01, u32 seed = 0);
+
+    BloomFilter(BloomFilter &&) = default;
+
+    BloomFilter &
+    operator =(BloomFilter &&) = default;
+
+    /** Add item to the set. */
+    void
+    Add(const void *data, size_t size)
+    {
+        AddHash(Hash::Compute64(data, size, _seed));
+    }
+
+    /** Add item by its hash value (as returned by @ref Hash::Compute64 with
+     * the filter seed).
+     */
+    void
+    AddHash(u64 hash);
+
+    /** Check if the item may be in the set.
+     *
+     * @return False if the item was definitely not added, true if it was
+     *      added or in case of false positive.
+     */
+    bool
+    Contains(const void *data, size_t size) const
+    {
+        return ContainsHash(Hash::Compute64(data, size, _seed));
+    }
+
+    /** Check if the item with the specified hash value may be in the set. */
+    bool
+    ContainsHash(u64 hash) const;
+
+    /** Merge other filter into this one. The result is the filter of the
+     * union of the sets.
+     *
+     * @throws InvalidParamException if the filters have different parameters.
+     */
+    void
+    Merge(const BloomFilter &other);
+
+    /** Remove all items. */
+    void
+    Clear();
+
+    /** Get number of hash functions (bits set per item). */
+    int
+    GetNumHashes() const
+    {
+        return _numHashes;
+    }
+
+    /** Get size of the bits array in bytes. */
+    size_t
+    GetSizeBytes() const
+    {
+        return _numBlocks * BLOCK_SIZE;
+    }
+
+private:
+    enum {
+        /** Block size in bytes, equal to the cache line size. */
+        BLOCK_SIZE = 64,
+        /** Number of 64-bits words in a block. */
+        BLOCK_WORDS = BLOCK_SIZE / sizeof(u64),
+        /** Maximal number of hash functions. */
+        MAX_HASHES = 16
+    };
+
+    /** Storage for the blocks. */
+    std::unique_ptr<u64[]> _storage;
+    /** Blocks array aligned to the cache line size. */
+    u64 *_blocks;
+    size_t _numBlocks;
+    int _numHashes;
+    u32 _seed;
+
+    /** Get block for the specified hash value. */
+    u64 *
+    _GetBlock(u64 hash) const
+    {
+        return &_blocks[((hash & 0xffffffff) * _numBlocks >> 32) * BLOCK_WORDS];
+    }
+};
+
+/** Count-min sketch for estimating items frequencies in a stream. Estimated
+ * count is never less than the true one, and it exceeds the true count by no
+ * more than @a epsilon * total count with probability 1 - @a delta.
+ *
+ * Items are hashed by @ref Hash::Compute64, the two 32-bits halves are used
+ * for double hashing. Sketches created with the same parameters can be
+ * merged.
+ */
+class CountMinSketch {
+public:
+    /** Create empty sketch.
+     *
+     * @param epsilon Relative error bound.
+     * @param delta Probability of exceeding the error bound.
+     * @param seed Seed for hash function.
+     */
+    CountMinSketch(double epsilon = 0.001, double delta = 0.01, u32 seed = 0);
+
+    /** Add occurrences of the item. */
+    void
+    Add(const void *data, size_t size, u64 count = 1)
+    {
+        AddHash(Hash::Compute64(data, size, _seed), count);
+    }
+
+    /** Add occurrences of the item by its hash value. */
+    void
+    AddHash(u64 hash, u64 count = 1);
+
+    /** Get estimated number of occurrences of the item. */
+    u64
+    Estimate(const void *data, size_t size) const
+    {
+        return EstimateHash(Hash::Compute64(data, size, _seed));
+    }
+
+    /** Get estimated number of occurrences of the item by its hash value. */
+    u64
+    EstimateHash(u64 hash) const;
+
+    /** Merge other sketch into this one. The result is the sketch of the
+     * concatenated streams.
+     *
+     * @throws InvalidParamException if the sketches have different parameters.
+     */
+    void
+    Merge(const CountMinSketch &other);
+
+    /** Remove all items. */
+    void
+    Clear();
+
+    /** Get total count of all added items. */
+    u64
+    GetTotal() const
+    {
+        return _total;
+    }
+
+    /** Get number of counters in each row. */
+    size_t
+    GetWidth() const
+    {
+        return _width;
+    }
+
+    /** Get number of rows. */
+    size_t
+    GetDepth() const
+    {
+        return _depth;
+    }
+
+private:
+    /** Counters, row-major. */
+    std::vector<u64> _counters;
+    /** Row width, power of two. */
+    size_t _width;
+    size_t _depth;
+    u64 _total = 0;
+    u32 _seed;
+};
+
+/** HyperLogLog cardinality estimator. Standard error of the estimation is
+ * about 1.04 / sqrt(2^precision). Counters created with the same parameters
+ * can be merged, the result estimates cardinality of the union.
+ */
+class HyperLogLog {
+public:
+    enum {
+        MIN_PRECISION = 4,
+        MAX_PRECISION = 18
+    };
+
+    /** Create empty counter.
+     *
+     * @param precision Number of index bits, 2^precision registers are used.
+     * @param seed Seed for hash function.
+     */
+    HyperLogLog(int precision = 14, u32 seed = 0);
+
+    /** Add item. */
+    void
+    Add(const void *data, size_t size)
+    {
+        AddHash(Hash::Compute64(data, size, _seed));
+    }
+
+    /** Add item by its hash value. */
+    void
+    AddHash(u64 hash)
+    {
+        size_t idx = hash >> (64 - _precision);
+        /* Guard bit limits the rank for zero remainder. */
+        u64 rest = (hash << _precision) | (static_cast<u64>(1) << (_precision - 1));
+        u8 rank = CountLeadingZeros(rest) + 1;
+        if (rank > _registers[idx]) {
+            _registers[idx] = rank;
+        }
+    }
+
+    /** Get estimated number of distinct items added. */
+    double
+    Estimate() const;
+
+    /** Merge other counter into this one.
+     *
+     * @throws InvalidParamException if the counters have different parameters.
+     */
+    void
+    Merge(const HyperLogLog &other);
+
+    /** Remove all items. */
+    void
+    Clear();
+
+    int
+    GetPrecision() const
+    {
+        return _precision;
+    }
+
+private:
+    std::vector<u8> _registers;
+    int _precision;
+    u32 _seed;
+};
+
+} /* namespace adk */
+
+#endif /* SKETCH_H_ */
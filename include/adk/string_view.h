@@ -0,0 +1,139 @@
+/* This file is a part of ADK library.
+ * Copyright (c) 2012-2015, Artyom Lebedev <artyom.lebedev@gmail.com>
+ * All rights reserved.
+ * See LICENSE file for copyright details.
+ */
+
+/** @file string_view.h
+ * Non-owning reference to a characters string.
+ */
+
+#ifndef STRING_VIEW_H_
+#define STRING_VIEW_H_
+
+namespace adk {
+
+/** Non-owning reference to a contiguous characters sequence. It is a subset
+ * of std::string_view interface (which is not available in C++14), so the
+ * accessors follow the standard library naming. Mainly used for lookups
+ * which should not create temporary std::string objects.
+ */
+class StringView {
+public:
+    typedef const char *const_iterator;
+
+    constexpr StringView():
+        _data(nullptr), _size(0)
+    {}
+
+    constexpr StringView(const char *data, size_t size):
+        _data(data), _size(size)
+    {}
+
+    StringView(const char *str):
+        _data(str), _size(strlen(str))
+    {}
+
+    StringView(const std::string &str):
+        _data(str.data()), _size(str.size())
+    {}
+
+    constexpr const char *
+    data() const
+    {
+        return _data;
+    }
+
+    constexpr size_t
+    size() const
+    {
+        return _size;
+    }
+
+    constexpr bool
+    empty() const
+    {
+        return !_size;
+    }
+
+    constexpr const_iterator
+    begin() const
+    {
+        return _data;
+    }
+
+    constexpr const_iterator
+    end() const
+    {
+        return _data + _size;
+    }
+
+    char
+    operator [](size_t idx) const
+    {
+        ASSERT(idx < _size);
+        return _data[idx];
+    }
+
+    /** Lexicographical comparison.
+     *
+     * @return Negative value if this string is less than the other one, zero
+     *      if they are equal, positive value otherwise.
+     */
+    int
+    compare(StringView other) const
+    {
+        int res = memcmp(_data, other._data, Min(_size, other._size));
+        if (res) {
+            return res;
+        }
+        return _size < other._size ? -1 : (_size > other._size ? 1 : 0);
+    }
+
+    /** Create std::string with a copy of the characters. */
+    std::string
+    ToString() const
+    {
+        return std::string(_data, _size);
+    }
+
+    /** Implicit conversion allows constructing std::string keys from the
+     * view, e.g. when inserting into a map.
+     */
+    operator std::string() const
+    {
+        return ToString();
+    }
+
+private:
+    const char *_data;
+    size_t _size;
+};
+
+inline bool
+operator ==(StringView a, StringView b)
+{
+    return a.size() == b.size() && !memcmp(a.data(), b.data(), a.size());
+}
+
+inline bool
+operator !=(StringView a, StringView b)
+{
+    return !(a == b);
+}
+
+inline bool
+operator <(StringView a, StringView b)
+{
+    return a.compare(b) < 0;
+}
+
+inline std::ostream &
+operator <<(std::ostream &stream, StringView str)
+{
+    return stream.write(str.data(), str.size());
+}
+
+} /* namespace adk */
+
+#endif /* STRING_VIEW_H_ */
@@ -41,13 +41,33 @@ public:
     void
     Terminate();
 
+    /** Get index of the calling worker thread in its pool. Indices are in
+     * range [0; numThreads), so they do not depend on other pools.
+     *
+     * @return Worker index, -1 if the calling thread is not a thread pool
+     *      worker.
+     */
+    static int
+    GetCurrentWorkerIndex();
+
+    /** Get index of the pool the calling worker thread belongs to. Pools are
+     * indexed sequentially in order of creation, so indices are stable between
+     * runs regardless of the pools sizes.
+     *
+     * @return Pool index, -1 if the calling thread is not a thread pool
+     *      worker.
+     */
+    static int
+    GetCurrentPoolIndex();
+
 private:
     int numThreads;
+    int poolIndex;
     std::vector<std::thread> threads;
     MessageQueue<Action> queue;
 
     void
-    ThreadFunc();
+    ThreadFunc(int workerIndex);
 };
 
 }
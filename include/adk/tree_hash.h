@@ -0,0 +1,112 @@
+/* This file is a part of ADK library.
+ * Copyright (c) 2012-2015, Artyom Lebedev <artyom.lebedev@gmail.com>
+ * All rights reserved.
+ * See LICENSE file for copyright details.
+ */
+
+/** @file tree_hash.h
+ * Parallel tree hashing of large data.
+ */
+
+#ifndef TREE_HASH_H_
+#define TREE_HASH_H_
+
+namespace adk {
+
+/** Tree hash calculation class. Input is split into fixed-size leaves, each
+ * leaf is hashed by @ref Hash128 independently, and leaf digests are hashed
+ * in order into the root digest. Leaves may be hashed in parallel by the
+ * provided executor, the result depends only on the data, leaf size and
+ * seed, and not on the number of threads or the way the data is split
+ * between @ref Feed calls.
+ */
+class TreeHash {
+public:
+    enum {
+        /** Default size of a leaf. */
+        DEFAULT_LEAF_SIZE = 1024 * 1024
+    };
+
+    /** Create hash object.
+     *
+     * @param executor Executor for hashing leaves in parallel. Leaves are
+     *      hashed in the calling thread if it is null. The calling thread
+     *      takes part in hashing as well, and hashes the leaves which are not
+     *      picked up by the executor (e.g. when it is terminating, fails to
+     *      submit an action, or @ref Feed is called from one of its threads).
+     * @param leafSize Size of a leaf in bytes.
+     * @param seed Seed value for a hash.
+     */
+    TreeHash(Executor *executor = nullptr, size_t leafSize = DEFAULT_LEAF_SIZE,
+             u64 seed = 0);
+
+    /** Reset the calculator state to the initial one. Executor and leaf size
+     * are preserved.
+     *
+     * @param seed Seed value for a hash.
+     */
+    void
+    Reset(u64 seed = 0);
+
+    /** Feed input data to hash calculator. Whole leaves contained in the
+     * provided data are hashed in parallel, so bigger portions allow better
+     * utilization of the executor threads.
+     *
+     * @param data Next portion of input data.
+     * @param size Size in bytes of provided data.
+     */
+    void
+    Feed(const void *data, size_t size);
+
+    /** Get 128-bits hash value based on data fed so far. */
+    Hash128::Value
+    Get128() const;
+
+    /** Get 64-bits hash value based on data fed so far. It is the low part of
+     * the 128-bits value.
+     */
+    u64
+    Get64() const
+    {
+        return Get128().low;
+    }
+
+    /** Get total length of data fed to the calculator input so far. */
+    size_t
+    GetLength() const
+    {
+        return _length;
+    }
+
+    /** Calculate tree hash of the data in one shot. The result is the same as
+     * feeding the data to a new hash object and calling @ref Get128.
+     */
+    static Hash128::Value
+    Compute128(const void *data, size_t size, Executor *executor = nullptr,
+               size_t leafSize = DEFAULT_LEAF_SIZE, u64 seed = 0);
+
+private:
+    Executor *_executor;
+    size_t _leafSize;
+    u64 _seed;
+    /** Hash of the current incomplete leaf. */
+    Hash128 _leaf;
+    /** Hash of leaf digests. */
+    Hash128 _root;
+    /** Total length of data consumed by the calculator so far. */
+    size_t _length = 0;
+
+    /** Hash the specified number of whole leaves and feed their digests to
+     * the root hash.
+     */
+    void
+    _FeedLeaves(const u8 *data, size_t numLeaves);
+
+    /** Feed leaf digest to the root hash. */
+    static void
+    _FeedDigest(Hash128 &root, const Hash128::Value &digest);
+};
+
+} /* namespace adk */
+
+#endif /* TREE_HASH_H_ */
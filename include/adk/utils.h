@@ -91,6 +91,44 @@ RotR(const T value, const size_t numBits)
     return (value >> numBits) | (value << (sizeof(value) * NBBY - numBits));
 }
 
+/** Get number of trailing zero bits in the value. Value must not be zero.
+ * Any integer type up to 64 bits is accepted.
+ */
+template <typename T>
+inline constexpr size_t
+CountTrailingZeros(T value)
+{
+    return sizeof(T) <= sizeof(unsigned) ?
+        __builtin_ctz(static_cast<typename std::make_unsigned<T>::type>(value)) :
+        __builtin_ctzll(static_cast<typename std::make_unsigned<T>::type>(value));
+}
+
+/** Get number of leading zero bits in the value. Value must not be zero.
+ * Any integer type up to 64 bits is accepted.
+ */
+template <typename T>
+inline constexpr size_t
+CountLeadingZeros(T value)
+{
+    return sizeof(T) <= sizeof(unsigned) ?
+        __builtin_clz(static_cast<typename std::make_unsigned<T>::type>(value)) -
+            (sizeof(unsigned) - sizeof(T)) * NBBY :
+        __builtin_clzll(static_cast<typename std::make_unsigned<T>::type>(value)) -
+            (sizeof(unsigned long long) - sizeof(T)) * NBBY;
+}
+
+/** Get number of set bits in the value. Any integer type up to 64 bits is
+ * accepted.
+ */
+template <typename T>
+inline constexpr size_t
+CountOnes(T value)
+{
+    return sizeof(T) <= sizeof(unsigned) ?
+        __builtin_popcount(static_cast<typename std::make_unsigned<T>::type>(value)) :
+        __builtin_popcountll(static_cast<typename std::make_unsigned<T>::type>(value));
+}
+
 /** Helper structure for accessing unaligned data fields.
  * @see GetUnaligned
  * @see PutUnaligned
@@ -0,0 +1,835 @@
+/* This file is a part of ADK library.
+ * Copyright (c) 2012-2015, Artyom Lebedev <artyom.lebedev@gmail.com>
+ * All rights reserved.
+ * See LICENSE file for copyright details.
+ */
+
+/** @file compressed_bitmap.cpp
+ * Compressed bitmap implementation.
+ */
+
+#include <adk.h>
+
+using namespace adk;
+
+namespace {
+
+/** Serialized form signature ("ADKR" in little-endian). */
+const u32 SERIALIZED_MAGIC = 0x524b4441;
+
+/** Serialized form header. All fields are little-endian. */
+struct SerializedHeader {
+    u32 magic;
+    u32 numContainers;
+} __PACKED;
+
+/** Serialized container descriptor. All fields are little-endian. */
+struct SerializedDesc {
+    /** High 16 bits of values. */
+    u16 key;
+    /** Container type. */
+    u8 type;
+    u8 reserved;
+    /** Number of values in the container. */
+    u32 cardinality;
+    /** Number of payload elements - values for array, runs for run
+     * container, words for bitset.
+     */
+    u32 numElements;
+    /** Payload offset relatively to the serialized data start. */
+    u32 offset;
+} __PACKED;
+
+/** Payload alignment in serialized form. */
+const size_t SERIALIZED_ALIGN = 8;
+
+enum class Op {
+    AND,
+    OR,
+    XOR,
+    AND_NOT
+};
+
+/** Number of runs of set bits in the bitset. */
+size_t
+CountRuns(const u64 *bits, size_t numWords)
+{
+    size_t numRuns = 0;
+    u64 prevHigh = 0;
+    for (size_t i = 0; i < numWords; i++) {
+        u64 w = bits[i];
+        /* Run starts where the bit is set and the preceding one is clear. */
+        numRuns += CountOnes(w & ~((w << 1) | prevHigh));
+        prevHigh = w >> 63;
+    }
+    return numRuns;
+}
+
+} /* anonymous namespace */
+
+/* ****************************************************************************/
+/* CompressedBitmap::Container class. */
+
+bool
+CompressedBitmap::Container::Add(u16 value)
+{
+    if (type == Type::RUN) {
+        if (Contains(value)) {
+            return false;
+        }
+        Normalize();
+    }
+    if (type == Type::BITSET) {
+        u64 &w = bits[value / 64];
+        u64 mask = static_cast<u64>(1) << (value % 64);
+        if (w & mask) {
+            return false;
+        }
+        w |= mask;
+        cardinality++;
+        return true;
+    }
+    auto it = std::lower_bound(values.begin(), values.end(), value);
+    if (it != values.end() && *it == value) {
+        return false;
+    }
+    values.insert(it, value);
+    cardinality++;
+    if (cardinality > MAX_ARRAY_SIZE) {
+        ToBitset();
+    }
+    return true;
+}
+
+bool
+CompressedBitmap::Container::Remove(u16 value)
+{
+    if (type == Type::RUN) {
+        if (!Contains(value)) {
+            return false;
+        }
+        ToBitset();
+    }
+    if (type == Type::BITSET) {
+        u64 &w = bits[value / 64];
+        u64 mask = static_cast<u64>(1) << (value % 64);
+        if (!(w & mask)) {
+            return false;
+        }
+        w &= ~mask;
+        cardinality--;
+        if (cardinality <= MAX_ARRAY_SIZE / 2) {
+            /* Hysteresis to avoid flapping between representations. */
+            Normalize();
+        }
+        return true;
+    }
+    auto it = std::lower_bound(values.begin(), values.end(), value);
+    if (it == values.end() || *it != value) {
+        return false;
+    }
+    values.erase(it);
+    cardinality--;
+    return true;
+}
+
+bool
+CompressedBitmap::Container::Contains(u16 value) const
+{
+    switch (type) {
+    case Type::ARRAY:
+        return std::binary_search(values.begin(), values.end(), value);
+    case Type::BITSET:
+        return bits[value / 64] & (static_cast<u64>(1) << (value % 64));
+    case Type::RUN: {
+        /* Find the last run starting not after the value. */
+        size_t lo = 0, hi = values.size() / 2;
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (values[mid * 2] <= value) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        if (!lo) {
+            return false;
+        }
+        lo--;
+        return value - values[lo * 2] <= values[lo * 2 + 1];
+    }
+    }
+    return false;
+}
+
+int
+CompressedBitmap::Container::FindFirst(u16 value) const
+{
+    switch (type) {
+    case Type::ARRAY: {
+        auto it = std::lower_bound(values.begin(), values.end(), value);
+        return it == values.end() ? -1 : *it;
+    }
+    case Type::BITSET: {
+        size_t wordIdx = value / 64;
+        u64 w = bits[wordIdx] & (~static_cast<u64>(0) << (value % 64));
+        while (!w) {
+            if (++wordIdx == BITSET_WORDS) {
+                return -1;
+            }
+            w = bits[wordIdx];
+        }
+        return wordIdx * 64 + CountTrailingZeros(w);
+    }
+    case Type::RUN:
+        for (size_t i = 0; i < values.size(); i += 2) {
+            u32 end = static_cast<u32>(values[i]) + values[i + 1];
+            if (end >= value) {
+                return Max<int>(values[i], value);
+            }
+        }
+        return -1;
+    }
+    return -1;
+}
+
+const u64 *
+CompressedBitmap::Container::GetBits(std::vector<u64> &buf) const
+{
+    if (type == Type::BITSET) {
+        return bits.data();
+    }
+    buf.assign(BITSET_WORDS, 0);
+    if (type == Type::ARRAY) {
+        for (u16 v: values) {
+            buf[v / 64] |= static_cast<u64>(1) << (v % 64);
+        }
+    } else {
+        for (size_t i = 0; i < values.size(); i += 2) {
+            u32 end = static_cast<u32>(values[i]) + values[i + 1];
+            for (u32 v = values[i]; v <= end; v++) {
+                buf[v / 64] |= static_cast<u64>(1) << (v % 64);
+            }
+        }
+    }
+    return buf.data();
+}
+
+void
+CompressedBitmap::Container::ToBitset()
+{
+    if (type == Type::BITSET) {
+        return;
+    }
+    GetBits(bits);
+    values.clear();
+    values.shrink_to_fit();
+    type = Type::BITSET;
+}
+
+void
+CompressedBitmap::Container::Normalize()
+{
+    if (cardinality > MAX_ARRAY_SIZE) {
+        ToBitset();
+        return;
+    }
+    if (type == Type::ARRAY) {
+        return;
+    }
+    std::vector<u16> array;
+    array.reserve(cardinality);
+    std::vector<u64> buf;
+    const u64 *b = GetBits(buf);
+    for (size_t wordIdx = 0; wordIdx < BITSET_WORDS; wordIdx++) {
+        u64 w = b[wordIdx];
+        while (w) {
+            array.push_back(wordIdx * 64 + CountTrailingZeros(w));
+            w &= w - 1;
+        }
+    }
+    values = std::move(array);
+    bits.clear();
+    bits.shrink_to_fit();
+    type = Type::ARRAY;
+}
+
+void
+CompressedBitmap::Container::RunOptimize()
+{
+    if (type == Type::RUN) {
+        return;
+    }
+    std::vector<u64> buf;
+    const u64 *b = GetBits(buf);
+    size_t numRuns = CountRuns(b, BITSET_WORDS);
+    if (numRuns * 2 * sizeof(u16) >= GetPayloadSize()) {
+        return;
+    }
+    std::vector<u16> runs;
+    runs.reserve(numRuns * 2);
+    u32 v = 0;
+    while (v < 65536) {
+        int start = FindFirst(v);
+        if (start < 0) {
+            break;
+        }
+        /* Find run end - first clear bit after the start. */
+        u32 end = start;
+        while (end + 1 < 65536 && (b[(end + 1) / 64] & (static_cast<u64>(1) << ((end + 1) % 64)))) {
+            end++;
+        }
+        runs.push_back(start);
+        runs.push_back(end - start);
+        v = end + 2;
+    }
+    values = std::move(runs);
+    bits.clear();
+    bits.shrink_to_fit();
+    type = Type::RUN;
+}
+
+size_t
+CompressedBitmap::Container::GetPayloadSize() const
+{
+    if (type == Type::BITSET) {
+        return BITSET_WORDS * sizeof(u64);
+    }
+    return values.size() * sizeof(u16);
+}
+
+/* ****************************************************************************/
+/* CompressedBitmap class. */
+
+namespace {
+
+/** Apply binary operation to a pair of containers, result is stored in the
+ * first one.
+ */
+template <class Container>
+void
+ApplyOp(Container &a, const Container &b, Op op)
+{
+    typedef typename Container::Type Type;
+
+    if (a.type == Type::ARRAY && b.type == Type::ARRAY) {
+        std::vector<u16> r;
+        auto out = std::back_inserter(r);
+        switch (op) {
+        case Op::AND:
+            std::set_intersection(a.values.begin(), a.values.end(),
+                                  b.values.begin(), b.values.end(), out);
+            break;
+        case Op::OR:
+            std::set_union(a.values.begin(), a.values.end(),
+                           b.values.begin(), b.values.end(), out);
+            break;
+        case Op::XOR:
+            std::set_symmetric_difference(a.values.begin(), a.values.end(),
+                                          b.values.begin(), b.values.end(), out);
+            break;
+        case Op::AND_NOT:
+            std::set_difference(a.values.begin(), a.values.end(),
+                                b.values.begin(), b.values.end(), out);
+            break;
+        }
+        a.values = std::move(r);
+        a.cardinality = a.values.size();
+        a.Normalize();
+        return;
+    }
+
+    if (a.type == Type::ARRAY && (op == Op::AND || op == Op::AND_NOT)) {
+        /* Result is subset of the array so just filter it. */
+        bool keep = op == Op::AND;
+        auto end = std::remove_if(a.values.begin(), a.values.end(),
+                                  [&](u16 v) { return b.Contains(v) != keep; });
+        a.values.erase(end, a.values.end());
+        a.cardinality = a.values.size();
+        return;
+    }
+
+    a.ToBitset();
+    std::vector<u64> buf;
+    const u64 *bb = b.GetBits(buf);
+    u32 cardinality = 0;
+    for (size_t i = 0; i < Container::BITSET_WORDS; i++) {
+        u64 &w = a.bits[i];
+        switch (op) {
+        case Op::AND:
+            w &= bb[i];
+            break;
+        case Op::OR:
+            w |= bb[i];
+            break;
+        case Op::XOR:
+            w ^= bb[i];
+            break;
+        case Op::AND_NOT:
+            w &= ~bb[i];
+            break;
+        }
+        cardinality += CountOnes(w);
+    }
+    a.cardinality = cardinality;
+    a.Normalize();
+}
+
+} /* anonymous namespace */
+
+size_t
+CompressedBitmap::_FindKey(u16 key) const
+{
+    return std::lower_bound(_keys.begin(), _keys.end(), key) - _keys.begin();
+}
+
+void
+CompressedBitmap::Set(u32 bitIdx)
+{
+    u16 key = bitIdx >> 16;
+    size_t idx = _FindKey(key);
+    if (idx == _keys.size() || _keys[idx] != key) {
+        _keys.insert(_keys.begin() + idx, key);
+        _containers.emplace(_containers.begin() + idx);
+    }
+    _containers[idx].Add(bitIdx & 0xffff);
+}
+
+void
+CompressedBitmap::Clear(u32 bitIdx)
+{
+    u16 key = bitIdx >> 16;
+    size_t idx = _FindKey(key);
+    if (idx == _keys.size() || _keys[idx] != key) {
+        return;
+    }
+    Container &c = _containers[idx];
+    if (c.Remove(bitIdx & 0xffff) && !c.cardinality) {
+        _keys.erase(_keys.begin() + idx);
+        _containers.erase(_containers.begin() + idx);
+    }
+}
+
+bool
+CompressedBitmap::IsSet(u32 bitIdx) const
+{
+    u16 key = bitIdx >> 16;
+    size_t idx = _FindKey(key);
+    if (idx == _keys.size() || _keys[idx] != key) {
+        return false;
+    }
+    return _containers[idx].Contains(bitIdx & 0xffff);
+}
+
+size_t
+CompressedBitmap::FirstSet(size_t startBit) const
+{
+    if (startBit > MAX_U32) {
+        return -1;
+    }
+    u16 key = startBit >> 16;
+    for (size_t idx = _FindKey(key); idx < _keys.size(); idx++) {
+        int v = _containers[idx].FindFirst(_keys[idx] == key ? startBit & 0xffff : 0);
+        if (v >= 0) {
+            return (static_cast<size_t>(_keys[idx]) << 16) | v;
+        }
+    }
+    return -1;
+}
+
+size_t
+CompressedBitmap::Count() const
+{
+    size_t count = 0;
+    for (const Container &c: _containers) {
+        count += c.cardinality;
+    }
+    return count;
+}
+
+template <class OpFunc>
+void
+CompressedBitmap::_Apply(const CompressedBitmap &other, bool keepThis,
+                         bool keepOther, OpFunc op)
+{
+    std::vector<u16> keys;
+    std::vector<Container> containers;
+    size_t i = 0, j = 0;
+    while (i < _keys.size() || j < other._keys.size()) {
+        if (j == other._keys.size() || (i < _keys.size() && _keys[i] < other._keys[j])) {
+            if (keepThis) {
+                keys.push_back(_keys[i]);
+                containers.push_back(std::move(_containers[i]));
+            }
+            i++;
+        } else if (i == _keys.size() || other._keys[j] < _keys[i]) {
+            if (keepOther) {
+                keys.push_back(other._keys[j]);
+                containers.push_back(other._containers[j]);
+            }
+            j++;
+        } else {
+            op(_containers[i], other._containers[j]);
+            if (_containers[i].cardinality) {
+                keys.push_back(_keys[i]);
+                containers.push_back(std::move(_containers[i]));
+            }
+            i++;
+            j++;
+        }
+    }
+    _keys = std::move(keys);
+    _containers = std::move(containers);
+}
+
+void
+CompressedBitmap::And(const CompressedBitmap &other)
+{
+    _Apply(other, false, false,
+           [](Container &a, const Container &b) { ApplyOp(a, b, Op::AND); });
+}
+
+void
+CompressedBitmap::Or(const CompressedBitmap &other)
+{
+    _Apply(other, true, true,
+           [](Container &a, const Container &b) { ApplyOp(a, b, Op::OR); });
+}
+
+void
+CompressedBitmap::Xor(const CompressedBitmap &other)
+{
+    _Apply(other, true, true,
+           [](Container &a, const Container &b) { ApplyOp(a, b, Op::XOR); });
+}
+
+void
+CompressedBitmap::AndNot(const CompressedBitmap &other)
+{
+    _Apply(other, true, false,
+           [](Container &a, const Container &b) { ApplyOp(a, b, Op::AND_NOT); });
+}
+
+bool
+CompressedBitmap::Intersects(const CompressedBitmap &other) const
+{
+    size_t i = 0, j = 0;
+    while (i < _keys.size() && j < other._keys.size()) {
+        if (_keys[i] < other._keys[j]) {
+            i++;
+        } else if (other._keys[j] < _keys[i]) {
+            j++;
+        } else {
+            const Container &a = _containers[i], &b = other._containers[j];
+            if (a.type == Container::Type::ARRAY) {
+                for (u16 v: a.values) {
+                    if (b.Contains(v)) {
+                        return true;
+                    }
+                }
+            } else {
+                std::vector<u64> bufA, bufB;
+                const u64 *ba = a.GetBits(bufA), *bb = b.GetBits(bufB);
+                for (size_t k = 0; k < Container::BITSET_WORDS; k++) {
+                    if (ba[k] & bb[k]) {
+                        return true;
+                    }
+                }
+            }
+            i++;
+            j++;
+        }
+    }
+    return false;
+}
+
+void
+CompressedBitmap::RunOptimize()
+{
+    for (Container &c: _containers) {
+        c.RunOptimize();
+    }
+}
+
+size_t
+CompressedBitmap::GetMemoryUsage() const
+{
+    size_t size = sizeof(*this) + _keys.capacity() * sizeof(u16) +
+        _containers.capacity() * sizeof(Container);
+    for (const Container &c: _containers) {
+        size += c.values.capacity() * sizeof(u16) + c.bits.capacity() * sizeof(u64);
+    }
+    return size;
+}
+
+size_t
+CompressedBitmap::GetSerializedSize() const
+{
+    size_t size = RoundUp2(sizeof(SerializedHeader) +
+                           _keys.size() * sizeof(SerializedDesc), SERIALIZED_ALIGN);
+    for (const Container &c: _containers) {
+        size += RoundUp2(c.GetPayloadSize(), SERIALIZED_ALIGN);
+    }
+    return size;
+}
+
+void
+CompressedBitmap::Serialize(void *buf) const
+{
+    u8 *data = static_cast<u8 *>(buf);
+    SerializedHeader *hdr = reinterpret_cast<SerializedHeader *>(data);
+    hdr->magic = Le(SERIALIZED_MAGIC);
+    hdr->numContainers = Le(static_cast<u32>(_keys.size()));
+    SerializedDesc *descs = reinterpret_cast<SerializedDesc *>(data + sizeof(*hdr));
+    size_t offset = RoundUp2(sizeof(SerializedHeader) +
+                             _keys.size() * sizeof(SerializedDesc), SERIALIZED_ALIGN);
+    memset(data + sizeof(*hdr) + _keys.size() * sizeof(SerializedDesc), 0,
+           offset - sizeof(*hdr) - _keys.size() * sizeof(SerializedDesc));
+
+    for (size_t i = 0; i < _keys.size(); i++) {
+        const Container &c = _containers[i];
+        SerializedDesc &desc = descs[i];
+        desc.key = Le(_keys[i]);
+        desc.type = static_cast<u8>(c.type);
+        desc.reserved = 0;
+        desc.cardinality = Le(c.cardinality);
+        desc.offset = Le(static_cast<u32>(offset));
+
+        u8 *payload = data + offset;
+        size_t payloadSize = c.GetPayloadSize();
+        if (c.type == Container::Type::BITSET) {
+            desc.numElements = Le(static_cast<u32>(Container::BITSET_WORDS));
+            for (size_t k = 0; k < Container::BITSET_WORDS; k++) {
+                u64 w = Le(c.bits[k]);
+                memcpy(payload + k * sizeof(u64), &w, sizeof(w));
+            }
+        } else {
+            desc.numElements = Le(static_cast<u32>(c.type == Container::Type::RUN ?
+                                                   c.values.size() / 2 : c.values.size()));
+            for (size_t k = 0; k < c.values.size(); k++) {
+                u16 v = Le(c.values[k]);
+                memcpy(payload + k * sizeof(u16), &v, sizeof(v));
+            }
+        }
+        size_t alignedSize = RoundUp2(payloadSize, SERIALIZED_ALIGN);
+        memset(payload + payloadSize, 0, alignedSize - payloadSize);
+        offset += alignedSize;
+    }
+}
+
+std::vector<u8>
+CompressedBitmap::Serialize() const
+{
+    std::vector<u8> buf(GetSerializedSize());
+    Serialize(buf.data());
+    return buf;
+}
+
+namespace {
+
+/** Validated view of serialized container. */
+struct SerializedContainer {
+    u16 key;
+    u8 type;
+    u32 cardinality, numElements;
+    const u8 *payload;
+};
+
+/** Get number of containers in serialized data and validate the header. */
+u32
+GetSerializedNumContainers(const void *data, size_t size)
+{
+    if (size < sizeof(SerializedHeader)) {
+        ADK_EXCEPTION(CompressedBitmap::FormatException, "Truncated header");
+    }
+    const SerializedHeader *hdr = static_cast<const SerializedHeader *>(data);
+    if (Le(hdr->magic) != SERIALIZED_MAGIC) {
+        ADK_EXCEPTION(CompressedBitmap::FormatException, "Bad signature");
+    }
+    u32 numContainers = Le(hdr->numContainers);
+    if (numContainers > 65536 ||
+        sizeof(SerializedHeader) + numContainers * sizeof(SerializedDesc) > size) {
+
+        ADK_EXCEPTION(CompressedBitmap::FormatException, "Truncated descriptors");
+    }
+    return numContainers;
+}
+
+/** Get serialized container with the specified index and validate it. */
+SerializedContainer
+GetSerializedContainer(const void *data, size_t size, u32 idx)
+{
+    const SerializedDesc *desc = reinterpret_cast<const SerializedDesc *>(
+        static_cast<const u8 *>(data) + sizeof(SerializedHeader)) + idx;
+    SerializedContainer c;
+    c.key = Le(desc->key);
+    c.type = desc->type;
+    c.cardinality = Le(desc->cardinality);
+    c.numElements = Le(desc->numElements);
+    u32 offset = Le(desc->offset);
+    size_t payloadSize;
+    switch (c.type) {
+    case 0:
+        payloadSize = c.numElements * sizeof(u16);
+        if (c.numElements != c.cardinality || c.cardinality > 4096) {
+            ADK_EXCEPTION(CompressedBitmap::FormatException,
+                          "Invalid array container size");
+        }
+        break;
+    case 1:
+        payloadSize = c.numElements * sizeof(u64);
+        if (c.numElements != 65536 / 64 || c.cardinality > 65536) {
+            ADK_EXCEPTION(CompressedBitmap::FormatException,
+                          "Invalid bitset container size");
+        }
+        break;
+    case 2:
+        payloadSize = c.numElements * 2 * sizeof(u16);
+        if (c.numElements > 32768 || c.cardinality > 65536) {
+            ADK_EXCEPTION(CompressedBitmap::FormatException,
+                          "Invalid run container size");
+        }
+        break;
+    default:
+        ADK_EXCEPTION(CompressedBitmap::FormatException,
+                      "Invalid container type: " << static_cast<int>(c.type));
+    }
+    if (offset > size || payloadSize > size - offset) {
+        ADK_EXCEPTION(CompressedBitmap::FormatException, "Truncated payload");
+    }
+    c.payload = static_cast<const u8 *>(data) + offset;
+    return c;
+}
+
+u16
+GetSerializedU16(const u8 *p, size_t idx)
+{
+    return Le(GetUnaligned<u16>(p + idx * sizeof(u16)));
+}
+
+} /* anonymous namespace */
+
+CompressedBitmap
+CompressedBitmap::Deserialize(const void *data, size_t size)
+{
+    CompressedBitmap bm;
+    u32 numContainers = GetSerializedNumContainers(data, size);
+    bm._keys.reserve(numContainers);
+    bm._containers.reserve(numContainers);
+    for (u32 i = 0; i < numContainers; i++) {
+        SerializedContainer sc = GetSerializedContainer(data, size, i);
+        if (i && sc.key <= bm._keys.back()) {
+            ADK_EXCEPTION(FormatException, "Containers are not sorted");
+        }
+        if (!sc.cardinality) {
+            ADK_EXCEPTION(FormatException, "Empty container");
+        }
+        Container c;
+        c.type = static_cast<Container::Type>(sc.type);
+        c.cardinality = sc.cardinality;
+        /* Payload content is validated as well since containers operations
+         * rely on it being consistent.
+         */
+        u32 cardinality = 0;
+        if (c.type == Container::Type::BITSET) {
+            c.bits.resize(Container::BITSET_WORDS);
+            for (size_t k = 0; k < Container::BITSET_WORDS; k++) {
+                c.bits[k] = Le(GetUnaligned<u64>(sc.payload + k * sizeof(u64)));
+                cardinality += CountOnes(c.bits[k]);
+            }
+        } else if (c.type == Container::Type::ARRAY) {
+            c.values.resize(sc.numElements);
+            for (size_t k = 0; k < sc.numElements; k++) {
+                c.values[k] = GetSerializedU16(sc.payload, k);
+                if (k && c.values[k] <= c.values[k - 1]) {
+                    ADK_EXCEPTION(FormatException, "Array container values are not sorted");
+                }
+            }
+            cardinality = sc.numElements;
+        } else {
+            c.values.resize(sc.numElements * 2);
+            for (size_t k = 0; k < sc.numElements; k++) {
+                u16 start = GetSerializedU16(sc.payload, k * 2);
+                u16 lenMinusOne = GetSerializedU16(sc.payload, k * 2 + 1);
+                if (start + lenMinusOne > 0xffff) {
+                    ADK_EXCEPTION(FormatException, "Run exceeds container range");
+                }
+                /* Runs should be sorted and non-overlapping. */
+                if (k && start <= static_cast<u32>(c.values[k * 2 - 2]) + c.values[k * 2 - 1]) {
+                    ADK_EXCEPTION(FormatException, "Run container runs are not sorted");
+                }
+                c.values[k * 2] = start;
+                c.values[k * 2 + 1] = lenMinusOne;
+                cardinality += lenMinusOne + 1;
+            }
+        }
+        if (cardinality != sc.cardinality) {
+            ADK_EXCEPTION(FormatException, "Container cardinality mismatch");
+        }
+        bm._keys.push_back(sc.key);
+        bm._containers.push_back(std::move(c));
+    }
+    return bm;
+}
+
+bool
+CompressedBitmap::IsSetSerialized(const void *data, size_t size, u32 bitIdx)
+{
+    u32 numContainers = GetSerializedNumContainers(data, size);
+    u16 key = bitIdx >> 16, value = bitIdx & 0xffff;
+    const SerializedDesc *descs = reinterpret_cast<const SerializedDesc *>(
+        static_cast<const u8 *>(data) + sizeof(SerializedHeader));
+    /* Find container by key. */
+    u32 lo = 0, hi = numContainers;
+    while (lo < hi) {
+        u32 mid = (lo + hi) / 2;
+        if (Le(descs[mid].key) < key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo == numContainers || Le(descs[lo].key) != key) {
+        return false;
+    }
+    SerializedContainer c = GetSerializedContainer(data, size, lo);
+    switch (c.type) {
+    case 0:
+        lo = 0;
+        hi = c.numElements;
+        while (lo < hi) {
+            u32 mid = (lo + hi) / 2;
+            u16 v = GetSerializedU16(c.payload, mid);
+            if (v == value) {
+                return true;
+            }
+            if (v < value) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return false;
+    case 1:
+        return Le(GetUnaligned<u64>(c.payload + value / 64 * sizeof(u64))) &
+            (static_cast<u64>(1) << (value % 64));
+    default:
+        /* Find the last run starting not after the value. */
+        lo = 0;
+        hi = c.numElements;
+        while (lo < hi) {
+            u32 mid = (lo + hi) / 2;
+            if (GetSerializedU16(c.payload, mid * 2) <= value) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        if (!lo) {
+            return false;
+        }
+        lo--;
+        return value - GetSerializedU16(c.payload, lo * 2) <=
+            GetSerializedU16(c.payload, lo * 2 + 1);
+    }
+}
@@ -0,0 +1,260 @@
+/* This file is a part of ADK library.
+ * Copyright (c) 2012-2015, Artyom Lebedev <artyom.lebedev@gmail.com>
+ * All rights reserved.
+ * See LICENSE file for copyright details.
+ */
+
+/** @file crc32c.cpp
+ * CRC32C checksum implementation.
+ */
+
+#include <adk.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+/** Hardware implementation with SSE4.2 instructions is compiled. */
+#define ADK_CRC32C_HW
+#include <nmmintrin.h>
+#endif
+
+using namespace adk;
+
+namespace {
+
+/** Reflected CRC-32C polynomial. */
+const u32 POLY = 0x82f63b78;
+
+/** Block sizes for three-way interleaved hardware calculation. */
+const size_t LONG_BLOCK = 8192, SHORT_BLOCK = 256;
+
+/** Multiply two polynomials modulo CRC polynomial (reflected bits order). */
+u32
+MultModP(u32 a, u32 b)
+{
+    u32 m = static_cast<u32>(1) << 31, p = 0;
+    while (true) {
+        if (a & m) {
+            p ^= b;
+            if (!(a & (m - 1))) {
+                break;
+            }
+        }
+        m >>= 1;
+        b = b & 1 ? (b >> 1) ^ POLY : b >> 1;
+    }
+    return p;
+}
+
+/** Get x^(8 * numBytes) modulo CRC polynomial. Multiplication by this value
+ * is equivalent to feeding the specified number of zero bytes to the CRC
+ * register.
+ */
+u32
+ZerosOperator(size_t numBytes)
+{
+    /* x^(2^k) values, enough for any size_t value of bytes number. */
+    static const struct PowersTable {
+        u32 powers[sizeof(size_t) * NBBY + 3];
+
+        PowersTable()
+        {
+            /* x^1 */
+            u32 p = static_cast<u32>(1) << 30;
+            for (u32 &power: powers) {
+                power = p;
+                p = MultModP(p, p);
+            }
+        }
+    } table;
+
+    /* x^0 */
+    u32 p = static_cast<u32>(1) << 31;
+    /* Start from x^8 since the size is in bytes. */
+    for (size_t k = 3; numBytes; numBytes >>= 1, k++) {
+        if (numBytes & 1) {
+            p = MultModP(table.powers[k], p);
+        }
+    }
+    return p;
+}
+
+/** Lookup tables. */
+class Tables {
+public:
+    /** Slicing-by-8 tables. */
+    u32 slice[8][256];
+    /** Tables for feeding long and short block of zeros to CRC register. */
+    u32 longShift[4][256], shortShift[4][256];
+
+    static const Tables &
+    Get()
+    {
+        static const Tables tables;
+        return tables;
+    }
+
+private:
+    Tables()
+    {
+        for (u32 n = 0; n < 256; n++) {
+            u32 crc = n;
+            for (int k = 0; k < 8; k++) {
+                crc = crc & 1 ? (crc >> 1) ^ POLY : crc >> 1;
+            }
+            slice[0][n] = crc;
+        }
+        for (u32 n = 0; n < 256; n++) {
+            u32 crc = slice[0][n];
+            for (int k = 1; k < 8; k++) {
+                crc = slice[0][crc & 0xff] ^ (crc >> 8);
+                slice[k][n] = crc;
+            }
+        }
+        InitShift(longShift, LONG_BLOCK);
+        InitShift(shortShift, SHORT_BLOCK);
+    }
+
+    /** Initialize table for multiplication by zeros operator. */
+    static void
+    InitShift(u32 table[4][256], size_t numBytes)
+    {
+        u32 op = ZerosOperator(numBytes);
+        for (u32 n = 0; n < 256; n++) {
+            for (int k = 0; k < 4; k++) {
+                table[k][n] = MultModP(op, n << (k * 8));
+            }
+        }
+    }
+};
+
+/** Feed zeros to CRC register using precalculated shift table. */
+inline u32
+Shift(const u32 table[4][256], u32 crc)
+{
+    return table[0][crc & 0xff] ^ table[1][(crc >> 8) & 0xff] ^
+        table[2][(crc >> 16) & 0xff] ^ table[3][crc >> 24];
+}
+
+/** Table implementation operating on CRC register value. */
+u32
+UpdateSoftware(u32 crc, const u8 *p, size_t size)
+{
+    const Tables &t = Tables::Get();
+    while (size && (reinterpret_cast<uintptr_t>(p) & 7)) {
+        crc = t.slice[0][(crc ^ *p++) & 0xff] ^ (crc >> 8);
+        size--;
+    }
+    for (; size >= 8; size -= 8, p += 8) {
+        u32 lo = Le(GetUnaligned<u32>(p)) ^ crc, hi = Le(GetUnaligned<u32>(p + 4));
+        crc = t.slice[7][lo & 0xff] ^ t.slice[6][(lo >> 8) & 0xff] ^
+            t.slice[5][(lo >> 16) & 0xff] ^ t.slice[4][lo >> 24] ^
+            t.slice[3][hi & 0xff] ^ t.slice[2][(hi >> 8) & 0xff] ^
+            t.slice[1][(hi >> 16) & 0xff] ^ t.slice[0][hi >> 24];
+    }
+    while (size--) {
+        crc = t.slice[0][(crc ^ *p++) & 0xff] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+#ifdef ADK_CRC32C_HW
+
+/** Calculate CRC of three adjacent blocks in parallel and merge them.
+ * @a crc32 instruction has latency of three cycles but can be issued every
+ * cycle, so independent streams hide the latency.
+ */
+__attribute__((target("sse4.2"))) inline u64
+UpdateInterleaved(u64 crc0, const u8 *&p, size_t blockSize, const u32 shift[4][256])
+{
+    u64 crc1 = 0, crc2 = 0;
+    const u8 *end = p + blockSize;
+    do {
+        crc0 = _mm_crc32_u64(crc0, *reinterpret_cast<const u64 *>(p));
+        crc1 = _mm_crc32_u64(crc1, *reinterpret_cast<const u64 *>(p + blockSize));
+        crc2 = _mm_crc32_u64(crc2, *reinterpret_cast<const u64 *>(p + 2 * blockSize));
+        p += 8;
+    } while (p < end);
+    /* CRC is linear so the result is crc0 shifted by two blocks, crc1
+     * shifted by one block and crc2.
+     */
+    p += 2 * blockSize;
+    return Shift(shift, Shift(shift, crc0) ^ crc1) ^ crc2;
+}
+
+/** Hardware implementation operating on CRC register value. */
+__attribute__((target("sse4.2"))) u32
+UpdateHardware(u32 crc, const u8 *p, size_t size)
+{
+    while (size && (reinterpret_cast<uintptr_t>(p) & 7)) {
+        crc = _mm_crc32_u8(crc, *p++);
+        size--;
+    }
+    u64 crc0 = crc;
+    const Tables &t = Tables::Get();
+    for (; size >= 3 * LONG_BLOCK; size -= 3 * LONG_BLOCK) {
+        crc0 = UpdateInterleaved(crc0, p, LONG_BLOCK, t.longShift);
+    }
+    for (; size >= 3 * SHORT_BLOCK; size -= 3 * SHORT_BLOCK) {
+        crc0 = UpdateInterleaved(crc0, p, SHORT_BLOCK, t.shortShift);
+    }
+    for (; size >= 8; size -= 8, p += 8) {
+        crc0 = _mm_crc32_u64(crc0, *reinterpret_cast<const u64 *>(p));
+    }
+    crc = crc0;
+    while (size--) {
+        crc = _mm_crc32_u8(crc, *p++);
+    }
+    return crc;
+}
+
+#endif /* ADK_CRC32C_HW */
+
+typedef u32 (*UpdateFunc)(u32 crc, const u8 *p, size_t size);
+
+/** Select implementation once based on CPU features. */
+UpdateFunc
+GetUpdateFunc()
+{
+    static const UpdateFunc func = [] () -> UpdateFunc {
+#ifdef ADK_CRC32C_HW
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("sse4.2")) {
+            return UpdateHardware;
+        }
+#endif
+        return UpdateSoftware;
+    }();
+    return func;
+}
+
+} /* anonymous namespace */
+
+void
+Crc32c::Feed(const void *data, size_t size)
+{
+    _state = GetUpdateFunc()(_state, static_cast<const u8 *>(data), size);
+    _length += size;
+}
+
+u32
+Crc32c::Compute(const void *data, size_t size, u32 crc)
+{
+    return ~GetUpdateFunc()(~crc, static_cast<const u8 *>(data), size);
+}
+
+u32
+Crc32c::ComputeSoftware(const void *data, size_t size, u32 crc)
+{
+    return ~UpdateSoftware(~crc, static_cast<const u8 *>(data), size);
+}
+
+u32
+Crc32c::Combine(u32 crc1, u32 crc2, size_t size2)
+{
+    return MultModP(ZerosOperator(size2), crc1) ^ crc2;
+}
+
+bool
+Crc32c::IsHardwareAccelerated()
+{
+    return GetUpdateFunc() != UpdateSoftware;
+}
@@ -13,34 +13,87 @@
 using namespace adk;
 
 void
-Hash::Mix(u32 &a, u32 &b, u32 &c)
+Hash::_Finalize(u32 &a, u32 &b, u32 &c)
 {
-    a -= c; a ^= RotL(c, 4);    c += b;
-    b -= a; b ^= RotL(a, 6);    a += c;
-    c -= b; c ^= RotL(b, 8);    b += a;
-    a -= c; a ^= RotL(c, 16);   c += b;
-    b -= a; b ^= RotL(a, 19);   a += c;
-    c -= b; c ^= RotL(b, 4);    b += a;
+    a = _a + _length;
+    b = _b + _length;
+    c = _c + _length;
+    Final(a, b, c);
 }
 
-void
-Hash::Final(u32 &a, u32 &b, u32 &c)
+namespace {
+
+/** Apply full 96 bits blocks to the accumulators.
+ *
+ * @return Pointer to the data following the applied blocks.
+ */
+inline const u8 *
+ApplyBlocks(u32 &a, u32 &b, u32 &c, const u8 *key, size_t numBlocks)
+{
+    if (!(reinterpret_cast<uintptr_t>(key) & (sizeof(u32) - 1))) {
+        /* Aligned input, words can be loaded directly. */
+        const u32 *words = reinterpret_cast<const u32 *>(key);
+        for (; numBlocks; numBlocks--) {
+            a += words[0];
+            b += words[1];
+            c += words[2];
+            Hash::Mix(a, b, c);
+            words += 3;
+        }
+        return reinterpret_cast<const u8 *>(words);
+    }
+    for (; numBlocks; numBlocks--) {
+        a += GetUnaligned<u32>(&key[0]);
+        b += GetUnaligned<u32>(&key[4]);
+        c += GetUnaligned<u32>(&key[8]);
+        Hash::Mix(a, b, c);
+        key += 12;
+    }
+    return key;
+}
+
+/** Apply trailing remainder of less than 12 bytes to the accumulators. */
+inline void
+ApplyTail(u32 &a, u32 &b, u32 &c, const u8 *key, size_t size)
 {
-    c ^= b; c -= RotL(b, 14);
-    a ^= c; a -= RotL(c, 11);
-    b ^= a; b -= RotL(a, 25);
-    c ^= b; c -= RotL(b, 16);
-    a ^= c; a -= RotL(c, 4);
-    b ^= a; b -= RotL(a, 14);
-    c ^= b; c -= RotL(b, 24);
+    switch (size) {
+    case 11:
+        c += static_cast<u32>(key[10]) << 16;
+    case 10:
+        c += static_cast<u32>(key[9]) << 8;
+    case 9:
+        c += static_cast<u32>(key[8]);
+    case 8:
+        b += static_cast<u32>(key[7]) << 24;
+    case 7:
+        b += static_cast<u32>(key[6]) << 16;
+    case 6:
+        b += static_cast<u32>(key[5]) << 8;
+    case 5:
+        b += static_cast<u32>(key[4]);
+    case 4:
+        a += static_cast<u32>(key[3]) << 24;
+    case 3:
+        a += static_cast<u32>(key[2]) << 16;
+    case 2:
+        a += static_cast<u32>(key[1]) << 8;
+    case 1:
+        a += static_cast<u32>(key[0]);
+    }
 }
 
+} /* anonymous namespace */
+
 void
-Hash::_Finalize(u32 &a, u32 &b, u32 &c)
+Hash::_Compute(const void *data, size_t size, u32 initial, u32 &a, u32 &b, u32 &c)
 {
-    a = _a + _length;
-    b = _b + _length;
-    c = _c + _length;
+    const u8 *key = static_cast<const u8 *>(data);
+    a = b = c = INITIAL_VALUE + initial;
+    key = ApplyBlocks(a, b, c, key, size / 12);
+    ApplyTail(a, b, c, key, size % 12);
+    a += size;
+    b += size;
+    c += size;
     Final(a, b, c);
 }
 
@@ -50,42 +103,9 @@ Hash::Feed(const void *data, size_t size)
     const u8 *key = static_cast<const u8 *>(data);
 
     /* Fill remainder. */
-    while (_resid) {
-        switch (_resid) {
-        case 1:
-            _a += static_cast<u32>(*key) << 8;
-            break;
-        case 2:
-            _a += static_cast<u32>(*key) << 16;
-            break;
-        case 3:
-            _a += static_cast<u32>(*key) << 24;
-            break;
-        case 4:
-            _b += static_cast<u32>(*key);
-            break;
-        case 5:
-            _b += static_cast<u32>(*key) << 8;
-            break;
-        case 6:
-            _b += static_cast<u32>(*key) << 16;
-            break;
-        case 7:
-            _b += static_cast<u32>(*key) << 24;
-            break;
-        case 8:
-            _c += static_cast<u32>(*key);
-            break;
-        case 9:
-            _c += static_cast<u32>(*key) << 8;
-            break;
-        case 10:
-            _c += static_cast<u32>(*key) << 16;
-            break;
-        case 11:
-            _c += static_cast<u32>(*key) << 24;
-            break;
-        }
+    while (_resid && size) {
+        u32 &acc = _resid < 4 ? _a : (_resid < 8 ? _b : _c);
+        acc += static_cast<u32>(*key) << ((_resid % 4) * NBBY);
         key++;
         _length++;
         _resid++;
@@ -94,47 +114,321 @@ Hash::Feed(const void *data, size_t size)
             Mix(_a, _b, _c);
             _resid = 0;
         }
-        if (!size) {
+    }
+    if (!size) {
+        return;
+    }
+
+    /* Apply main part. */
+    size_t numBlocks = size / 12;
+    key = ApplyBlocks(_a, _b, _c, key, numBlocks);
+    _length += numBlocks * 12;
+    size %= 12;
+
+    /* Apply trailing remainder. */
+    ApplyTail(_a, _b, _c, key, size);
+    _resid = size;
+    _length += size;
+}
+
+/* ****************************************************************************/
+/* MumHash and Hash128 classes. */
+
+namespace {
+
+const u64 MUM_K0 = 0xa0761d6478bd642fULL,
+          MUM_K1 = 0xe7037ed1a0b428dbULL,
+          MUM_K2 = 0x8ebc6af09c88c6e3ULL;
+
+/** Multiply two 64-bits values and fold the 128-bits product. */
+inline u64
+Mum(u64 a, u64 b)
+{
+#ifdef __SIZEOF_INT128__
+    unsigned __int128 r = static_cast<unsigned __int128>(a) * b;
+    return static_cast<u64>(r) ^ static_cast<u64>(r >> 64);
+#else
+    u64 aLo = a & 0xffffffff, aHi = a >> 32, bLo = b & 0xffffffff, bHi = b >> 32;
+    u64 lo = aLo * bLo, mid1 = aHi * bLo, mid2 = aLo * bHi, hi = aHi * bHi;
+    u64 carry = ((lo >> 32) + (mid1 & 0xffffffff) + (mid2 & 0xffffffff)) >> 32;
+    hi += (mid1 >> 32) + (mid2 >> 32) + carry;
+    lo += (mid1 << 32) + (mid2 << 32);
+    return lo ^ hi;
+#endif
+}
+
+inline u64
+Read64(const u8 *p)
+{
+    return Le(GetUnaligned<u64>(p));
+}
+
+inline u64
+Read32(const u8 *p)
+{
+    return Le(GetUnaligned<u32>(p));
+}
+
+inline void
+MumBlock(u64 &s0, u64 &s1, const u8 *p)
+{
+    s0 = Mum(Read64(p) ^ MUM_K1, Read64(p + 8) ^ s0);
+    s1 = Mum(Read64(p + 16) ^ MUM_K2, Read64(p + 24) ^ s1);
+}
+
+/** Calculate final value from lanes state and trailing data of less than one
+ * block.
+ */
+u64
+MumFinal(u64 s0, u64 s1, const u8 *p, size_t size, size_t length)
+{
+    u64 a = Mum(s0 ^ MUM_K2, s1 ^ MUM_K0);
+    if (size > 16) {
+        a = Mum(Read64(p) ^ MUM_K1, Read64(p + 8) ^ a);
+        p += 16;
+        size -= 16;
+    }
+    /* Remaining up to 16 bytes are read with possibly overlapping loads. */
+    u64 x, y;
+    if (size >= 8) {
+        x = Read64(p);
+        y = Read64(p + size - 8);
+    } else if (size >= 4) {
+        x = Read32(p);
+        y = Read32(p + size - 4);
+    } else if (size) {
+        x = (static_cast<u64>(p[0]) << 16) | (static_cast<u64>(p[size / 2]) << 8) |
+            p[size - 1];
+        y = 0;
+    } else {
+        x = y = 0;
+    }
+    return Mum(MUM_K1 ^ length, Mum(x ^ MUM_K1, y ^ a));
+}
+
+} /* anonymous namespace */
+
+void
+MumHash::Reset(u64 seed)
+{
+    _s0 = seed ^ MUM_K0;
+    _s1 = seed ^ MUM_K1;
+    _bufSize = 0;
+    _length = 0;
+}
+
+void
+MumHash::Feed(const void *data, size_t size)
+{
+    const u8 *p = static_cast<const u8 *>(data);
+    _length += size;
+    if (_bufSize) {
+        size_t n = Min<size_t>(BLOCK_SIZE - _bufSize, size);
+        memcpy(&_buf[_bufSize], p, n);
+        _bufSize += n;
+        p += n;
+        size -= n;
+        if (_bufSize < BLOCK_SIZE) {
             return;
         }
+        MumBlock(_s0, _s1, _buf);
+        _bufSize = 0;
+    }
+    for (; size >= BLOCK_SIZE; size -= BLOCK_SIZE, p += BLOCK_SIZE) {
+        MumBlock(_s0, _s1, p);
     }
+    memcpy(_buf, p, size);
+    _bufSize = size;
+}
 
-    /* Apply main part. */
-    while (size >= 12) {
-        _a += GetUnaligned<u32>(&key[0]);
-        _b += GetUnaligned<u32>(&key[4]);
-        _c += GetUnaligned<u32>(&key[8]);
-        Mix(_a, _b, _c);
-        key += 12;
-        _length += 12;
-        size -= 12;
+u64
+MumHash::Get64() const
+{
+    return MumFinal(_s0, _s1, _buf, _bufSize, _length);
+}
+
+u64
+MumHash::Compute64(const void *data, size_t size, u64 seed)
+{
+    const u8 *p = static_cast<const u8 *>(data);
+    u64 s0 = seed ^ MUM_K0, s1 = seed ^ MUM_K1;
+    size_t numBlocks = size / BLOCK_SIZE;
+    for (size_t i = 0; i < numBlocks; i++, p += BLOCK_SIZE) {
+        MumBlock(s0, s1, p);
     }
+    return MumFinal(s0, s1, p, size % BLOCK_SIZE, size);
+}
 
-    /* Apply trailing remainder. */
-    switch (size) {
-    case 11:
-        _c += static_cast<u32>(key[10]) << 16;
-    case 10:
-        _c += static_cast<u32>(key[9]) << 8;
-    case 9:
-        _c += static_cast<u32>(key[8]);
-    case 8:
-        _b += static_cast<u32>(key[7]) << 24;
-    case 7:
-        _b += static_cast<u32>(key[6]) << 16;
-    case 6:
-        _b += static_cast<u32>(key[5]) << 8;
-    case 5:
-        _b += static_cast<u32>(key[4]);
-    case 4:
-        _a += static_cast<u32>(key[3]) << 24;
-    case 3:
-        _a += static_cast<u32>(key[2]) << 16;
-    case 2:
-        _a += static_cast<u32>(key[1]) << 8;
-    case 1:
-        _a += static_cast<u32>(key[0]);
+namespace {
+
+/** Initial accumulators values. */
+const u64 HASH128_INIT[] = {
+    0x00000000165667b1ULL, 0x9e3779b185ebca87ULL,
+    0xc2b2ae3d27d4eb4fULL, 0x165667b19e3779f9ULL,
+    0x85ebca77c2b2ae63ULL, 0x0000000085ebca77ULL,
+    0x27d4eb2f165667c5ULL, 0x000000009e3779b1ULL
+};
+
+/** Base keys which are combined with seed. */
+const u64 HASH128_KEYS[] = {
+    0xbe4ba423396cfeb8ULL, 0x1cad21f72c81017cULL,
+    0xdb979083e96dd4deULL, 0x1f67b3b7a4a44072ULL,
+    0x78e5c0cc4ee679cbULL, 0x2172ffcc7dd05a82ULL,
+    0x8e2443f7744608b8ULL, 0x4c263a81e69035e0ULL
+};
+
+inline u64
+Avalanche(u64 h)
+{
+    h ^= h >> 37;
+    h *= 0x165667919e3779f9ULL;
+    h ^= h >> 32;
+    return h;
+}
+
+/** Accumulate one 64 bytes stripe: acc[i] += in[i ^ 1] + lo(d) * hi(d), where
+ * d = in[i] ^ secret[i].
+ */
+inline void
+AccumulateStripe(u64 *acc, const u8 *in, const u64 *secret)
+{
+#if defined(__AVX2__)
+    for (int i = 0; i < 2; i++) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(acc) + i);
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in) + i);
+        __m256i k = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(secret) + i);
+        __m256i dk = _mm256_xor_si256(d, k);
+        __m256i prod = _mm256_mul_epu32(dk, _mm256_shuffle_epi32(dk, _MM_SHUFFLE(0, 3, 0, 1)));
+        __m256i swapped = _mm256_shuffle_epi32(d, _MM_SHUFFLE(1, 0, 3, 2));
+        a = _mm256_add_epi64(a, _mm256_add_epi64(swapped, prod));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(acc) + i, a);
     }
-    _resid = size;
+#elif defined(__SSE2__)
+    for (int i = 0; i < 4; i++) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(acc) + i);
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in) + i);
+        __m128i k = _mm_loadu_si128(reinterpret_cast<const __m128i *>(secret) + i);
+        __m128i dk = _mm_xor_si128(d, k);
+        __m128i prod = _mm_mul_epu32(dk, _mm_shuffle_epi32(dk, _MM_SHUFFLE(0, 3, 0, 1)));
+        __m128i swapped = _mm_shuffle_epi32(d, _MM_SHUFFLE(1, 0, 3, 2));
+        a = _mm_add_epi64(a, _mm_add_epi64(swapped, prod));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(acc) + i, a);
+    }
+#else
+    for (int i = 0; i < 8; i++) {
+        u64 d = Read64(in + i * 8);
+        u64 dk = d ^ secret[i];
+        acc[i ^ 1] += d;
+        acc[i] += (dk & 0xffffffff) * (dk >> 32);
+    }
+#endif
+}
+
+inline void
+ScrambleAcc(u64 *acc, const u64 *secret)
+{
+    for (int i = 0; i < 8; i++) {
+        u64 a = acc[i];
+        a ^= a >> 47;
+        a ^= secret[i];
+        acc[i] = a * 0x9e3779b1;
+    }
+}
+
+} /* anonymous namespace */
+
+void
+Hash128::Reset(u64 seed)
+{
+    for (size_t i = 0; i < NUM_ACC; i++) {
+        _acc[i] = HASH128_INIT[i];
+        _secret[i] = i & 1 ? HASH128_KEYS[i] - seed : HASH128_KEYS[i] + seed;
+    }
+    _bufSize = 0;
+    _numStripes = 0;
+    _length = 0;
+}
+
+void
+Hash128::_Stripe(const u8 *data)
+{
+    AccumulateStripe(_acc, data, _secret);
+    if (++_numStripes == STRIPES_PER_BLOCK) {
+        ScrambleAcc(_acc, _secret);
+        _numStripes = 0;
+    }
+}
+
+void
+Hash128::Feed(const void *data, size_t size)
+{
+    const u8 *p = static_cast<const u8 *>(data);
     _length += size;
+    if (_bufSize) {
+        size_t n = Min<size_t>(STRIPE_SIZE - _bufSize, size);
+        memcpy(&_buf[_bufSize], p, n);
+        _bufSize += n;
+        p += n;
+        size -= n;
+        if (_bufSize < STRIPE_SIZE) {
+            return;
+        }
+        _Stripe(_buf);
+        _bufSize = 0;
+    }
+    for (; size >= STRIPE_SIZE; size -= STRIPE_SIZE, p += STRIPE_SIZE) {
+        _Stripe(p);
+    }
+    memcpy(_buf, p, size);
+    _bufSize = size;
+}
+
+Hash128::Value
+Hash128::_Finalize(const u64 *accState, const u64 *secret, const u8 *tail,
+                   size_t tailSize, size_t length)
+{
+    u64 acc[NUM_ACC];
+    memcpy(acc, accState, sizeof(acc));
+    if (tailSize) {
+        /* Zero padded last stripe, the padding is disambiguated by length. */
+        u8 stripe[STRIPE_SIZE];
+        memcpy(stripe, tail, tailSize);
+        memset(stripe + tailSize, 0, STRIPE_SIZE - tailSize);
+        AccumulateStripe(acc, stripe, secret);
+    }
+    Value v;
+    v.low = length * 0x9e3779b185ebca87ULL;
+    v.high = ~(length * 0xc2b2ae3d27d4eb4fULL);
+    for (size_t i = 0; i < NUM_ACC; i += 2) {
+        v.low += Mum(acc[i] ^ secret[(i + 1) % NUM_ACC], acc[i + 1] ^ secret[(i + 2) % NUM_ACC]);
+        v.high += Mum(acc[i] ^ secret[(i + 3) % NUM_ACC], acc[i + 1] ^ secret[(i + 4) % NUM_ACC]);
+    }
+    v.low = Avalanche(v.low);
+    v.high = Avalanche(v.high);
+    return v;
+}
+
+Hash128::Value
+Hash128::Get128() const
+{
+    return _Finalize(_acc, _secret, _buf, _bufSize, _length);
+}
+
+Hash128::Value
+Hash128::Compute128(const void *data, size_t size, u64 seed)
+{
+    const u8 *p = static_cast<const u8 *>(data);
+    u64 acc[NUM_ACC], secret[NUM_ACC];
+    for (size_t i = 0; i < NUM_ACC; i++) {
+        acc[i] = HASH128_INIT[i];
+        secret[i] = i & 1 ? HASH128_KEYS[i] - seed : HASH128_KEYS[i] + seed;
+    }
+    size_t numStripes = size / STRIPE_SIZE;
+    for (size_t i = 0; i < numStripes; i++, p += STRIPE_SIZE) {
+        AccumulateStripe(acc, p, secret);
+        if (i % STRIPES_PER_BLOCK == STRIPES_PER_BLOCK - 1) {
+            ScrambleAcc(acc, secret);
+        }
+    }
+    return _Finalize(acc, secret, p, size % STRIPE_SIZE, size);
 }
@@ -58,22 +58,524 @@ Random::GetDouble()
 double
 Random::GetGaussian(double variance)
 {
-    if (gaussValid) {
-        gaussValid = false;
-        return sqrt(variance * gauss1) * sin(gauss2);
-    }
-    gaussValid = true;
-    gauss1 = GetDouble();
-    if (gauss1 < 1e-100) {
-        gauss1 = 1e-100;
-    }
-    gauss1 = -2.0 * log(gauss1);
-    gauss2 = GetDouble() * M_PI * 2.0;
-    return sqrt(variance * gauss1) * cos(gauss2);
+    return sqrt(variance) * adk::internal::ZigguratNormal([this]() { return _GetBits(); });
 }
 
 double
 Random::GetGaussian(double median, double deviation)
 {
-    return median + GetGaussian(deviation * deviation);
+    return median + deviation * adk::internal::ZigguratNormal([this]() { return _GetBits(); });
+}
+
+double
+Random::GetExponential(double rate)
+{
+    return adk::internal::ZigguratExponential([this]() { return _GetBits(); }) / rate;
+}
+
+/* ****************************************************************************/
+/* Ziggurat tables. */
+
+namespace {
+
+/** Build ziggurat tables for the density function.
+ *
+ * @param r Tail start.
+ * @param v Area of each layer.
+ * @param f Density function (not normalized, f(0) = 1).
+ * @param fInv Inverse of the density function.
+ */
+template <class Func, class InvFunc>
+void
+BuildZigguratTable(adk::internal::ZigguratTable &t, double r, double v, Func f, InvFunc fInv)
+{
+    const size_t n = adk::internal::ZigguratTable::NUM_LAYERS;
+    /* Base layer has the same area, its part beyond the tail start
+     * corresponds to the tail.
+     */
+    t.x[0] = v / f(r);
+    t.x[1] = r;
+    for (size_t i = 1; i < n - 1; i++) {
+        t.x[i + 1] = fInv(v / t.x[i] + f(t.x[i]));
+    }
+    t.x[n] = 0;
+    for (size_t i = 0; i <= n; i++) {
+        t.f[i] = f(t.x[i]);
+    }
+    t.r = r;
+}
+
+} /* anonymous namespace */
+
+const adk::internal::ZigguratTable &
+adk::internal::GetNormalZigguratTable()
+{
+    static const ZigguratTable table = [] () {
+        ZigguratTable t;
+        BuildZigguratTable(t, 3.6541528853610088, 0.00492867323399,
+                           [](double x) { return exp(-0.5 * x * x); },
+                           [](double y) { return sqrt(-2.0 * log(y)); });
+        return t;
+    }();
+    return table;
+}
+
+const adk::internal::ZigguratTable &
+adk::internal::GetExponentialZigguratTable()
+{
+    static const ZigguratTable table = [] () {
+        ZigguratTable t;
+        BuildZigguratTable(t, 7.69711747013104972, 0.0039496598225815571993,
+                           [](double x) { return exp(-x); },
+                           [](double y) { return -log(y); });
+        return t;
+    }();
+    return table;
+}
+
+/* ****************************************************************************/
+/* Xoshiro256 class. */
+
+void
+Xoshiro256::_Jump(const u64 *poly)
+{
+    /* The state after the jump is the linear combination of the next 256
+     * states with coefficients of the jump polynomial.
+     */
+    u64 s[4] = {0, 0, 0, 0};
+    for (size_t i = 0; i < 4; i++) {
+        for (size_t bit = 0; bit < 64; bit++) {
+            if (poly[i] & (static_cast<u64>(1) << bit)) {
+                for (size_t k = 0; k < 4; k++) {
+                    s[k] ^= _s[k];
+                }
+            }
+            Next();
+        }
+    }
+    memcpy(_s, s, sizeof(_s));
+}
+
+void
+Xoshiro256::Jump()
+{
+    static const u64 poly[4] = {
+        0x180ec6d33cfd0abaull, 0xd5a61266f0c9392cull,
+        0xa9582618e03fc9aaull, 0x39abdc4529b1661cull
+    };
+    _Jump(poly);
+}
+
+void
+Xoshiro256::LongJump()
+{
+    static const u64 poly[4] = {
+        0x76e15d3efefdcbbfull, 0xc5004e441c522fb3ull,
+        0x77710069854ee241ull, 0x39109bb02acbe635ull
+    };
+    _Jump(poly);
+}
+
+/* ****************************************************************************/
+/* Pcg64 class. */
+
+void
+Pcg64::Advance(u64 delta)
+{
+    /* Combined LCG transformation for delta steps is built by squaring,
+     * state' = accMul * state + accAdd.
+     */
+    u64 mulHi = MUL_HI, mulLo = MUL_LO, addHi = _incHi, addLo = _incLo;
+    u64 accMulHi = 0, accMulLo = 1, accAddHi = 0, accAddLo = 0;
+    while (delta) {
+        if (delta & 1) {
+            _MulAdd(accMulHi, accMulLo, mulHi, mulLo, 0, 0);
+            _MulAdd(accAddHi, accAddLo, mulHi, mulLo, addHi, addLo);
+        }
+        /* add = (mul + 1) * add */
+        u64 m1Lo = mulLo + 1, m1Hi = mulHi + (m1Lo == 0);
+        _MulAdd(addHi, addLo, m1Hi, m1Lo, 0, 0);
+        u64 hi = mulHi, lo = mulLo;
+        _MulAdd(mulHi, mulLo, hi, lo, 0, 0);
+        delta >>= 1;
+    }
+    _MulAdd(_stateHi, _stateLo, accMulHi, accMulLo, accAddHi, accAddLo);
+}
+
+/* ****************************************************************************/
+/* BulkRandom class. */
+
+#if defined(__x86_64__) && defined(__GNUC__)
+/** AVX2 implementation is compiled. */
+#define ADK_RANDOM_AVX2
+#endif
+
+namespace {
+
+typedef u64 BulkState[4][BulkRandom::NUM_STREAMS];
+
+/** Number of values generated at once into intermediate buffer. */
+const size_t CHUNK_SIZE = 32 * BulkRandom::NUM_STREAMS;
+
+/** Bits of double value 1.0. */
+const u64 DOUBLE_ONE = 0x3ff0000000000000ull;
+
+/** Convert random bits to double in range [0; 1). Mantissa bits are set
+ * directly so that the conversion is vectorizable.
+ */
+inline double
+ToDouble(u64 x)
+{
+    x = (x >> 12) | DOUBLE_ONE;
+    double d;
+    memcpy(&d, &x, sizeof(d));
+    return d - 1.0;
+}
+
+/** Generate blocks of values, one value from each stream per block.
+ *
+ * @param TDouble Output doubles in range [0; 1) if true, raw 64-bits values
+ *      otherwise.
+ */
+template <bool TDouble>
+void
+GenerateScalar(BulkState &s, void *out, size_t numBlocks)
+{
+    u8 *p = static_cast<u8 *>(out);
+    for (size_t block = 0; block < numBlocks; block++) {
+        for (size_t i = 0; i < BulkRandom::NUM_STREAMS; i++) {
+            u64 x = RotL(s[1][i] * 5, 7) * 9;
+            u64 t = s[1][i] << 17;
+            s[2][i] ^= s[0][i];
+            s[3][i] ^= s[1][i];
+            s[1][i] ^= s[2][i];
+            s[0][i] ^= s[3][i];
+            s[2][i] ^= t;
+            s[3][i] = RotL(s[3][i], 45);
+            if (TDouble) {
+                double d = ToDouble(x);
+                memcpy(p, &d, sizeof(d));
+            } else {
+                memcpy(p, &x, sizeof(x));
+            }
+            p += sizeof(u64);
+        }
+    }
+}
+
+#ifdef ADK_RANDOM_AVX2
+
+/** Advance four streams and get their output. AVX2 has no 64-bits
+ * multiplication so multiplications by 5 and 9 are done by shifts and adds.
+ */
+__attribute__((target("avx2"))) inline __m256i
+XoshiroStepAvx2(__m256i &s0, __m256i &s1, __m256i &s2, __m256i &s3)
+{
+    __m256i x = _mm256_add_epi64(s1, _mm256_slli_epi64(s1, 2));
+    x = _mm256_or_si256(_mm256_slli_epi64(x, 7), _mm256_srli_epi64(x, 57));
+    __m256i result = _mm256_add_epi64(x, _mm256_slli_epi64(x, 3));
+    __m256i t = _mm256_slli_epi64(s1, 17);
+    s2 = _mm256_xor_si256(s2, s0);
+    s3 = _mm256_xor_si256(s3, s1);
+    s1 = _mm256_xor_si256(s1, s2);
+    s0 = _mm256_xor_si256(s0, s3);
+    s2 = _mm256_xor_si256(s2, t);
+    s3 = _mm256_or_si256(_mm256_slli_epi64(s3, 45), _mm256_srli_epi64(s3, 19));
+    return result;
+}
+
+/** Store four values, optionally converted to doubles. */
+template <bool TDouble>
+__attribute__((target("avx2"))) inline void
+StoreAvx2(u8 *p, __m256i x)
+{
+    if (TDouble) {
+        __m256i bits = _mm256_or_si256(_mm256_srli_epi64(x, 12),
+                                       _mm256_set1_epi64x(DOUBLE_ONE));
+        _mm256_storeu_pd(reinterpret_cast<double *>(p),
+                         _mm256_sub_pd(_mm256_castsi256_pd(bits), _mm256_set1_pd(1.0)));
+    } else {
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), x);
+    }
+}
+
+template <bool TDouble>
+__attribute__((target("avx2"))) void
+GenerateAvx2(BulkState &s, void *out, size_t numBlocks)
+{
+    u8 *p = static_cast<u8 *>(out);
+    /* Two independent register sets of four streams each. */
+    __m256i a0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&s[0][0])),
+            a1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&s[1][0])),
+            a2 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&s[2][0])),
+            a3 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&s[3][0])),
+            b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&s[0][4])),
+            b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&s[1][4])),
+            b2 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&s[2][4])),
+            b3 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&s[3][4]));
+    for (size_t block = 0; block < numBlocks; block++) {
+        StoreAvx2<TDouble>(p, XoshiroStepAvx2(a0, a1, a2, a3));
+        StoreAvx2<TDouble>(p + 32, XoshiroStepAvx2(b0, b1, b2, b3));
+        p += BulkRandom::NUM_STREAMS * sizeof(u64);
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(&s[0][0]), a0);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(&s[1][0]), a1);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(&s[2][0]), a2);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(&s[3][0]), a3);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(&s[0][4]), b0);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(&s[1][4]), b1);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(&s[2][4]), b2);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(&s[3][4]), b3);
+}
+
+#endif /* ADK_RANDOM_AVX2 */
+
+typedef void (*GenerateFunc)(BulkState &s, void *out, size_t numBlocks);
+
+/** Select implementation once based on CPU features. */
+template <bool TDouble>
+GenerateFunc
+GetGenerateFunc()
+{
+    static const GenerateFunc func = [] () -> GenerateFunc {
+#ifdef ADK_RANDOM_AVX2
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return GenerateAvx2<TDouble>;
+        }
+#endif
+        return GenerateScalar<TDouble>;
+    }();
+    return func;
+}
+
+/** Generate the specified number of 64-bits values (u64 or double) directly
+ * into the output array. Incomplete last block is generated into temporal
+ * buffer.
+ */
+template <bool TDouble>
+void
+GenerateArray(BulkState &s, void *out, size_t n)
+{
+    GenerateFunc func = GetGenerateFunc<TDouble>();
+    size_t numBlocks = n / BulkRandom::NUM_STREAMS;
+    func(s, out, numBlocks);
+    size_t tail = n - numBlocks * BulkRandom::NUM_STREAMS;
+    if (tail) {
+        u64 buf[BulkRandom::NUM_STREAMS];
+        func(s, buf, 1);
+        memcpy(static_cast<u8 *>(out) + numBlocks * BulkRandom::NUM_STREAMS * sizeof(u64),
+               buf, tail * sizeof(u64));
+    }
+}
+
+} /* anonymous namespace */
+
+BulkRandom::BulkRandom(u64 seed, u64 stream)
+{
+    Xoshiro256 rnd(seed);
+    for (u64 i = 0; i < stream * NUM_STREAMS; i++) {
+        rnd.Jump();
+    }
+    for (size_t i = 0; i < NUM_STREAMS; i++) {
+        for (size_t word = 0; word < 4; word++) {
+            _s[word][i] = rnd._s[word];
+        }
+        rnd.Jump();
+    }
+}
+
+void
+BulkRandom::Fill(u32 *out, size_t n)
+{
+    /* 64-bits values are split to low and high halves explicitly so that
+     * the sequence does not depend on byte order.
+     */
+    u64 buf[CHUNK_SIZE];
+    for (size_t offset = 0; offset < n; offset += CHUNK_SIZE * 2) {
+        size_t size = Min(CHUNK_SIZE * 2, n - offset);
+        GenerateArray<false>(_s, buf, RoundUp(size, static_cast<size_t>(2)) / 2);
+        for (size_t i = 0; i < size; i++) {
+            out[offset + i] = buf[i / 2] >> (i % 2 * 32);
+        }
+    }
+}
+
+void
+BulkRandom::Fill(u64 *out, size_t n)
+{
+    GenerateArray<false>(_s, out, n);
+}
+
+void
+BulkRandom::FillDoubles(double *out, size_t n)
+{
+    GenerateArray<true>(_s, out, n);
+}
+
+void
+BulkRandom::FillGaussian(double *out, size_t n, double median, double deviation)
+{
+    /* Random bits for the ziggurat sampler are generated in bulk. Rejected
+     * samples consume additional values so the buffer is refilled on
+     * demand.
+     */
+    u64 buf[CHUNK_SIZE];
+    size_t pos = CHUNK_SIZE;
+    auto bits = [&]() {
+        if (pos == CHUNK_SIZE) {
+            GenerateArray<false>(_s, buf, CHUNK_SIZE);
+            pos = 0;
+        }
+        return buf[pos++];
+    };
+    for (size_t i = 0; i < n; i++) {
+        out[i] = median + deviation * adk::internal::ZigguratNormal(bits);
+    }
+}
+
+/* ****************************************************************************/
+/* AliasTable class. */
+
+AliasTable::AliasTable(const std::vector<double> &weights):
+    _entries(weights.size())
+{
+    double sum = 0;
+    for (double w: weights) {
+        if (!(w >= 0) || std::isinf(w)) {
+            ADK_EXCEPTION(InvalidParamException, "Invalid weight value: " << w);
+        }
+        sum += w;
+    }
+    if (!(sum > 0) || std::isinf(sum)) {
+        ADK_EXCEPTION(InvalidParamException, "Weights sum should be positive and finite");
+    }
+
+    /* Vose's algorithm: probabilities scaled so that the mean is one, each
+     * entry below the mean is topped up from an entry above it.
+     */
+    size_t n = weights.size();
+    std::vector<double> prob(n);
+    std::vector<size_t> small, large;
+    for (size_t i = 0; i < n; i++) {
+        prob[i] = weights[i] * n / sum;
+        (prob[i] < 1 ? small : large).push_back(i);
+    }
+    const double scale = static_cast<double>(static_cast<u64>(1) << 32);
+    while (!small.empty() && !large.empty()) {
+        size_t s = small.back(), l = large.back();
+        small.pop_back();
+        _entries[s].threshold = static_cast<u64>(prob[s] * scale);
+        _entries[s].alias = l;
+        prob[l] -= 1 - prob[s];
+        if (prob[l] < 1) {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+    /* Remaining entries have probability one up to rounding errors. */
+    for (size_t i: large) {
+        _entries[i].threshold = static_cast<u64>(1) << 32;
+        _entries[i].alias = i;
+    }
+    for (size_t i: small) {
+        _entries[i].threshold = static_cast<u64>(1) << 32;
+        _entries[i].alias = i;
+    }
+}
+
+/* ****************************************************************************/
+/* ThreadLocalRandom class. */
+
+namespace {
+
+/** Seed for threads generators. */
+std::atomic<u64> threadSeed(0);
+/** Incremented on each seed change. */
+std::atomic<unsigned> threadSeedGeneration(0);
+/** Stream index for the next thread which is not a pool worker. */
+std::atomic<u64> nextOtherThreadStream(0);
+
+/** Threads streams are placed in @ref Xoshiro256::LongJump segments of the
+ * seed sequence. Segment zero is left for Xoshiro256(seed, stream) and
+ * BulkRandom streams, so they never overlap with threads streams.
+ */
+enum {
+    /** Segment for threads which are not pool workers. */
+    OTHER_THREADS_SEGMENT = 1,
+    /** Segment for workers of the first pool, the next pools follow. */
+    FIRST_POOL_SEGMENT = 2
+};
+
+/** Starting states of threads streams for the current seed. Segment starting
+ * states are separated by @ref Xoshiro256::LongJump, streams in a segment by
+ * @ref Xoshiro256::Jump. Each state is obtained from the previous one, so a
+ * thread does not have to jump over all the preceding streams.
+ */
+std::mutex threadStreamsMutex;
+u64 threadStreamsSeed;
+std::vector<std::vector<Xoshiro256>> threadStreams;
+
+Xoshiro256
+GetThreadStream(u64 seed, size_t segment, size_t index)
+{
+    std::unique_lock<std::mutex> lock(threadStreamsMutex);
+    if (threadStreams.empty() || threadStreamsSeed != seed) {
+        threadStreams.clear();
+        threadStreamsSeed = seed;
+        threadStreams.emplace_back(1, Xoshiro256(seed));
+    }
+    while (threadStreams.size() <= segment) {
+        Xoshiro256 start = threadStreams.back().front();
+        start.LongJump();
+        threadStreams.emplace_back(1, start);
+    }
+    std::vector<Xoshiro256> &streams = threadStreams[segment];
+    while (streams.size() <= index) {
+        Xoshiro256 start = streams.back();
+        start.Jump();
+        streams.push_back(start);
+    }
+    return streams[index];
+}
+
+/** Generator state of a thread. */
+struct ThreadRandom {
+    Xoshiro256 rnd {0};
+    /** Seed generation the generator is initialized for. */
+    unsigned generation = ~0u;
+    /** Stream index if not a pool worker, assigned on first access. */
+    i64 otherStream = -1;
+};
+
+} /* anonymous namespace */
+
+void
+ThreadLocalRandom::SetSeed(u64 seed)
+{
+    threadSeed.store(seed);
+    threadSeedGeneration.fetch_add(1, std::memory_order_release);
+}
+
+Xoshiro256 &
+ThreadLocalRandom::Get()
+{
+    thread_local ThreadRandom state;
+    unsigned generation = threadSeedGeneration.load(std::memory_order_acquire);
+    if (state.generation == generation) {
+        return state.rnd;
+    }
+    state.generation = generation;
+    u64 seed = threadSeed.load();
+    int poolIndex = ThreadPoolExecutor::GetCurrentPoolIndex();
+    if (poolIndex >= 0) {
+        state.rnd = GetThreadStream(seed, FIRST_POOL_SEGMENT + poolIndex,
+                                    ThreadPoolExecutor::GetCurrentWorkerIndex());
+        return state.rnd;
+    }
+    if (state.otherStream < 0) {
+        state.otherStream = nextOtherThreadStream.fetch_add(1);
+    }
+    state.rnd = GetThreadStream(seed, OTHER_THREADS_SEGMENT, state.otherStream);
+    return state.rnd;
 }
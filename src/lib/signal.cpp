@@ -15,35 +15,62 @@ using namespace adk;
 void
 SlotTarget::_RegisterSlot(adk_internal::SlotBase *slot)
 {
-    std::unique_lock<std::mutex> lock(_slotsMutex);
-    _slots.push_back(slot);
+    SpinlockGuard lock(_slotsLock);
+    slot->_prevSlot = nullptr;
+    slot->_nextSlot = _slots;
+    if (_slots) {
+        _slots->_prevSlot = slot;
+    }
+    _slots = slot;
 }
 
 void
 SlotTarget::_ReplaceSlot(adk_internal::SlotBase *slot,
                          adk_internal::SlotBase *newSlot)
 {
-    std::unique_lock<std::mutex> lock(_slotsMutex);
-    for (adk_internal::SlotBase *&slotEntry: _slots) {
-        if (slotEntry == slot) {
-            slotEntry = newSlot;
-            return;
-        }
+    SpinlockGuard lock(_slotsLock);
+    ASSERT(slot->_prevSlot || _slots == slot);
+    newSlot->_prevSlot = slot->_prevSlot;
+    newSlot->_nextSlot = slot->_nextSlot;
+    if (slot->_prevSlot) {
+        slot->_prevSlot->_nextSlot = newSlot;
+    } else {
+        _slots = newSlot;
+    }
+    if (slot->_nextSlot) {
+        slot->_nextSlot->_prevSlot = newSlot;
     }
-    ASSERT(false);
+    slot->_prevSlot = nullptr;
+    slot->_nextSlot = nullptr;
 }
 
 void
 SlotTarget::_RemoveSlot(adk_internal::SlotBase *slot)
 {
-    std::unique_lock<std::mutex> lock(_slotsMutex);
-    _slots.remove(slot);
+    SpinlockGuard lock(_slotsLock);
+    ASSERT(slot->_prevSlot || _slots == slot);
+    if (slot->_prevSlot) {
+        slot->_prevSlot->_nextSlot = slot->_nextSlot;
+    } else {
+        _slots = slot->_nextSlot;
+    }
+    if (slot->_nextSlot) {
+        slot->_nextSlot->_prevSlot = slot->_prevSlot;
+    }
+    slot->_prevSlot = nullptr;
+    slot->_nextSlot = nullptr;
 }
 
 SlotTarget::~SlotTarget()
 {
-    std::unique_lock<std::mutex> lock(_slotsMutex);
-    for (adk_internal::SlotBase *slot: _slots) {
+    SpinlockGuard lock(_slotsLock);
+    adk_internal::SlotBase *slot = _slots;
+    while (slot) {
+        adk_internal::SlotBase *next = slot->_nextSlot;
+        slot->_prevSlot = nullptr;
+        slot->_nextSlot = nullptr;
         slot->_Unbind();
+        slot = next;
     }
+    _slots = nullptr;
 }
@@ -0,0 +1,209 @@
+/* This file is a part of ADK library.
+ * Copyright (c) 2012-2015, Artyom Lebedev <artyom.lebedev@gmail.com>
+ * All rights reserved.
+ * See LICENSE file for copyright details.
+ */
+
+/** @file sketch.cpp
+ * Probabilistic data structures implementation.
+ */
+
+#include <adk.h>
+#include <cmath>
+
+using namespace adk;
+
+/* ****************************************************************************/
+/* BloomFilter class. */
+
+BloomFilter::BloomFilter(size_t numItems, double falsePositiveRate, u32 seed):
+    _seed(seed)
+{
+    if (!numItems || falsePositiveRate <= 0 || falsePositiveRate >= 1) {
+        ADK_EXCEPTION(InvalidParamException, "Invalid Bloom filter parameters");
+    }
+    const double ln2 = std::log(2.0);
+    /* Optimal parameters for the classic filter. Blocking increases false
+     * positive rate because of uneven blocks load, 1/8 more bits mostly
+     * compensate it for practical rates.
+     */
+    double numBits = -static_cast<double>(numItems) * std::log(falsePositiveRate) /
+        (ln2 * ln2) * 9 / 8;
+    _numBlocks = Max<size_t>(1, std::ceil(numBits / (BLOCK_SIZE * NBBY)));
+    _numHashes = Min<int>(MAX_HASHES, Max<int>(1,
+        std::lround(-std::log(falsePositiveRate) / ln2)));
+
+    _storage.reset(new u64[_numBlocks * BLOCK_WORDS + BLOCK_WORDS]);
+    _blocks = reinterpret_cast<u64 *>(
+        RoundUp2(reinterpret_cast<uintptr_t>(_storage.get()), BLOCK_SIZE));
+    Clear();
+}
+
+void
+BloomFilter::AddHash(u64 hash)
+{
+    u64 *block = _GetBlock(hash);
+    /* Bit positions in the block are taken from the top bits of double
+     * hashing sequence.
+     */
+    u32 h = hash >> 32, step = RotL(static_cast<u32>(hash), 16) | 1;
+    for (int i = 0; i < _numHashes; i++, h += step) {
+        u32 bit = h >> 23;
+        block[bit / 64] |= static_cast<u64>(1) << (bit % 64);
+    }
+}
+
+bool
+BloomFilter::ContainsHash(u64 hash) const
+{
+    const u64 *block = _GetBlock(hash);
+    u32 h = hash >> 32, step = RotL(static_cast<u32>(hash), 16) | 1;
+    for (int i = 0; i < _numHashes; i++, h += step) {
+        u32 bit = h >> 23;
+        if (!(block[bit / 64] & (static_cast<u64>(1) << (bit % 64)))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void
+BloomFilter::Merge(const BloomFilter &other)
+{
+    if (_numBlocks != other._numBlocks || _numHashes != other._numHashes ||
+        _seed != other._seed) {
+
+        ADK_EXCEPTION(InvalidParamException, "Bloom filters parameters mismatch");
+    }
+    for (size_t i = 0; i < _numBlocks * BLOCK_WORDS; i++) {
+        _blocks[i] |= other._blocks[i];
+    }
+}
+
+void
+BloomFilter::Clear()
+{
+    memset(_blocks, 0, _numBlocks * BLOCK_SIZE);
+}
+
+/* ****************************************************************************/
+/* CountMinSketch class. */
+
+CountMinSketch::CountMinSketch(double epsilon, double delta, u32 seed):
+    _seed(seed)
+{
+    if (epsilon <= 0 || epsilon >= 1 || delta <= 0 || delta >= 1) {
+        ADK_EXCEPTION(InvalidParamException, "Invalid count-min sketch parameters");
+    }
+    size_t width = std::ceil(std::exp(1.0) / epsilon);
+    _width = 1;
+    while (_width < width) {
+        _width <<= 1;
+    }
+    _depth = Max<size_t>(1, std::ceil(std::log(1 / delta)));
+    _counters.resize(_width * _depth);
+}
+
+void
+CountMinSketch::AddHash(u64 hash, u64 count)
+{
+    u32 h = hash, step = (hash >> 32) | 1;
+    for (size_t row = 0; row < _depth; row++, h += step) {
+        _counters[row * _width + (h & (_width - 1))] += count;
+    }
+    _total += count;
+}
+
+u64
+CountMinSketch::EstimateHash(u64 hash) const
+{
+    u32 h = hash, step = (hash >> 32) | 1;
+    u64 result = ~static_cast<u64>(0);
+    for (size_t row = 0; row < _depth; row++, h += step) {
+        result = Min(result, _counters[row * _width + (h & (_width - 1))]);
+    }
+    return result;
+}
+
+void
+CountMinSketch::Merge(const CountMinSketch &other)
+{
+    if (_width != other._width || _depth != other._depth || _seed != other._seed) {
+        ADK_EXCEPTION(InvalidParamException, "Count-min sketches parameters mismatch");
+    }
+    for (size_t i = 0; i < _counters.size(); i++) {
+        _counters[i] += other._counters[i];
+    }
+    _total += other._total;
+}
+
+void
+CountMinSketch::Clear()
+{
+    std::fill(_counters.begin(), _counters.end(), 0);
+    _total = 0;
+}
+
+/* ****************************************************************************/
+/* HyperLogLog class. */
+
+HyperLogLog::HyperLogLog(int precision, u32 seed):
+    _precision(precision), _seed(seed)
+{
+    if (precision < MIN_PRECISION || precision > MAX_PRECISION) {
+        ADK_EXCEPTION(InvalidParamException, "Invalid HyperLogLog precision");
+    }
+    _registers.resize(static_cast<size_t>(1) << precision);
+}
+
+double
+HyperLogLog::Estimate() const
+{
+    size_t m = _registers.size(), numZeros = 0;
+    double sum = 0;
+    for (u8 reg: _registers) {
+        sum += std::ldexp(1.0, -reg);
+        if (!reg) {
+            numZeros++;
+        }
+    }
+    double alpha;
+    switch (m) {
+    case 16:
+        alpha = 0.673;
+        break;
+    case 32:
+        alpha = 0.697;
+        break;
+    case 64:
+        alpha = 0.709;
+        break;
+    default:
+        alpha = 0.7213 / (1 + 1.079 / m);
+    }
+    double estimate = alpha * m * m / sum;
+    /* Linear counting is more accurate for small cardinalities. Large range
+     * correction is not needed with 64-bits hash.
+     */
+    if (estimate <= 2.5 * m && numZeros) {
+        estimate = m * std::log(static_cast<double>(m) / numZeros);
+    }
+    return estimate;
+}
+
+void
+HyperLogLog::Merge(const HyperLogLog &other)
+{
+    if (_precision != other._precision || _seed != other._seed) {
+        ADK_EXCEPTION(InvalidParamException, "HyperLogLog parameters mismatch");
+    }
+    for (size_t i = 0; i < _registers.size(); i++) {
+        _registers[i] = Max(_registers[i], other._registers[i]);
+    }
+}
+
+void
+HyperLogLog::Clear()
+{
+    std::fill(_registers.begin(), _registers.end(), 0);
+}
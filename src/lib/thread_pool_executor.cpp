@@ -10,11 +10,24 @@
 
 using namespace adk;
 
+namespace {
+
+/** Index of the next pool to create. */
+std::atomic<int> nextPoolIndex(0);
+
+/** Index of the current worker thread in its pool, -1 for other threads. */
+thread_local int currentWorkerIndex = -1;
+
+/** Index of the current worker thread pool, -1 for other threads. */
+thread_local int currentPoolIndex = -1;
+
+} /* anonymous namespace */
+
 ThreadPoolExecutor::ThreadPoolExecutor(int numThreads, size_t queueSize):
-    numThreads(numThreads), queue(queueSize)
+    numThreads(numThreads), poolIndex(nextPoolIndex.fetch_add(1)), queue(queueSize)
 {
     for (int i = 0; i < numThreads; i++) {
-        threads.emplace_back(&ThreadPoolExecutor::ThreadFunc, this);
+        threads.emplace_back(&ThreadPoolExecutor::ThreadFunc, this, i);
     }
 }
 
@@ -52,9 +65,23 @@ ThreadPoolExecutor::Terminate()
     threads.clear();
 }
 
+int
+ThreadPoolExecutor::GetCurrentWorkerIndex()
+{
+    return currentWorkerIndex;
+}
+
+int
+ThreadPoolExecutor::GetCurrentPoolIndex()
+{
+    return currentPoolIndex;
+}
+
 void
-ThreadPoolExecutor::ThreadFunc()
+ThreadPoolExecutor::ThreadFunc(int workerIndex)
 {
+    currentWorkerIndex = workerIndex;
+    currentPoolIndex = poolIndex;
     while (!queue.IsExitRequested()) {
         Action action;
         if (queue.Pop(action)) {
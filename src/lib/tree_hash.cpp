@@ -0,0 +1,188 @@
+/* This file is a part of ADK library.
+ * Copyright (c) 2012-2015, Artyom Lebedev <artyom.lebedev@gmail.com>
+ * All rights reserved.
+ * See LICENSE file for copyright details.
+ */
+
+/** @file tree_hash.cpp
+ * Tree hash implementation.
+ */
+
+#include <adk.h>
+
+using namespace adk;
+
+namespace {
+
+/** Seed modifier for the root hash so that leaf and root digests are
+ * calculated in different domains.
+ */
+const u64 ROOT_SEED_TAG = 0x9e3779b97f4a7c15ull;
+
+/** Shared state of parallel leaves hashing. Leaves are claimed one by one by
+ * the submitted actions and by the calling thread, so leaves of actions
+ * which are dropped by the executor or never submitted are hashed by the
+ * caller. The state is co-owned by the actions, so the ones executed after
+ * all leaves are done do not refer to the caller stack.
+ */
+class LeavesJob {
+public:
+    LeavesJob(const u8 *data, size_t numLeaves, size_t leafSize, u64 seed):
+        digests(numLeaves), _data(data), _numLeaves(numLeaves), _leafSize(leafSize),
+        _seed(seed)
+    {}
+
+    /** Leaf digests in the leaves order. */
+    std::vector<Hash128::Value> digests;
+
+    /** Claim and hash leaves until all are claimed. */
+    void
+    Run()
+    {
+        size_t numHashed = 0, i;
+        while ((i = _nextLeaf.fetch_add(1, std::memory_order_relaxed)) < _numLeaves) {
+            digests[i] = Hash128::Compute128(_data + i * _leafSize, _leafSize, _seed);
+            numHashed++;
+        }
+        if (numHashed) {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _numDone += numHashed;
+            if (_numDone == _numLeaves) {
+                _cv.notify_one();
+            }
+        }
+    }
+
+    /** Wait until all leaves are hashed. Should be called after @ref Run so
+     * that the remaining leaves are being hashed by running actions.
+     */
+    void
+    Wait()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _cv.wait(lock, [this]() { return _numDone == _numLeaves; });
+    }
+
+private:
+    const u8 *_data;
+    size_t _numLeaves, _leafSize;
+    u64 _seed;
+    /** Index of the next leaf to claim. */
+    std::atomic<size_t> _nextLeaf {0};
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    /** Number of hashed leaves. */
+    size_t _numDone = 0;
+};
+
+} /* anonymous namespace */
+
+TreeHash::TreeHash(Executor *executor, size_t leafSize, u64 seed):
+    _executor(executor), _leafSize(leafSize)
+{
+    if (!leafSize) {
+        ADK_EXCEPTION(InvalidParamException, "Leaf size should be non-zero");
+    }
+    Reset(seed);
+}
+
+void
+TreeHash::Reset(u64 seed)
+{
+    _seed = seed;
+    _leaf.Reset(seed);
+    _root.Reset(seed ^ ROOT_SEED_TAG);
+    _length = 0;
+}
+
+void
+TreeHash::_FeedDigest(Hash128 &root, const Hash128::Value &digest)
+{
+    u64 words[2] = {Le(digest.low), Le(digest.high)};
+    root.Feed(words, sizeof(words));
+}
+
+void
+TreeHash::Feed(const void *data, size_t size)
+{
+    if (!size) {
+        return;
+    }
+    const u8 *p = static_cast<const u8 *>(data);
+    _length += size;
+
+    /* Complete the current leaf first. */
+    size_t leafResid = _leaf.GetLength();
+    if (leafResid) {
+        size_t n = Min(size, _leafSize - leafResid);
+        _leaf.Feed(p, n);
+        p += n;
+        size -= n;
+        if (_leaf.GetLength() < _leafSize) {
+            return;
+        }
+        _FeedDigest(_root, _leaf.Get128());
+        _leaf.Reset(_seed);
+    }
+
+    size_t numLeaves = size / _leafSize;
+    if (numLeaves) {
+        _FeedLeaves(p, numLeaves);
+        p += numLeaves * _leafSize;
+        size -= numLeaves * _leafSize;
+    }
+    _leaf.Feed(p, size);
+}
+
+void
+TreeHash::_FeedLeaves(const u8 *data, size_t numLeaves)
+{
+    if (!_executor || numLeaves == 1) {
+        for (size_t i = 0; i < numLeaves; i++) {
+            _FeedDigest(_root, Hash128::Compute128(data + i * _leafSize, _leafSize, _seed));
+        }
+        return;
+    }
+
+    auto job = std::make_shared<LeavesJob>(data, numLeaves, _leafSize, _seed);
+    try {
+        /* The calling thread takes its share as well. */
+        for (size_t i = 1; i < numLeaves; i++) {
+            _executor->Submit([job]() { job->Run(); });
+        }
+    } catch (...) {
+        /* Leaves of the actions not submitted are hashed below. */
+    }
+    job->Run();
+    job->Wait();
+    /* Digests are combined in the leaves order regardless of completion
+     * order.
+     */
+    for (const Hash128::Value &digest: job->digests) {
+        _FeedDigest(_root, digest);
+    }
+}
+
+Hash128::Value
+TreeHash::Get128() const
+{
+    Hash128 root(_root);
+    /* Trailing incomplete leaf. Empty input is represented by one empty
+     * leaf.
+     */
+    if (_leaf.GetLength() || !_length) {
+        _FeedDigest(root, _leaf.Get128());
+    }
+    u64 trailer[2] = {Le(static_cast<u64>(_length)), Le(static_cast<u64>(_leafSize))};
+    root.Feed(trailer, sizeof(trailer));
+    return root.Get128();
+}
+
+Hash128::Value
+TreeHash::Compute128(const void *data, size_t size, Executor *executor,
+                     size_t leafSize, u64 seed)
+{
+    TreeHash hash(executor, leafSize, seed);
+    hash.Feed(data, size);
+    return hash.Get128();
+}
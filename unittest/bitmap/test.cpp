@@ -102,3 +102,643 @@ UT_TEST("Dynamic bitmap")
     Bitmap<-1> bm(numBits);
     TestBitmap(bm);
 }
+
+/* Compare search results with naive bit-by-bit scan. */
+template <class BitmapT>
+void
+CheckSearch(BitmapT &bm, size_t n)
+{
+    for (size_t start = 0; start <= n + 1; start += 7) {
+        size_t expSet = -1, expClear = -1;
+        for (size_t i = start; i < n; i++) {
+            if (bm.IsSet(i) && expSet == static_cast<size_t>(-1)) {
+                expSet = i;
+            }
+            if (bm.IsClear(i) && expClear == static_cast<size_t>(-1)) {
+                expClear = i;
+            }
+        }
+        UT(bm.FirstSet(start)) == UT(expSet);
+        UT(bm.FirstClear(start)) == UT(expClear);
+    }
+}
+
+template <typename word_t>
+void
+TestLargeSearch()
+{
+    const size_t n = 1500;
+    Bitmap<-1, std::allocator<int>, word_t> bm(n);
+    CheckSearch(bm, n);
+    /* Sparse set bits with long empty runs between them. */
+    bm.Set(0);
+    bm.Set(700);
+    bm.Set(1001);
+    bm.Set(n - 1);
+    CheckSearch(bm, n);
+    /* Long full runs with sparse holes. */
+    bm.Invert();
+    CheckSearch(bm, n);
+    bm.SetAll();
+    CheckSearch(bm, n);
+}
+
+UT_TEST("Large bitmap search")
+{
+    TestLargeSearch<long>();
+    TestLargeSearch<u8>();
+    TestLargeSearch<u16>();
+    TestLargeSearch<u32>();
+    TestLargeSearch<u64>();
+}
+
+template <typename word_t>
+void
+TestBulkOps(size_t n)
+{
+    typedef Bitmap<-1, std::allocator<int>, word_t> BitmapT;
+    BitmapT a(n), b(n);
+    for (size_t i = 0; i < n; i++) {
+        if (i % 3 == 0) {
+            a.Set(i);
+        }
+        if (i % 5 == 0) {
+            b.Set(i);
+        }
+    }
+
+    size_t countA = 0;
+    for (size_t i = 0; i < n; i++) {
+        countA += a.IsSet(i);
+    }
+    UT(a.Count()) == UT(countA);
+    for (size_t start = 0; start < n; start += 13) {
+        for (size_t len = 0; start + len <= n; len += 17) {
+            size_t cnt = 0;
+            for (size_t i = start; i < start + len; i++) {
+                cnt += a.IsSet(i);
+            }
+            UT(a.CountRange(start, len)) == UT(cnt);
+        }
+    }
+
+    BitmapT r(n);
+    r.Or(a);
+    r.And(b);
+    for (size_t i = 0; i < n; i++) {
+        UT(r.IsSet(i)) == UT(i % 15 == 0);
+    }
+    UT_BOOL(r.IsSubsetOf(a)) == UT_TRUE;
+    UT_BOOL(r.IsSubsetOf(b)) == UT_TRUE;
+    UT_BOOL(a.IsSubsetOf(r)) == UT(n <= 3);
+    UT_BOOL(a.Intersects(b)) == UT_TRUE;
+
+    r.ClearAll();
+    r.Or(a);
+    r.AndNot(b);
+    UT_BOOL(r.Intersects(b)) == UT_FALSE;
+    for (size_t i = 0; i < n; i++) {
+        UT(r.IsSet(i)) == UT(i % 3 == 0 && i % 5 != 0);
+    }
+
+    r.Xor(a);
+    for (size_t i = 0; i < n; i++) {
+        UT(r.IsSet(i)) == UT(i % 15 == 0);
+    }
+
+    /* Bits beyond the bitmap size should not affect results. */
+    BitmapT full(n), empty(n);
+    full.SetAll();
+    UT(full.Count()) == UT(n);
+    UT_BOOL(full.IsSubsetOf(full)) == UT_TRUE;
+    UT_BOOL(empty.Intersects(full)) == UT_FALSE;
+    UT_BOOL(full.IsSubsetOf(empty)) == UT_FALSE;
+}
+
+UT_TEST("Bulk operations")
+{
+    for (size_t n: {1, 33, 64, 65, 1000, 1024, 2049}) {
+        TestBulkOps<long>(n);
+        TestBulkOps<u8>(n);
+        TestBulkOps<u32>(n);
+    }
+
+    /* Static and dynamic bitmaps can be mixed. */
+    Bitmap<numBits> s;
+    Bitmap<-1> d(numBits);
+    s.Set(1);
+    d.Set(1);
+    d.Set(2);
+    UT_BOOL(s.IsSubsetOf(d)) == UT_TRUE;
+    s.Or(d);
+    UT(s.Count()) == UT_SIZE(2);
+}
+
+/* Compare hierarchical bitmap search with plain bitmap. */
+void
+CheckHierarchicalSearch(HierarchicalBitmap<> &hbm, Bitmap<-1> &bm, size_t step)
+{
+    for (size_t start = 0; start <= hbm.GetNumBits(); start += step) {
+        UT(hbm.FirstSet(start)) == UT(bm.FirstSet(start));
+        UT(hbm.FirstClear(start)) == UT(bm.FirstClear(start));
+    }
+}
+
+UT_TEST("Hierarchical bitmap")
+{
+    for (size_t n: {1, 63, 64, 65, 4096, 4097, 300000}) {
+        UT_CKPOINT("n = %zu", n);
+        HierarchicalBitmap<> hbm(n);
+        Bitmap<-1> bm(n);
+        size_t step = n / 50 + 1;
+
+        CheckHierarchicalSearch(hbm, bm, step);
+        hbm.SetAll();
+        bm.SetAll();
+        CheckHierarchicalSearch(hbm, bm, step);
+
+        /* Sparse holes in full bitmap. */
+        for (size_t i = 7; i < n; i += 4999) {
+            hbm.Clear(i);
+            bm.Clear(i);
+        }
+        CheckHierarchicalSearch(hbm, bm, step);
+
+        /* Allocate all free bits one by one. */
+        size_t idx;
+        while ((idx = hbm.FirstClear()) != static_cast<size_t>(-1)) {
+            UT(idx) == UT(bm.FirstClear());
+            hbm.Set(idx);
+            bm.Set(idx);
+        }
+        UT(bm.FirstClear()) == UT_SIZE(-1);
+
+        /* Sparse set bits in empty bitmap. */
+        hbm.ClearAll();
+        bm.ClearAll();
+        for (size_t i = n / 3; i < n; i += 7777) {
+            hbm.Set(i);
+            bm.Set(i);
+            UT_BOOL(hbm.IsSet(i)) == UT_TRUE;
+        }
+        CheckHierarchicalSearch(hbm, bm, step);
+        while ((idx = hbm.FirstSet()) != static_cast<size_t>(-1)) {
+            UT(idx) == UT(bm.FirstSet());
+            hbm.Clear(idx);
+            bm.Clear(idx);
+        }
+        UT(bm.FirstSet()) == UT_SIZE(-1);
+    }
+}
+
+UT_TEST("Atomic bitmap")
+{
+    AtomicBitmap<> bm(100);
+    UT_BOOL(bm.TrySet(5)) == UT_TRUE;
+    UT_BOOL(bm.TrySet(5)) == UT_FALSE;
+    UT_BOOL(bm.IsSet(5)) == UT_TRUE;
+    UT(bm.ClaimFirstClear(5)) == UT_SIZE(6);
+    UT(bm.ClaimFirstClear(99)) == UT_SIZE(99);
+    /* Wraps around the end. */
+    UT(bm.ClaimFirstClear(99)) == UT_SIZE(0);
+    UT_BOOL(bm.TryClear(5)) == UT_TRUE;
+    UT_BOOL(bm.TryClear(5)) == UT_FALSE;
+    UT_BOOL(bm.IsClear(5)) == UT_TRUE;
+
+    /* Concurrent claiming - each bit should be claimed exactly once. */
+    const size_t n = 10000;
+    AtomicBitmap<u32> abm(n);
+    std::vector<std::atomic<int>> claims(n);
+    for (auto &c: claims) {
+        c = 0;
+    }
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&]() {
+            size_t idx;
+            while ((idx = abm.ClaimFirstClear()) != static_cast<size_t>(-1)) {
+                claims[idx]++;
+            }
+        });
+    }
+    for (std::thread &t: threads) {
+        t.join();
+    }
+    bool allOnce = true;
+    for (auto &c: claims) {
+        if (c != 1) {
+            allOnce = false;
+        }
+    }
+    UT_BOOL(allOnce) == UT_TRUE;
+    UT(abm.ClaimFirstClear(0)) == UT_SIZE(-1);
+    UT_BOOL(abm.TryClear(1234)) == UT_TRUE;
+    UT(abm.ClaimFirstClear()) == UT_SIZE(1234);
+
+    /* Claims in one bitmap do not move the start position in another. */
+    AtomicBitmap<> bm1(1000), bm2(1000), bm3(1000);
+    size_t first = bm1.ClaimFirstClear();
+    for (int i = 0; i < 100; i++) {
+        bm2.ClaimFirstClear();
+    }
+    UT(bm3.ClaimFirstClear()) == UT(first);
+
+    /* Narrow words with partial last word. */
+    AtomicBitmap<u8> bm8(13);
+    for (size_t i = 0; i < 13; i++) {
+        UT(bm8.ClaimFirstClear(i)) == UT(i);
+    }
+    UT(bm8.ClaimFirstClear(0)) == UT_SIZE(-1);
+    AtomicBitmap<u16> bm16(21);
+    UT(bm16.ClaimFirstClear(20)) == UT_SIZE(20);
+    UT(bm16.ClaimFirstClear(20)) == UT_SIZE(0);
+}
+
+/* Reference implementation of clear run search. */
+template <class BitmapT>
+size_t
+NaiveFindClearRun(BitmapT &bm, size_t n, size_t length, size_t alignment, size_t startBit)
+{
+    for (size_t pos = RoundUp(startBit, alignment); pos + length <= n; pos += alignment) {
+        bool found = true;
+        for (size_t i = pos; i < pos + length; i++) {
+            if (bm.IsSet(i)) {
+                found = false;
+                break;
+            }
+        }
+        if (found) {
+            return pos;
+        }
+    }
+    return -1;
+}
+
+template <typename word_t>
+void
+TestRanges(size_t n)
+{
+    Bitmap<-1, std::allocator<int>, word_t> bm(n);
+
+    for (size_t start = 0; start < n; start += 11) {
+        for (size_t len = 0; start + len <= n; len += 29) {
+            bm.ClearAll();
+            bm.SetRange(start, len);
+            UT(bm.Count()) == UT(len);
+            UT_BOOL(bm.IsRangeSet(start, len)) == UT_TRUE;
+            if (len) {
+                UT(bm.FirstSet()) == UT(start);
+                UT_BOOL(bm.IsRangeClear(start, len)) == UT_FALSE;
+            }
+            if (start) {
+                UT_BOOL(bm.IsRangeClear(0, start)) == UT_TRUE;
+            }
+            UT_BOOL(bm.IsRangeClear(start + len, n - start - len)) == UT_TRUE;
+
+            bm.SetAll();
+            bm.ClearRange(start, len);
+            UT(bm.Count()) == UT(n - len);
+            UT_BOOL(bm.IsRangeClear(start, len)) == UT_TRUE;
+        }
+    }
+
+    /* First-fit allocation of blocks of various sizes and alignments. */
+    bm.ClearAll();
+    size_t sizes[] = {1, 3, 8, 64, 5, 100, 2};
+    size_t aligns[] = {1, 1, 8, 64, 4, 1, 16};
+    for (int iter = 0; iter < 3; iter++) {
+        for (size_t i = 0; i < SIZEOF_ARRAY(sizes); i++) {
+            size_t exp = NaiveFindClearRun(bm, n, sizes[i], aligns[i], 0);
+            size_t pos = bm.FindClearRun(sizes[i], aligns[i]);
+            UT(pos) == UT(exp);
+            if (pos != static_cast<size_t>(-1)) {
+                bm.SetRange(pos, sizes[i]);
+            }
+        }
+        /* Make some holes. */
+        for (size_t i = 0; i + 10 < n; i += 37) {
+            bm.ClearRange(i, 10);
+        }
+    }
+    for (size_t start = 0; start < n; start += 97) {
+        UT(bm.FindClearRun(9, 3, start)) == UT(NaiveFindClearRun(bm, n, 9, 3, start));
+    }
+}
+
+UT_TEST("Range operations")
+{
+    for (size_t n: {1, 64, 130, 1000}) {
+        TestRanges<long>(n);
+        TestRanges<u8>(n);
+    }
+}
+
+namespace {
+
+/** Verify that iteration and decoding give the same bits as FirstSet(). */
+template <class BitmapT>
+void
+CheckEnumerate(const BitmapT &bm, size_t n)
+{
+    std::vector<size_t> exp;
+    for (size_t i = bm.FirstSet(); i != static_cast<size_t>(-1); i = bm.FirstSet(i + 1)) {
+        exp.push_back(i);
+    }
+    std::vector<size_t> iterated;
+    for (size_t i: bm.SetBits()) {
+        UT(i < n) == UT_TRUE;
+        iterated.push_back(i);
+    }
+    UT(iterated.size()) == UT(exp.size());
+    UT_BOOL(iterated == exp) == UT_TRUE;
+
+    std::vector<u32> decoded(bm.Count());
+    UT(bm.DecodeTo(decoded.data())) == UT(exp.size());
+    for (size_t i = 0; i < exp.size(); i++) {
+        UT(static_cast<size_t>(decoded[i])) == UT(exp[i]);
+    }
+}
+
+template <typename word_t>
+void
+TestEnumerate(size_t n)
+{
+    Bitmap<-1, std::allocator<int>, word_t> bm(n);
+    CheckEnumerate(bm, n);
+    UT_BOOL(bm.SetBits().begin() == bm.SetBits().end()) == UT_TRUE;
+    for (size_t i = 0; i < n; i += 7) {
+        bm.Set(i);
+    }
+    bm.Set(n - 1);
+    CheckEnumerate(bm, n);
+    /* Bits beyond the bitmap size must not be reported. */
+    bm.SetAll();
+    CheckEnumerate(bm, n);
+    bm.ClearRange(n / 4, n / 2);
+    CheckEnumerate(bm, n);
+}
+
+} /* anonymous namespace */
+
+UT_TEST("Set bits enumeration")
+{
+    for (size_t n: {1, 13, 64, 100, 1000, 4099}) {
+        TestEnumerate<long>(n);
+        TestEnumerate<u8>(n);
+        TestEnumerate<u32>(n);
+    }
+    Bitmap<200> bm;
+    bm.Set(3);
+    bm.Set(199);
+    auto it = bm.SetBits().begin();
+    UT(*it++) == UT(static_cast<size_t>(3));
+    UT(*it) == UT(static_cast<size_t>(199));
+    UT_BOOL(++it == bm.SetBits().end()) == UT_TRUE;
+}
+
+namespace {
+
+/** Verify compressed bitmap content against the reference set. */
+void
+CheckCompressed(const CompressedBitmap &bm, const std::set<u32> &ref)
+{
+    UT(bm.Count()) == UT(ref.size());
+    UT_BOOL(bm.IsEmpty()) == UT_BOOL(ref.empty());
+    size_t bit = bm.FirstSet();
+    for (u32 v: ref) {
+        UT(bit) == UT(static_cast<size_t>(v));
+        UT_BOOL(bm.IsSet(v)) == UT_TRUE;
+        bit = bm.FirstSet(bit + 1);
+    }
+    UT(bit) == UT(static_cast<size_t>(-1));
+}
+
+/** Generate a set with sparse, dense and run-like chunks. */
+void
+FillCompressed(CompressedBitmap &bm, std::set<u32> &ref, u32 seed)
+{
+    Random rnd(seed);
+    /* Sparse values over the whole range. */
+    for (int i = 0; i < 2000; i++) {
+        u32 v = static_cast<u32>(rnd.GetInt32());
+        bm.Set(v);
+        ref.insert(v);
+    }
+    /* Dense chunk. */
+    u32 base = (static_cast<u32>(rnd.GetInt32()) % 4) << 16;
+    for (int i = 0; i < 20000; i++) {
+        u32 v = base + static_cast<u32>(rnd.GetInt32()) % 65536;
+        bm.Set(v);
+        ref.insert(v);
+    }
+    /* Long runs. */
+    base = (4 + static_cast<u32>(rnd.GetInt32()) % 4) << 16;
+    for (u32 v = base + seed * 100; v < base + seed * 100 + 30000; v++) {
+        bm.Set(v);
+        ref.insert(v);
+    }
+}
+
+} /* anonymous namespace */
+
+UT_TEST("Compressed bitmap")
+{
+    CompressedBitmap bm;
+    std::set<u32> ref;
+
+    CheckCompressed(bm, ref);
+    bm.Set(0);
+    bm.Set(MAX_U32);
+    bm.Set(65536);
+    bm.Set(65535);
+    ref = {0, 65535, 65536, MAX_U32};
+    CheckCompressed(bm, ref);
+    bm.Clear(65536);
+    bm.Clear(12345);
+    ref.erase(65536);
+    CheckCompressed(bm, ref);
+
+    /* Array to bitset conversion and back. */
+    bm.ClearAll();
+    ref.clear();
+    for (u32 v = 0; v < 10000; v++) {
+        bm.Set(v * 3);
+        ref.insert(v * 3);
+    }
+    CheckCompressed(bm, ref);
+    for (u32 v = 0; v < 10000; v += 2) {
+        bm.Clear(v * 3);
+        ref.erase(v * 3);
+    }
+    CheckCompressed(bm, ref);
+
+    /* Algebra against std::set reference. */
+    CompressedBitmap a, b;
+    std::set<u32> refA, refB;
+    FillCompressed(a, refA, 1);
+    FillCompressed(b, refB, 2);
+    CheckCompressed(a, refA);
+    CheckCompressed(b, refB);
+    UT_BOOL(a.Intersects(b)) == UT_TRUE;
+
+    for (int runOptimize = 0; runOptimize < 2; runOptimize++) {
+        if (runOptimize) {
+            size_t before = a.GetMemoryUsage();
+            a.RunOptimize();
+            b.RunOptimize();
+            UT(a.GetMemoryUsage() < before) == UT_TRUE;
+            CheckCompressed(a, refA);
+        }
+        std::set<u32> r;
+
+        CompressedBitmap x = a;
+        x.And(b);
+        r.clear();
+        std::set_intersection(refA.begin(), refA.end(), refB.begin(), refB.end(),
+                              std::inserter(r, r.end()));
+        CheckCompressed(x, r);
+
+        x = a;
+        x.Or(b);
+        r.clear();
+        std::set_union(refA.begin(), refA.end(), refB.begin(), refB.end(),
+                       std::inserter(r, r.end()));
+        CheckCompressed(x, r);
+
+        x = a;
+        x.Xor(b);
+        r.clear();
+        std::set_symmetric_difference(refA.begin(), refA.end(), refB.begin(), refB.end(),
+                                      std::inserter(r, r.end()));
+        CheckCompressed(x, r);
+
+        x = a;
+        x.AndNot(b);
+        r.clear();
+        std::set_difference(refA.begin(), refA.end(), refB.begin(), refB.end(),
+                            std::inserter(r, r.end()));
+        CheckCompressed(x, r);
+        UT_BOOL(x.Intersects(b)) == UT_FALSE;
+    }
+
+    /* Serialization round trip and in-place queries. */
+    std::vector<u8> data = a.Serialize();
+    UT(data.size()) == UT(a.GetSerializedSize());
+    CompressedBitmap c = CompressedBitmap::Deserialize(data.data(), data.size());
+    CheckCompressed(c, refA);
+    Random rnd(3);
+    for (int i = 0; i < 10000; i++) {
+        u32 v = i < 5000 ? static_cast<u32>(rnd.GetInt32()) : (static_cast<u32>(rnd.GetInt32()) & 0x7ffff);
+        UT_BOOL(CompressedBitmap::IsSetSerialized(data.data(), data.size(), v)) ==
+            UT_BOOL(refA.count(v) != 0);
+    }
+    for (u32 v: refA) {
+        UT_BOOL(CompressedBitmap::IsSetSerialized(data.data(), data.size(), v)) == UT_TRUE;
+    }
+
+    bool thrown = false;
+    try {
+        CompressedBitmap::Deserialize(data.data(), data.size() / 2);
+    } catch (CompressedBitmap::FormatException &) {
+        thrown = true;
+    }
+    UT_BOOL(thrown) == UT_TRUE;
+    data[0] ^= 1;
+    thrown = false;
+    try {
+        CompressedBitmap::IsSetSerialized(data.data(), data.size(), 0);
+    } catch (CompressedBitmap::FormatException &) {
+        thrown = true;
+    }
+    UT_BOOL(thrown) == UT_TRUE;
+}
+
+namespace {
+
+/** Make serialized bitmap with single container with key 0. */
+std::vector<u8>
+MakeSerializedContainer(u8 type, u32 cardinality, u32 numElements,
+                        const void *payload, size_t payloadSize)
+{
+    /* Take the header with signature from empty bitmap. */
+    std::vector<u8> data = CompressedBitmap().Serialize();
+    u32 numContainers = Le(static_cast<u32>(1));
+    memcpy(&data[4], &numContainers, sizeof(u32));
+    /* Descriptor: key, type, reserved, cardinality, number of elements,
+     * payload offset.
+     */
+    u8 desc[16] = {};
+    desc[2] = type;
+    u32 fields[3] = {Le(cardinality), Le(numElements), Le(static_cast<u32>(24))};
+    memcpy(&desc[4], fields, sizeof(fields));
+    data.insert(data.end(), desc, desc + sizeof(desc));
+    data.insert(data.end(), static_cast<const u8 *>(payload),
+                static_cast<const u8 *>(payload) + payloadSize);
+    return data;
+}
+
+bool
+IsMalformed(const std::vector<u8> &data)
+{
+    try {
+        CompressedBitmap::Deserialize(data.data(), data.size());
+    } catch (CompressedBitmap::FormatException &) {
+        return true;
+    }
+    return false;
+}
+
+} /* anonymous namespace */
+
+UT_TEST("Compressed bitmap malformed input")
+{
+    /* Valid run container is accepted and can be modified. */
+    u16 run[] = {Le(static_cast<u16>(10)), Le(static_cast<u16>(4))};
+    std::vector<u8> data = MakeSerializedContainer(2, 5, 1, run, sizeof(run));
+    CompressedBitmap bm = CompressedBitmap::Deserialize(data.data(), data.size());
+    bm.Set(100);
+    std::set<u32> ref {10, 11, 12, 13, 14, 100};
+    CheckCompressed(bm, ref);
+
+    /* Run exceeding the container range. */
+    u16 longRun[] = {Le(static_cast<u16>(65535)), Le(static_cast<u16>(65535))};
+    UT_BOOL(IsMalformed(MakeSerializedContainer(2, 65536, 1, longRun, sizeof(longRun)))) ==
+        UT_TRUE;
+    /* Overlapping runs. */
+    u16 overlapping[] = {0, Le(static_cast<u16>(9)), Le(static_cast<u16>(5)),
+                         Le(static_cast<u16>(9))};
+    UT_BOOL(IsMalformed(MakeSerializedContainer(2, 20, 2, overlapping,
+                                                sizeof(overlapping)))) == UT_TRUE;
+    /* Unsorted runs. */
+    u16 unsorted[] = {Le(static_cast<u16>(100)), 0, 0, 0};
+    UT_BOOL(IsMalformed(MakeSerializedContainer(2, 2, 2, unsorted, sizeof(unsorted)))) ==
+        UT_TRUE;
+    /* Runs length does not match the cardinality. */
+    UT_BOOL(IsMalformed(MakeSerializedContainer(2, 3, 1, run, sizeof(run)))) == UT_TRUE;
+
+    /* Array values not strictly ascending. */
+    u16 duplicates[] = {Le(static_cast<u16>(3)), Le(static_cast<u16>(3))};
+    UT_BOOL(IsMalformed(MakeSerializedContainer(0, 2, 2, duplicates, sizeof(duplicates)))) ==
+        UT_TRUE;
+    u16 descending[] = {Le(static_cast<u16>(5)), Le(static_cast<u16>(2))};
+    UT_BOOL(IsMalformed(MakeSerializedContainer(0, 2, 2, descending, sizeof(descending)))) ==
+        UT_TRUE;
+    u16 ascending[] = {Le(static_cast<u16>(2)), Le(static_cast<u16>(5))};
+    UT_BOOL(IsMalformed(MakeSerializedContainer(0, 2, 2, ascending, sizeof(ascending)))) ==
+        UT_FALSE;
+
+    /* Bitset population count does not match the cardinality. */
+    std::vector<u64> bits(65536 / 64);
+    bits[7] = Le(static_cast<u64>(0x11));
+    UT_BOOL(IsMalformed(MakeSerializedContainer(1, 3, bits.size(), bits.data(),
+                                                bits.size() * sizeof(u64)))) == UT_TRUE;
+    UT_BOOL(IsMalformed(MakeSerializedContainer(1, 2, bits.size(), bits.data(),
+                                                bits.size() * sizeof(u64)))) == UT_FALSE;
+
+    /* Empty containers. */
+    UT_BOOL(IsMalformed(MakeSerializedContainer(0, 0, 0, nullptr, 0))) == UT_TRUE;
+    UT_BOOL(IsMalformed(MakeSerializedContainer(2, 0, 0, nullptr, 0))) == UT_TRUE;
+    std::fill(bits.begin(), bits.end(), 0);
+    UT_BOOL(IsMalformed(MakeSerializedContainer(1, 0, bits.size(), bits.data(),
+                                                bits.size() * sizeof(u64)))) == UT_TRUE;
+}
@@ -0,0 +1,149 @@
+/* This file is a part of ADK library.
+ * Copyright (c) 2012-2015, Artyom Lebedev <artyom.lebedev@gmail.com>
+ * All rights reserved.
+ * See LICENSE file for copyright details.
+ */
+
+/** @file benchmark.cpp
+ * Performance benchmarks for hash functions.
+ */
+
+#include <adk.h>
+#include <adk_ut.h>
+
+using namespace adk;
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+/** Total amount of data hashed in each benchmark case. */
+const size_t TOTAL_SIZE = 16 * 1024 * 1024;
+
+/** Hash the buffer in chunks of the specified size and return throughput in
+ * GB/s. The function returns the hash value which is accumulated to prevent
+ * the calculation from being optimized out.
+ */
+template <class Func>
+double
+MeasureThroughput(const std::vector<u8> &data, size_t chunkSize, u64 &sink, Func &&func)
+{
+    size_t numChunks = data.size() / chunkSize;
+    size_t numRounds = Max<size_t>(1, TOTAL_SIZE / (numChunks * chunkSize));
+    auto start = Clock::now();
+    for (size_t round = 0; round < numRounds; round++) {
+        for (size_t i = 0; i < numChunks; i++) {
+            sink += func(&data[i * chunkSize], chunkSize);
+        }
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>
+        (Clock::now() - start);
+    return static_cast<double>(numRounds * numChunks * chunkSize) / elapsed.count();
+}
+
+const size_t chunkSizes[] = {4, 8, 16, 32, 64, 256, 4096, 1024 * 1024};
+
+} /* anonymous namespace */
+
+UT_TEST("Benchmark: Hash throughput")
+{
+    std::vector<u8> data(1024 * 1024);
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = i * 13;
+    }
+    u64 sink = 0;
+    for (size_t chunkSize: chunkSizes) {
+        double tObject = MeasureThroughput(data, chunkSize, sink,
+            [](const u8 *p, size_t size) {
+                Hash h;
+                h.Feed(p, size);
+                return h.Get64();
+            });
+        double tOneShot = MeasureThroughput(data, chunkSize, sink,
+            [](const u8 *p, size_t size) {
+                return Hash::Compute64(p, size);
+            });
+        UT_TRACE("%7zu bytes: Hash object %6.2f GB/s, Hash::Compute64 %6.2f GB/s",
+                 chunkSize, tObject, tOneShot);
+    }
+    UT_TRACE("Checksum %016llx", static_cast<unsigned long long>(sink));
+}
+
+UT_TEST("Benchmark: hash family comparison")
+{
+    std::vector<u8> data(1024 * 1024);
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = i * 13;
+    }
+    u64 sink = 0;
+    for (size_t chunkSize: chunkSizes) {
+        double tLookup3 = MeasureThroughput(data, chunkSize, sink,
+            [](const u8 *p, size_t size) {
+                return Hash::Compute64(p, size);
+            });
+        double tMum = MeasureThroughput(data, chunkSize, sink,
+            [](const u8 *p, size_t size) {
+                return MumHash::Compute64(p, size);
+            });
+        double tHash128 = MeasureThroughput(data, chunkSize, sink,
+            [](const u8 *p, size_t size) {
+                return Hash128::Compute128(p, size).low;
+            });
+        double tMumStream = MeasureThroughput(data, chunkSize, sink,
+            [](const u8 *p, size_t size) {
+                MumHash h;
+                h.Feed(p, size);
+                return h.Get64();
+            });
+        UT_TRACE("%7zu bytes: lookup3 %6.2f GB/s, MumHash %6.2f GB/s (streaming %6.2f GB/s), "
+                 "Hash128 %6.2f GB/s",
+                 chunkSize, tLookup3, tMum, tMumStream, tHash128);
+    }
+    UT_TRACE("Checksum %016llx", static_cast<unsigned long long>(sink));
+}
+
+UT_TEST("Benchmark: CRC32C throughput")
+{
+    std::vector<u8> data(1024 * 1024);
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = i * 13;
+    }
+    u64 sink = 0;
+    for (size_t chunkSize: chunkSizes) {
+        double tCrc = MeasureThroughput(data, chunkSize, sink,
+            [](const u8 *p, size_t size) {
+                return Crc32c::Compute(p, size);
+            });
+        double tSoftware = MeasureThroughput(data, chunkSize, sink,
+            [](const u8 *p, size_t size) {
+                return Crc32c::ComputeSoftware(p, size);
+            });
+        UT_TRACE("%7zu bytes: Crc32c %6.2f GB/s (%s), slicing-by-8 %6.2f GB/s",
+                 chunkSize, tCrc, Crc32c::IsHardwareAccelerated() ? "hardware" : "software",
+                 tSoftware);
+    }
+    UT_TRACE("Checksum %016llx", static_cast<unsigned long long>(sink));
+}
+
+UT_TEST("Benchmark: tree hash scaling")
+{
+    std::vector<u8> data(64 * 1024 * 1024);
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = i * 13;
+    }
+    u64 sink = 0;
+    auto measure = [&](Executor *executor) {
+        auto start = Clock::now();
+        sink += TreeHash::Compute128(data.data(), data.size(), executor).low;
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>
+            (Clock::now() - start);
+        return static_cast<double>(data.size()) / elapsed.count();
+    };
+    UT_TRACE("Serial: %6.2f GB/s", measure(nullptr));
+    int maxThreads = Max<int>(1, std::thread::hardware_concurrency());
+    for (int numThreads = 1; numThreads <= maxThreads; numThreads *= 2) {
+        ThreadPoolExecutor executor(numThreads);
+        UT_TRACE("%2d threads: %6.2f GB/s", numThreads, measure(&executor));
+    }
+    UT_TRACE("Checksum %016llx", static_cast<unsigned long long>(sink));
+}
@@ -0,0 +1,382 @@
+/* This file is a part of ADK library.
+ * Copyright (c) 2012-2015, Artyom Lebedev <artyom.lebedev@gmail.com>
+ * All rights reserved.
+ * See LICENSE file for copyright details.
+ */
+
+/** @file test.cpp
+ * Unit tests for hash functions.
+ */
+
+#include <adk.h>
+#include <adk_ut.h>
+
+using namespace adk;
+
+namespace {
+
+/** Test data with some distinguishable bytes pattern. */
+std::vector<u8>
+MakeData(size_t size)
+{
+    std::vector<u8> data(size);
+    for (size_t i = 0; i < size; i++) {
+        data[i] = i * 7 + 3;
+    }
+    return data;
+}
+
+} /* anonymous namespace */
+
+UT_TEST("Known hash values")
+{
+    struct {
+        size_t size;
+        u32 initial;
+        u64 hash;
+    } values[] = {
+        {0, 0, 0x4ceac9b277baa0d8ULL},
+        {1, 0, 0xc85cf12d2781e010ULL},
+        {5, 0, 0x83ad6cb3996a78cfULL},
+        {12, 0, 0x1d41be0dcd42e71aULL},
+        {13, 0, 0x5ffa351c2de9fe04ULL},
+        {24, 0, 0xa850281cc2962bc7ULL},
+        {37, 42, 0x7c11dfcd7bf74663ULL},
+        {100, 0, 0xa07c6868c6720e97ULL}
+    };
+    std::vector<u8> data = MakeData(100);
+    for (auto &v: values) {
+        Hash h(v.initial);
+        h.Feed(data.data(), v.size);
+        UT(h.Get64()) == UT(v.hash);
+        UT(h.Get32()) == UT(static_cast<u32>(v.hash));
+        UT(Hash::Compute64(data.data(), v.size, v.initial)) == UT(v.hash);
+        UT(Hash::Compute32(data.data(), v.size, v.initial)) == UT(static_cast<u32>(v.hash));
+    }
+}
+
+UT_TEST("Incremental hashing")
+{
+    std::vector<u8> data = MakeData(300);
+    for (size_t size = 0; size < 100; size++) {
+        /* Unaligned input as well. */
+        for (size_t offset = 0; offset < 4; offset++) {
+            const u8 *p = data.data() + offset;
+            u64 expected = Hash::Compute64(p, size, 7);
+
+            Hash h(7);
+            h.Feed(p, size);
+            UT(h.Get64()) == UT(expected);
+            UT(h.GetLength()) == UT(size);
+
+            /* Byte by byte. */
+            h.Reset(7);
+            for (size_t i = 0; i < size; i++) {
+                h.Feed(p + i, 1);
+            }
+            UT(h.Get64()) == UT(expected);
+
+            /* Arbitrary split points. */
+            for (size_t split = 0; split <= size; split += 5) {
+                h.Reset(7);
+                h.Feed(p, split);
+                h.Feed(p + split, 0);
+                h.Feed(p + split, size - split);
+                UT(h.Get64()) == UT(expected);
+            }
+        }
+    }
+}
+
+namespace {
+
+/** Dispatch command name with compile-time hashes. */
+int
+DispatchCommand(const std::string &name)
+{
+    switch (Hash::Compute32(name.data(), name.size())) {
+    case "open"_adkhash:
+        return 1;
+    case "close"_adkhash:
+        return 2;
+    case "a rather long command name spanning several blocks"_adkhash:
+        return 3;
+    default:
+        return 0;
+    }
+}
+
+} /* anonymous namespace */
+
+UT_TEST("Compile-time hash")
+{
+    constexpr u32 h = "abc"_adkhash;
+    static_assert(h == Hash::ConstCompute32("abc", 3), "Literal mismatch");
+    static_assert(""_adkhash != "\0"_adkhash, "Length should be hashed");
+    UT(h) == UT(Hash::Compute32("abc", 3));
+
+    /* All sizes around block boundaries. */
+    const char *str = "The quick brown fox jumps over the lazy dog, 0123456789";
+    for (size_t size = 0; size <= strlen(str); size++) {
+        Hash hash(5);
+        hash.Feed(str, size);
+        UT(Hash::ConstCompute32(str, size, 5)) == UT(hash.Get32());
+    }
+    const char binary[] = "\xff\x80\x01\xfe\x7f\x00\xaa\x55\xc3\x3c\x99\x66\xee";
+    for (size_t size = 0; size < sizeof(binary); size++) {
+        UT(Hash::ConstCompute32(binary, size)) == UT(Hash::Compute32(binary, size));
+    }
+
+    UT(DispatchCommand("open")) == UT(1);
+    UT(DispatchCommand("close")) == UT(2);
+    UT(DispatchCommand("a rather long command name spanning several blocks")) == UT(3);
+    UT(DispatchCommand("opened")) == UT(0);
+}
+
+namespace {
+
+/** Check that streaming calculation with arbitrary split points gives the
+ * same result as one-shot calculation.
+ */
+template <class THash, class OneShot>
+void
+CheckStreaming(OneShot oneShot)
+{
+    std::vector<u8> data = MakeData(1500);
+    for (size_t size: {0, 1, 3, 4, 7, 8, 15, 16, 17, 31, 32, 33, 63, 64, 65, 100,
+                       1023, 1024, 1025, 1400}) {
+        for (size_t offset = 0; offset < 3; offset++) {
+            const u8 *p = data.data() + offset;
+            u64 expected = oneShot(p, size, 11);
+            THash h(11);
+            h.Feed(p, size);
+            UT(h.Get64()) == UT(expected);
+            UT(h.GetLength()) == UT(size);
+            for (size_t step: {1, 5, 31, 64, 97}) {
+                h.Reset(11);
+                for (size_t i = 0; i < size; i += step) {
+                    h.Feed(p + i, Min(step, size - i));
+                }
+                UT(h.Get64()) == UT(expected);
+            }
+            UT(oneShot(p, size, 12) != expected) == UT_TRUE;
+        }
+    }
+}
+
+/** Check that flipping any input bit changes about half of the hash bits. */
+template <class OneShot>
+void
+CheckAvalanche(OneShot oneShot, size_t size)
+{
+    std::vector<u8> data = MakeData(size);
+    u64 base = oneShot(data.data(), size, 0);
+    size_t totalFlips = 0;
+    for (size_t bit = 0; bit < size * NBBY; bit++) {
+        data[bit / NBBY] ^= 1 << (bit % NBBY);
+        totalFlips += CountOnes(oneShot(data.data(), size, 0) ^ base);
+        data[bit / NBBY] ^= 1 << (bit % NBBY);
+    }
+    double avg = static_cast<double>(totalFlips) / (size * NBBY);
+    UT_TRACE("%zu bytes input: %.2f bits changed on average", size, avg);
+    UT(avg > 28.0 && avg < 36.0) == UT_TRUE;
+}
+
+} /* anonymous namespace */
+
+UT_TEST("MumHash")
+{
+    auto oneShot = [](const void *data, size_t size, u64 seed) {
+        return MumHash::Compute64(data, size, seed);
+    };
+    CheckStreaming<MumHash>(oneShot);
+    for (size_t size: {1, 8, 13, 40, 200}) {
+        CheckAvalanche(oneShot, size);
+    }
+    std::vector<u8> data = MakeData(100);
+    UT(MumHash::Compute64(data.data(), 0)) == UT(static_cast<u64>(0xa35626bcd9704a76));
+    UT(MumHash::Compute64(data.data(), 5)) == UT(static_cast<u64>(0x5aee1f0c20976174));
+    UT(MumHash::Compute64(data.data(), 100, 42)) == UT(static_cast<u64>(0x459625c61d0800cc));
+}
+
+UT_TEST("Hash128")
+{
+    auto oneShot = [](const void *data, size_t size, u64 seed) {
+        return Hash128::Compute128(data, size, seed).low;
+    };
+    CheckStreaming<Hash128>(oneShot);
+    for (size_t size: {1, 8, 13, 40, 200}) {
+        CheckAvalanche(oneShot, size);
+        CheckAvalanche([](const void *data, size_t size, u64 seed) {
+            return Hash128::Compute128(data, size, seed).high;
+        }, size);
+    }
+    std::vector<u8> data = MakeData(2000);
+    Hash128 h;
+    h.Feed(data.data(), 1500);
+    UT_BOOL(h.Get128() == Hash128::Compute128(data.data(), 1500)) == UT_TRUE;
+    UT(h.Get128().high) == UT(static_cast<u64>(0x7f77ec7006bd66b7));
+    UT(Hash128::Compute128(data.data(), 0).low) == UT(static_cast<u64>(0x71eca2c84f5c1e11));
+    UT(Hash128::Compute128(data.data(), 2000, 42).low) == UT(static_cast<u64>(0x734f2bc451804103));
+}
+
+namespace {
+
+/** Bitwise reference CRC-32C implementation. */
+u32
+ReferenceCrc32c(const u8 *data, size_t size)
+{
+    u32 crc = ~static_cast<u32>(0);
+    for (size_t i = 0; i < size; i++) {
+        crc ^= data[i];
+        for (int k = 0; k < 8; k++) {
+            crc = crc & 1 ? (crc >> 1) ^ 0x82f63b78 : crc >> 1;
+        }
+    }
+    return ~crc;
+}
+
+} /* anonymous namespace */
+
+UT_TEST("CRC32C")
+{
+    UT_TRACE("Hardware acceleration: %s", Crc32c::IsHardwareAccelerated() ? "yes" : "no");
+
+    /* Test vectors from RFC 3720. */
+    u8 buf[32];
+    memset(buf, 0, sizeof(buf));
+    UT(Crc32c::Compute(buf, sizeof(buf))) == UT(static_cast<u32>(0x8a9136aa));
+    memset(buf, 0xff, sizeof(buf));
+    UT(Crc32c::Compute(buf, sizeof(buf))) == UT(static_cast<u32>(0x62a8ab43));
+    for (size_t i = 0; i < sizeof(buf); i++) {
+        buf[i] = i;
+    }
+    UT(Crc32c::Compute(buf, sizeof(buf))) == UT(static_cast<u32>(0x46dd794e));
+    UT(Crc32c::ComputeSoftware(buf, sizeof(buf))) == UT(static_cast<u32>(0x46dd794e));
+    UT(Crc32c::Compute("123456789", 9)) == UT(static_cast<u32>(0xe3069283));
+    UT(Crc32c::Compute(buf, 0)) == UT(static_cast<u32>(0));
+
+    /* Sizes covering all interleaved blocks paths. */
+    std::vector<u8> data(100000);
+    Random rnd(1);
+    for (u8 &b: data) {
+        b = rnd.GetInt32();
+    }
+    for (size_t size: {1, 7, 8, 9, 100, 767, 768, 769, 1000, 24575, 24576, 24577, 30000,
+                       99990}) {
+        for (size_t offset = 0; offset < 3; offset++) {
+            const u8 *p = data.data() + offset;
+            u32 expected = ReferenceCrc32c(p, size);
+            UT(Crc32c::Compute(p, size)) == UT(expected);
+            UT(Crc32c::ComputeSoftware(p, size)) == UT(expected);
+
+            size_t split = size / 3;
+            Crc32c crc;
+            crc.Feed(p, split);
+            u32 crc1 = crc.Get32();
+            crc.Feed(p + split, size - split);
+            UT(crc.Get32()) == UT(expected);
+            UT(crc.GetLength()) == UT(size);
+            UT(Crc32c::Compute(p + split, size - split, crc1)) == UT(expected);
+
+            u32 crc2 = Crc32c::Compute(p + split, size - split);
+            UT(Crc32c::Combine(crc1, crc2, size - split)) == UT(expected);
+        }
+    }
+    UT(Crc32c::Combine(Crc32c::Compute(data.data(), 10), Crc32c::Compute(data.data(), 0), 0)) ==
+        UT(Crc32c::Compute(data.data(), 10));
+}
+
+UT_TEST("Tree hash")
+{
+    const size_t leafSize = 4096;
+    std::vector<u8> data(leafSize * 37 + 123);
+    Random rnd(3);
+    for (u8 &b: data) {
+        b = rnd.GetInt32();
+    }
+
+    Hash128::Value expected = TreeHash::Compute128(data.data(), data.size(), nullptr, leafSize);
+
+    /* Result does not depend on number of threads. */
+    for (int numThreads: {1, 3, 8}) {
+        ThreadPoolExecutor executor(numThreads);
+        UT_BOOL(TreeHash::Compute128(data.data(), data.size(), &executor, leafSize) ==
+                expected) == UT_TRUE;
+    }
+
+    /* Result does not depend on data split between Feed() calls. */
+    ThreadPoolExecutor executor(4);
+    for (size_t split: {static_cast<size_t>(1), leafSize - 1, leafSize, leafSize + 1,
+                        leafSize * 10 + 7, data.size()}) {
+        TreeHash hash(&executor, leafSize);
+        for (size_t offset = 0; offset < data.size(); offset += split) {
+            hash.Feed(&data[offset], Min(split, data.size() - offset));
+        }
+        UT(hash.GetLength()) == UT(data.size());
+        UT_BOOL(hash.Get128() == expected) == UT_TRUE;
+        UT(hash.Get64()) == UT(expected.low);
+    }
+
+    /* Actions dropped by terminated executor are hashed by the caller. */
+    ThreadPoolExecutor terminated(2);
+    terminated.Terminate();
+    UT_BOOL(TreeHash::Compute128(data.data(), data.size(), &terminated, leafSize) ==
+            expected) == UT_TRUE;
+
+    /* Executor failing to submit. */
+    class FailingExecutor: public Executor {
+    public:
+        ThreadPoolExecutor pool {2};
+        int numAccepted = 5;
+
+        void
+        Submit(const Action &action) override
+        {
+            if (!numAccepted) {
+                throw std::runtime_error("Queue full");
+            }
+            numAccepted--;
+            pool.Submit(action);
+        }
+    } failing;
+    UT_BOOL(TreeHash::Compute128(data.data(), data.size(), &failing, leafSize) ==
+            expected) == UT_TRUE;
+
+    /* Feeding from the only thread of the executor. */
+    ThreadPoolExecutor single(1);
+    Hash128::Value result;
+    std::atomic<bool> isDone(false);
+    single.Submit([&]() {
+        result = TreeHash::Compute128(data.data(), data.size(), &single, leafSize);
+        isDone = true;
+    });
+    while (!isDone) {
+        std::this_thread::yield();
+    }
+    UT_BOOL(result == expected) == UT_TRUE;
+
+    /* Parameters affect the result. */
+    UT_BOOL(TreeHash::Compute128(data.data(), data.size(), nullptr, leafSize * 2) ==
+            expected) == UT_FALSE;
+    UT_BOOL(TreeHash::Compute128(data.data(), data.size(), nullptr, leafSize, 1) ==
+            expected) == UT_FALSE;
+    /* Leaves boundaries and length are committed to. */
+    UT_BOOL(TreeHash::Compute128(data.data(), leafSize * 2, nullptr, leafSize) ==
+            TreeHash::Compute128(data.data(), leafSize * 2 + 1, nullptr, leafSize)) == UT_FALSE;
+    UT_BOOL(TreeHash::Compute128(data.data(), 0, nullptr, leafSize) ==
+            TreeHash::Compute128(data.data(), leafSize, nullptr, leafSize)) == UT_FALSE;
+
+    TreeHash hash(nullptr, leafSize);
+    hash.Feed(data.data(), 100);
+    hash.Reset();
+    UT_BOOL(hash.Get128() == TreeHash::Compute128(nullptr, 0, nullptr, leafSize)) == UT_TRUE;
+
+    bool thrown = false;
+    try {
+        TreeHash invalid(nullptr, 0);
+    } catch (InvalidParamException &) {
+        thrown = true;
+    }
+    UT_BOOL(thrown) == UT_TRUE;
+}
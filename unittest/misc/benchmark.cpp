@@ -0,0 +1,233 @@
+/* This file is a part of ADK library.
+ * Copyright (c) 2012-2015, Artyom Lebedev <artyom.lebedev@gmail.com>
+ * All rights reserved.
+ * See LICENSE file for copyright details.
+ */
+
+/** @file benchmark.cpp
+ * Performance benchmarks for miscellaneous containers and random generators.
+ */
+
+#include <adk.h>
+#include <adk_ut.h>
+
+using namespace adk;
+
+namespace {
+
+/** Item for intrusive RB map. */
+struct RBItem {
+    u64 key, value;
+    RBTreeEntry entry;
+};
+
+} /* anonymous namespace */
+
+UT_TEST("Benchmark: B-tree vs RB-tree and std::map")
+{
+    const size_t n = 1000000;
+    std::vector<RBItem> items(n);
+    std::vector<u64> keys(n);
+    Xoshiro256 rnd(1);
+    for (size_t i = 0; i < n; i++) {
+        items[i].key = keys[i] = rnd.GetInt64();
+        items[i].value = i;
+    }
+    std::shuffle(keys.begin(), keys.end(), rnd);
+
+    typedef std::chrono::steady_clock Clock;
+    auto Measure = [&](const char *name, const std::function<void()> &func) {
+        auto start = Clock::now();
+        func();
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>
+            (Clock::now() - start);
+        UT_TRACE("%s: %.1f ns/item", name, static_cast<double>(elapsed.count()) / n);
+    };
+
+    BTreeMap<u64, u64> bTree;
+    RBMap<u64, RBItem, &RBItem::key, &RBItem::entry> rbTree;
+    std::map<u64, u64> stdMap;
+    u64 sum = 0;
+    Measure("BTreeMap insert", [&]() {
+        for (RBItem &item: items) {
+            bTree.Insert(item.key, item.value);
+        }
+    });
+    Measure("RBMap insert", [&]() {
+        for (RBItem &item: items) {
+            rbTree.Insert(item);
+        }
+    });
+    Measure("std::map insert", [&]() {
+        for (RBItem &item: items) {
+            stdMap.emplace(item.key, item.value);
+        }
+    });
+    Measure("BTreeMap lookup", [&]() {
+        for (u64 key: keys) {
+            sum += bTree.Find(key).GetValue();
+        }
+    });
+    Measure("RBMap lookup", [&]() {
+        for (u64 key: keys) {
+            sum += rbTree.Find(key)->value;
+        }
+    });
+    Measure("std::map lookup", [&]() {
+        for (u64 key: keys) {
+            sum += stdMap.find(key)->second;
+        }
+    });
+    Measure("BTreeMap scan", [&]() {
+        for (auto item: bTree) {
+            sum += item.second;
+        }
+    });
+    Measure("RBMap scan", [&]() {
+        for (RBItem &item: rbTree) {
+            sum += item.value;
+        }
+    });
+    Measure("std::map scan", [&]() {
+        for (auto &p: stdMap) {
+            sum += p.second;
+        }
+    });
+    UT_TRACE("BTreeMap memory %zu bytes, height %zu; std::map nodes %zu bytes",
+             bTree.GetMemoryUsage(), bTree.GetHeight(),
+             n * (sizeof(std::pair<const u64, u64>) + 4 * sizeof(void *)));
+
+    std::vector<std::pair<u64, u64>> sorted(stdMap.begin(), stdMap.end());
+    Measure("BTreeMap bulk load", [&]() {
+        bTree.Assign(sorted.begin(), sorted.end());
+    });
+    UT_TRACE("Bulk loaded memory %zu bytes", bTree.GetMemoryUsage());
+    UT_TRACE("Checksum %llu", static_cast<unsigned long long>(sum));
+}
+
+UT_TEST("Benchmark: intrusive RB map")
+{
+    const size_t n = 1000000;
+    std::vector<RBItem> items(n);
+    std::vector<u64> keys(n);
+    Xoshiro256 rnd(1);
+    for (size_t i = 0; i < n; i++) {
+        items[i].key = keys[i] = rnd.GetInt64();
+        items[i].value = i;
+    }
+    typedef std::chrono::steady_clock Clock;
+    auto Measure = [&](const char *name, const std::function<void()> &func) {
+        auto start = Clock::now();
+        func();
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>
+            (Clock::now() - start);
+        UT_TRACE("%s: %.1f ns/item", name, static_cast<double>(elapsed.count()) / n);
+    };
+
+    RBMap<u64, RBItem, &RBItem::key, &RBItem::entry> map;
+    std::map<u64, RBItem *> stdMap;
+    u64 sum = 0;
+    Measure("RBMap insert", [&]() {
+        for (RBItem &item: items) {
+            map.Insert(item);
+        }
+    });
+    Measure("std::map insert", [&]() {
+        for (RBItem &item: items) {
+            stdMap.emplace(item.key, &item);
+        }
+    });
+    Measure("RBMap find", [&]() {
+        for (u64 key: keys) {
+            sum += map.Find(key)->value;
+        }
+    });
+    Measure("std::map find", [&]() {
+        for (u64 key: keys) {
+            sum += stdMap.find(key)->second->value;
+        }
+    });
+    Measure("RBMap scan", [&]() {
+        for (RBItem &item: map) {
+            sum += item.key;
+        }
+    });
+    Measure("std::map scan", [&]() {
+        for (auto &p: stdMap) {
+            sum += p.first;
+        }
+    });
+    Measure("RBMap erase", [&]() {
+        while (!map.IsEmpty()) {
+            map.Erase(map.begin());
+        }
+    });
+    Measure("std::map erase", [&]() {
+        while (!stdMap.empty()) {
+            stdMap.erase(stdMap.begin());
+        }
+    });
+    std::sort(items.begin(), items.end(), [](const RBItem &a, const RBItem &b) {
+        return a.key < b.key;
+    });
+    Measure("RBMap bulk build", [&]() {
+        map.Assign(items.begin(), items.end());
+    });
+    UT_TRACE("Checksum %llu", static_cast<unsigned long long>(sum));
+}
+
+UT_TEST("Benchmark: bulk random fill")
+{
+    /* Buffer fits in cache, so generation speed rather than memory
+     * bandwidth is measured.
+     */
+    const size_t n = 64 * 1024, numRounds = 256;
+    std::vector<double> d(n);
+    typedef std::chrono::steady_clock Clock;
+    auto Measure = [&](const std::function<void()> &func) {
+        auto start = Clock::now();
+        for (size_t round = 0; round < numRounds; round++) {
+            func();
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>
+            (Clock::now() - start);
+        return static_cast<double>(elapsed.count()) / (n * numRounds);
+    };
+    Random rnd(1);
+    UT_TRACE("Random::GetDouble: %.2f ns/value", Measure([&]() {
+        for (double &x: d) {
+            x = rnd.GetDouble();
+        }
+    }));
+    Xoshiro256 xoshiro(1);
+    UT_TRACE("Xoshiro256::GetDouble: %.2f ns/value", Measure([&]() {
+        for (double &x: d) {
+            x = xoshiro.GetDouble();
+        }
+    }));
+    BulkRandom bulk(1);
+    UT_TRACE("BulkRandom::FillDoubles: %.2f ns/value", Measure([&]() {
+        bulk.FillDoubles(d.data(), n);
+    }));
+    UT_TRACE("Random::GetGaussian: %.2f ns/value", Measure([&]() {
+        for (double &x: d) {
+            x = rnd.GetGaussian(0, 1);
+        }
+    }));
+    UT_TRACE("Xoshiro256::GetGaussian: %.2f ns/value", Measure([&]() {
+        for (double &x: d) {
+            x = xoshiro.GetGaussian(0, 1);
+        }
+    }));
+    UT_TRACE("Box-Muller: %.2f ns/value", Measure([&]() {
+        for (size_t i = 0; i < n; i += 2) {
+            double r = sqrt(-2.0 * log(1.0 - xoshiro.GetDouble()));
+            double theta = xoshiro.GetDouble() * M_PI * 2.0;
+            d[i] = r * cos(theta);
+            d[i + 1] = r * sin(theta);
+        }
+    }));
+    UT_TRACE("BulkRandom::FillGaussian: %.2f ns/value", Measure([&]() {
+        bulk.FillGaussian(d.data(), n);
+    }));
+}
@@ -0,0 +1,279 @@
+/* This file is a part of ADK library.
+ * Copyright (c) 2012-2015, Artyom Lebedev <artyom.lebedev@gmail.com>
+ * All rights reserved.
+ * See LICENSE file for copyright details.
+ */
+
+/** @file btree.cpp
+ * Tests for B+-tree containers.
+ */
+
+#include <adk.h>
+#include <adk_ut.h>
+
+using namespace adk;
+
+namespace {
+
+/** Check that the map has the same content as the reference one. */
+template <class TMap, class TRefMap>
+void
+CheckMap(const TMap &map, const TRefMap &ref)
+{
+    UT_BOOL(map.Validate()) == UT_TRUE;
+    UT(map.Size()) == UT(ref.size());
+    auto refIt = ref.begin();
+    for (auto item: map) {
+        UT_BOOL(refIt == ref.end()) == UT_FALSE;
+        UT_BOOL(item.first == refIt->first) == UT_TRUE;
+        UT_BOOL(item.second == refIt->second) == UT_TRUE;
+        ++refIt;
+    }
+    UT_BOOL(refIt == ref.end()) == UT_TRUE;
+}
+
+/** Random insertions and deletions compared with std::map. */
+template <class TKey, size_t nodeSize>
+void
+TestRandom(size_t numOps, u64 keyRange, TKey keyBase)
+{
+    BTreeMap<TKey, u32, std::less<TKey>, nodeSize> map;
+    std::map<TKey, u32> ref;
+    Xoshiro256 rnd(numOps);
+    for (size_t i = 0; i < numOps; i++) {
+        TKey key = keyBase + static_cast<TKey>(rnd.GetInt64() % keyRange);
+        u32 value = i;
+        /* More insertions first to grow the tree, then shrink it. */
+        bool insert = rnd.GetInt64() % 100 < (i < numOps / 2 ? 70 : 30);
+        if (insert) {
+            bool inserted = map.Insert(key, value).second;
+            UT_BOOL(inserted) == UT_BOOL(ref.emplace(key, value).second);
+        } else {
+            UT(map.Erase(key)) == UT(ref.erase(key));
+        }
+        UT_BOOL(map.Contains(key)) == UT_BOOL(ref.count(key) != 0);
+        if (i % (numOps / 16) == 0) {
+            CheckMap(map, ref);
+        }
+    }
+    CheckMap(map, ref);
+    UT_TRACE("Node size %zu: %zu items, height %zu, %zu bytes", nodeSize, map.Size(),
+             map.GetHeight(), map.GetMemoryUsage());
+
+    /* Bounds search for keys both present and missing. */
+    for (size_t i = 0; i < 1000; i++) {
+        TKey key = keyBase + static_cast<TKey>(rnd.GetInt64() % (keyRange + 2)) - 1;
+        auto it = map.LowerBound(key);
+        auto refIt = ref.lower_bound(key);
+        UT_BOOL(it == map.end()) == UT_BOOL(refIt == ref.end());
+        if (refIt != ref.end()) {
+            UT_BOOL(it.GetKey() == refIt->first) == UT_TRUE;
+        }
+        it = map.UpperBound(key);
+        refIt = ref.upper_bound(key);
+        UT_BOOL(it == map.end()) == UT_BOOL(refIt == ref.end());
+        if (refIt != ref.end()) {
+            UT_BOOL(it.GetKey() == refIt->first) == UT_TRUE;
+        }
+    }
+
+    while (!map.IsEmpty()) {
+        map.Erase(map.begin());
+    }
+    UT_BOOL(map.Validate()) == UT_TRUE;
+    UT(map.GetHeight()) == UT(static_cast<size_t>(0));
+}
+
+} /* anonymous namespace */
+
+UT_TEST("B-tree map")
+{
+    BTreeMap<int, int> map;
+    UT_BOOL(map.IsEmpty()) == UT_TRUE;
+    UT_BOOL(map.begin() == map.end()) == UT_TRUE;
+    UT_BOOL(map.Find(1) == map.end()) == UT_TRUE;
+    UT_BOOL(map.LowerBound(1) == map.end()) == UT_TRUE;
+    UT(map.Erase(1)) == UT(static_cast<size_t>(0));
+
+    /* Descending insertion splits leftmost nodes. */
+    for (int i = 1000; i > 0; i--) {
+        UT_BOOL(map.Insert(i, -i).second) == UT_TRUE;
+    }
+    UT_BOOL(map.Insert(500, 0).second) == UT_FALSE;
+    UT(map.At(500)) == UT(-500);
+    map[500] = 5;
+    UT(map.At(500)) == UT(5);
+    UT(map[2000]) == UT(0);
+    UT(map.Size()) == UT(static_cast<size_t>(1001));
+    UT_BOOL(map.Validate()) == UT_TRUE;
+    UT_BOOL(map.GetHeight() > 1) == UT_TRUE;
+
+    bool thrown = false;
+    try {
+        map.At(3000);
+    } catch (InvalidParamException &) {
+        thrown = true;
+    }
+    UT_BOOL(thrown) == UT_TRUE;
+
+    /* Range iteration both directions. */
+    int expected = 100;
+    for (auto it = map.LowerBound(100); it != map.UpperBound(200); ++it) {
+        UT(it.GetKey()) == UT(expected);
+        expected++;
+    }
+    UT(expected) == UT(201);
+    auto it = map.end();
+    --it;
+    UT(it.GetKey()) == UT(2000);
+    --it;
+    UT(it.GetKey()) == UT(1000);
+    for (int i = 999; i > 0; i--) {
+        --it;
+        UT(it.GetKey()) == UT(i);
+    }
+    UT_BOOL(it == map.begin()) == UT_TRUE;
+
+    /* Copy and move. */
+    const BTreeMap<int, int> copy(map);
+    UT_BOOL(copy.Validate()) == UT_TRUE;
+    UT(copy.Size()) == UT(map.Size());
+    UT(copy.At(500)) == UT(5);
+    BTreeMap<int, int>::const_iterator cit = copy.Find(10);
+    UT((*cit).second) == UT(-10);
+    BTreeMap<int, int> moved(std::move(map));
+    UT_BOOL(map.IsEmpty()) == UT_TRUE;
+    UT_BOOL(map.Validate()) == UT_TRUE;
+    UT(moved.Size()) == UT(copy.Size());
+    map = moved;
+    moved.Clear();
+    UT_BOOL(moved.Validate()) == UT_TRUE;
+    UT(map.At(10)) == UT(-10);
+
+    /* Ascending insertion after clearing. */
+    map.Clear();
+    for (int i = 0; i < 1000; i++) {
+        map.Insert(i, i);
+    }
+    UT_BOOL(map.Validate()) == UT_TRUE;
+    for (auto item: map) {
+        item.second *= 2;
+    }
+    UT(map.At(300)) == UT(600);
+}
+
+UT_TEST("B-tree random operations")
+{
+    TestRandom<u64, 256>(100000, 5000, 0);
+    TestRandom<u32, 128>(100000, 5000, 0);
+    TestRandom<i64, 512>(100000, 5000, -2500);
+    TestRandom<i32, 64>(100000, 2000, -1000);
+    /* Unsigned keys with the high bit set for SIMD comparison. */
+    TestRandom<u64, 256>(50000, 5000, ~static_cast<u64>(0) - 2600);
+    TestRandom<u32, 256>(50000, 5000, 0x7fffffff - 2500);
+}
+
+UT_TEST("B-tree set")
+{
+    /* Arbitrary key type and comparator. */
+    BTreeSet<double, std::greater<double>> set;
+    std::set<double, std::greater<double>> ref;
+    Xoshiro256 rnd(3);
+    for (int i = 0; i < 20000; i++) {
+        double key = rnd.GetInt64() % 10000 / 8.0;
+        if (i % 3) {
+            UT_BOOL(set.Insert(key).second) == UT_BOOL(ref.insert(key).second);
+        } else {
+            UT(set.Erase(key)) == UT(ref.erase(key));
+        }
+    }
+    UT_BOOL(set.Validate()) == UT_TRUE;
+    UT(set.Size()) == UT(ref.size());
+    UT_BOOL(std::equal(set.begin(), set.end(), ref.begin())) == UT_TRUE;
+    UT_BOOL(*set.LowerBound(10000) == *ref.begin()) == UT_TRUE;
+    UT_BOOL(*set.LowerBound(100.01) == *ref.lower_bound(100.01)) == UT_TRUE;
+}
+
+UT_TEST("B-tree bulk load")
+{
+    for (size_t n: {0, 1, 2, 30, 31, 32, 33, 1000, 100000}) {
+        std::vector<std::pair<u64, u64>> items(n);
+        for (size_t i = 0; i < n; i++) {
+            items[i] = std::make_pair(i * 3, i);
+        }
+        BTreeMap<u64, u64> map(items.begin(), items.end());
+        UT_BOOL(map.Validate()) == UT_TRUE;
+        UT(map.Size()) == UT(n);
+        size_t i = 0;
+        for (auto item: map) {
+            UT(item.first) == UT(static_cast<u64>(i * 3));
+            UT(item.second) == UT(static_cast<u64>(i));
+            i++;
+        }
+        UT(i) == UT(n);
+        if (!n) {
+            continue;
+        }
+        /* Modifications after bulk load. */
+        for (size_t i = 0; i < n; i += 2) {
+            map.Insert(i * 3 + 1, 0);
+        }
+        for (size_t i = 0; i < n; i += 3) {
+            map.Erase(i * 3);
+        }
+        UT_BOOL(map.Validate()) == UT_TRUE;
+        UT(map.Size()) == UT(n + (n + 1) / 2 - (n + 2) / 3);
+    }
+
+    std::vector<i32> keys;
+    for (i32 i = -5000; i < 5000; i += 7) {
+        keys.push_back(i);
+    }
+    BTreeSet<i32, std::less<i32>, 128> set;
+    set.Assign(keys.begin(), keys.end());
+    UT_BOOL(set.Validate()) == UT_TRUE;
+    UT_BOOL(std::equal(set.begin(), set.end(), keys.begin())) == UT_TRUE;
+    UT(*set.LowerBound(-4999)) == UT(-4993);
+    UT(*set.UpperBound(-5000)) == UT(-4993);
+    UT_BOOL(set.UpperBound(keys.back()) == set.end()) == UT_TRUE;
+}
+
+UT_TEST("B-tree iterator traits")
+{
+    typedef BTreeMap<int, int> Map;
+    typedef std::iterator_traits<Map::iterator> MapTraits;
+    static_assert(std::is_same<MapTraits::value_type, std::pair<const int, int>>::value,
+                  "Map value type");
+    static_assert(std::is_same<MapTraits::iterator_category,
+                               std::bidirectional_iterator_tag>::value,
+                  "Map iterator category");
+    typedef std::iterator_traits<BTreeSet<int>::const_iterator> SetTraits;
+    static_assert(std::is_same<SetTraits::value_type, int>::value, "Set value type");
+    static_assert(std::is_same<SetTraits::pointer, const int *>::value, "Set pointer type");
+
+    Map map;
+    for (int i = 0; i < 100; i++) {
+        map.Insert(i, i * 2);
+    }
+    Map::iterator it = map.Find(10);
+    UT(it->first) == UT(10);
+    it->second = 5;
+    UT(map.At(10)) == UT(5);
+    UT(std::distance(map.begin(), map.end())) == UT(static_cast<std::ptrdiff_t>(100));
+    const Map &constMap = map;
+    auto n = std::count_if(constMap.begin(), constMap.end(), [](const MapTraits::value_type &v) {
+        return v.second % 4 == 0;
+    });
+    UT(n) == UT(static_cast<std::ptrdiff_t>(49));
+    std::vector<MapTraits::value_type> items(map.begin(), map.end());
+    UT(items.size()) == UT_SIZE(100);
+    UT(items[10].second) == UT(5);
+
+    BTreeSet<int> set;
+    for (int i = 0; i < 100; i++) {
+        set.Insert(i * 3);
+    }
+    BTreeSet<int>::const_iterator sit = set.LowerBound(10);
+    UT(*sit.operator ->()) == UT(12);
+    UT(*std::max_element(set.begin(), set.end())) == UT(297);
+}
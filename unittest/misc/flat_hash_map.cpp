@@ -0,0 +1,351 @@
+/* This file is a part of ADK library.
+ * Copyright (c) 2012-2015, Artyom Lebedev <artyom.lebedev@gmail.com>
+ * All rights reserved.
+ * See LICENSE file for copyright details.
+ */
+
+/** @file flat_hash_map.cpp
+ * Tests for FlatHashMap and FlatHashSet classes.
+ */
+
+#include <adk.h>
+#include <adk_ut.h>
+
+using namespace adk;
+
+namespace {
+
+/** Key which counts its instances creation. */
+struct CountedKey {
+    static int numCreated;
+
+    std::string value;
+
+    CountedKey(StringView value):
+        value(value.ToString())
+    {
+        numCreated++;
+    }
+
+    CountedKey(const CountedKey &other):
+        value(other.value)
+    {
+        numCreated++;
+    }
+
+    CountedKey(CountedKey &&other) = default;
+};
+
+int CountedKey::numCreated = 0;
+
+struct CountedKeyHash {
+    typedef void is_transparent;
+
+    u64
+    operator()(StringView s) const
+    {
+        return Hash::Compute64(s.data(), s.size());
+    }
+
+    u64
+    operator()(const CountedKey &key) const
+    {
+        return (*this)(StringView(key.value));
+    }
+};
+
+struct CountedKeyEqual {
+    typedef void is_transparent;
+
+    bool
+    operator()(const CountedKey &a, StringView b) const
+    {
+        return StringView(a.value) == b;
+    }
+
+    bool
+    operator()(const CountedKey &a, const CountedKey &b) const
+    {
+        return a.value == b.value;
+    }
+};
+
+/** Hasher with many collisions to stress probing. */
+struct BadHash {
+    u64
+    operator()(int x) const
+    {
+        return x % 7;
+    }
+};
+
+/** Allocator with state which tracks outstanding allocations per arena. */
+template <typename T, bool propagate>
+struct ArenaAllocator {
+    typedef T value_type;
+    typedef std::integral_constant<bool, propagate> propagate_on_container_move_assignment;
+
+    template <typename U>
+    struct rebind {
+        typedef ArenaAllocator<U, propagate> other;
+    };
+
+    static int numAllocated[2];
+
+    int arena;
+
+    ArenaAllocator(int arena):
+        arena(arena)
+    {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U, propagate> &other):
+        arena(other.arena)
+    {}
+
+    T *
+    allocate(size_t n)
+    {
+        numAllocated[arena]++;
+        return std::allocator<T>().allocate(n);
+    }
+
+    void
+    deallocate(T *p, size_t n)
+    {
+        numAllocated[arena]--;
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template <typename U>
+    bool
+    operator ==(const ArenaAllocator<U, propagate> &other) const
+    {
+        return arena == other.arena;
+    }
+
+    template <typename U>
+    bool
+    operator !=(const ArenaAllocator<U, propagate> &other) const
+    {
+        return arena != other.arena;
+    }
+};
+
+template <typename T, bool propagate>
+int ArenaAllocator<T, propagate>::numAllocated[2];
+
+template <bool propagate>
+void
+TestMoveAssignment()
+{
+    typedef ArenaAllocator<std::pair<const int, std::string>, propagate> Alloc;
+    typedef FlatHashMap<int, std::string, DefaultHash<int>, DefaultEqual<int>, Alloc> Map;
+    {
+        Map a(0, DefaultHash<int>(), DefaultEqual<int>(), Alloc(0));
+        Map b(0, DefaultHash<int>(), DefaultEqual<int>(), Alloc(1));
+        for (int i = 0; i < 100; i++) {
+            b.TryEmplace(i, std::to_string(i));
+        }
+        a.TryEmplace(1000, "x");
+        a = std::move(b);
+        UT(a.Size()) == UT_SIZE(100);
+        UT(b.Size()) == UT_SIZE(0);
+        for (int i = 0; i < 100; i++) {
+            UT_BOOL(a.Find(i)->second == std::to_string(i)) == UT_TRUE;
+        }
+        UT_BOOL(a.Contains(1000)) == UT_FALSE;
+        /* Storage is either taken along with the allocator or reallocated by
+         * the target allocator.
+         */
+        UT(Alloc::numAllocated[propagate ? 0 : 1]) == UT(0);
+        b.TryEmplace(1, "y");
+        b = a;
+        UT(b.Size()) == UT_SIZE(100);
+    }
+    UT(Alloc::numAllocated[0]) == UT(0);
+    UT(Alloc::numAllocated[1]) == UT(0);
+}
+
+template <class Map>
+void
+CheckSame(const Map &map, const std::unordered_map<int, int> &ref)
+{
+    UT(map.Size()) == UT(ref.size());
+    size_t count = 0;
+    for (auto &e: map) {
+        auto it = ref.find(e.first);
+        UT_BOOL(it != ref.end()) == UT_TRUE;
+        UT(e.second) == UT(it->second);
+        count++;
+    }
+    UT(count) == UT(ref.size());
+    for (auto &e: ref) {
+        auto it = map.Find(e.first);
+        UT_BOOL(it != map.end()) == UT_TRUE;
+        UT(it->second) == UT(e.second);
+    }
+}
+
+template <class Map>
+void
+TestRandomOps(int keyRange)
+{
+    Map map;
+    std::unordered_map<int, int> ref;
+    Random rnd(keyRange);
+    for (int i = 0; i < 20000; i++) {
+        int key = static_cast<u32>(rnd.GetInt32()) % keyRange;
+        switch (static_cast<u32>(rnd.GetInt32()) % 4) {
+        case 0:
+        case 1: {
+            auto res = map.TryEmplace(key, i);
+            UT_BOOL(res.second) == UT_BOOL(ref.emplace(key, i).second);
+            UT(res.first->second) == UT(ref[key]);
+            break;
+        }
+        case 2:
+            UT(map.Erase(key)) == UT(ref.erase(key));
+            break;
+        case 3:
+            UT_BOOL(map.Contains(key)) == UT_BOOL(ref.count(key) != 0);
+            break;
+        }
+        /* Load factor limit is kept. */
+        UT(map.Size() <= map.Capacity() - map.Capacity() / 8) == UT_TRUE;
+    }
+    CheckSame(map, ref);
+
+    /* Erase everything through iterators. */
+    while (!map.IsEmpty()) {
+        map.Erase(map.begin());
+    }
+    UT_BOOL(map.begin() == map.end()) == UT_TRUE;
+    UT_BOOL(map.Contains(0)) == UT_FALSE;
+}
+
+} /* anonymous namespace */
+
+UT_TEST("FlatHashMap basic operations")
+{
+    FlatHashMap<int, int> map;
+    UT_BOOL(map.IsEmpty()) == UT_TRUE;
+    UT_BOOL(map.Find(1) == map.end()) == UT_TRUE;
+    UT(map.Erase(1)) == UT(static_cast<size_t>(0));
+    UT_BOOL(map.begin() == map.end()) == UT_TRUE;
+
+    map[1] = 10;
+    map[2] = 20;
+    UT(map.Size()) == UT(static_cast<size_t>(2));
+    UT(map.At(1)) == UT(10);
+    UT_BOOL(map.Insert(std::make_pair(1, 11)).second) == UT_FALSE;
+    UT(map[1]) == UT(10);
+    UT_BOOL(map.Insert(std::make_pair(3, 30)).second) == UT_TRUE;
+
+    bool thrown = false;
+    try {
+        map.At(4);
+    } catch (InvalidParamException &) {
+        thrown = true;
+    }
+    UT_BOOL(thrown) == UT_TRUE;
+
+    FlatHashMap<int, int> copy(map);
+    map.Clear();
+    UT_BOOL(map.IsEmpty()) == UT_TRUE;
+    UT(copy.Size()) == UT(static_cast<size_t>(3));
+    UT(copy[3]) == UT(30);
+    map = std::move(copy);
+    UT(map.Size()) == UT(static_cast<size_t>(3));
+    UT(copy.Size()) == UT(static_cast<size_t>(0));
+    copy = map;
+    UT(copy.At(2)) == UT(20);
+
+    map.Reserve(1000);
+    size_t capacity = map.Capacity();
+    for (int i = 0; i < 1000; i++) {
+        map[i] = i;
+    }
+    UT(map.Capacity()) == UT(capacity);
+}
+
+UT_TEST("FlatHashMap random operations")
+{
+    TestRandomOps<FlatHashMap<int, int>>(100);
+    TestRandomOps<FlatHashMap<int, int>>(5000);
+    TestRandomOps<FlatHashMap<int, int, BadHash>>(300);
+}
+
+UT_TEST("FlatHashMap string keys")
+{
+    FlatHashMap<std::string, int> map;
+    map["one"] = 1;
+    map[std::string("two")] = 2;
+    map.TryEmplace(StringView("three"), 3);
+    UT(map.Size()) == UT(static_cast<size_t>(3));
+    UT(map.Find("one")->second) == UT(1);
+    UT(map.Find(StringView("two"))->second) == UT(2);
+    UT(map.Find(std::string("three"))->second) == UT(3);
+    UT_BOOL(map.Contains("four")) == UT_FALSE;
+    UT(map.Erase("two")) == UT(static_cast<size_t>(1));
+    UT_BOOL(map.Contains(StringView("two"))) == UT_FALSE;
+
+    /* Heterogeneous lookup does not create keys. */
+    FlatHashMap<CountedKey, int, CountedKeyHash, CountedKeyEqual> counted;
+    counted.TryEmplace(StringView("a"), 1);
+    counted.TryEmplace(StringView("b"), 2);
+    UT(CountedKey::numCreated) == UT(2);
+    for (int i = 0; i < 100; i++) {
+        counted.TryEmplace(StringView("c") , 3);
+        counted.TryEmplace(StringView(std::to_string(i)), i);
+    }
+    int numCreated = CountedKey::numCreated;
+    UT(numCreated) == UT(103);
+    UT(counted.Find(StringView("a"))->second) == UT(1);
+    UT_BOOL(counted.Contains(StringView("x"))) == UT_FALSE;
+    UT(counted.Erase(StringView("b"))) == UT(static_cast<size_t>(1));
+    UT(counted.Find(StringView("42"))->second) == UT(42);
+    UT(CountedKey::numCreated) == UT(numCreated);
+}
+
+UT_TEST("FlatHashMap move-only values")
+{
+    FlatHashMap<std::string, std::unique_ptr<int>> map;
+    for (int i = 0; i < 1000; i++) {
+        map.TryEmplace(std::to_string(i), new int(i));
+    }
+    for (int i = 0; i < 1000; i++) {
+        UT(*map.Find(std::to_string(i))->second) == UT(i);
+    }
+}
+
+UT_TEST("FlatHashMap allocator propagation")
+{
+    TestMoveAssignment<true>();
+    TestMoveAssignment<false>();
+}
+
+UT_TEST("FlatHashSet")
+{
+    FlatHashSet<std::string> set;
+    UT_BOOL(set.Insert("a").second) == UT_TRUE;
+    UT_BOOL(set.Insert(std::string("a")).second) == UT_FALSE;
+    UT_BOOL(set.Insert(StringView("b")).second) == UT_TRUE;
+    UT(set.Size()) == UT(static_cast<size_t>(2));
+    UT_BOOL(set.Contains("a")) == UT_TRUE;
+    UT_BOOL(set.Contains("c")) == UT_FALSE;
+
+    FlatHashSet<u64> ints;
+    for (u64 i = 0; i < 10000; i++) {
+        ints.Insert(i * 3);
+    }
+    UT(ints.Size()) == UT(static_cast<size_t>(10000));
+    u64 sum = 0;
+    for (u64 x: ints) {
+        sum += x;
+    }
+    UT(sum) == UT(static_cast<u64>(3 * 9999 * 10000 / 2));
+    for (u64 i = 0; i < 30000; i++) {
+        UT_BOOL(ints.Contains(i)) == UT_BOOL(i % 3 == 0);
+    }
+}
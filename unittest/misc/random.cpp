@@ -0,0 +1,503 @@
+/* This file is a part of ADK library.
+ * Copyright (c) 2012-2015, Artyom Lebedev <artyom.lebedev@gmail.com>
+ * All rights reserved.
+ * See LICENSE file for copyright details.
+ */
+
+/** @file random.cpp
+ * Tests for random numbers generators.
+ */
+
+#include <adk.h>
+#include <adk_ut.h>
+#include <random>
+#include <algorithm>
+
+using namespace adk;
+
+namespace {
+
+/** Check basic statistics of the engine output. */
+template <class TEngine>
+void
+CheckEngine(TEngine &engine)
+{
+    const int numSamples = 100000;
+    double sum = 0;
+    int bitCounts[64];
+    memset(bitCounts, 0, sizeof(bitCounts));
+    for (int i = 0; i < numSamples; i++) {
+        double d = engine.GetDouble();
+        UT_BOOL(d >= 0 && d < 1) == UT_TRUE;
+        sum += d;
+        float f = engine.GetFloat();
+        UT_BOOL(f >= 0 && f < 1) == UT_TRUE;
+        u64 x = engine();
+        for (int bit = 0; bit < 64; bit++) {
+            bitCounts[bit] += (x >> bit) & 1;
+        }
+    }
+    UT_BOOL(std::abs(sum / numSamples - 0.5) < 0.01) == UT_TRUE;
+    for (int bit = 0; bit < 64; bit++) {
+        UT_BOOL(std::abs(bitCounts[bit] - numSamples / 2) < numSamples / 50) == UT_TRUE;
+    }
+
+    /* UniformRandomBitGenerator compatibility. */
+    std::uniform_int_distribution<int> dist(1, 6);
+    int counts[7] = {0};
+    for (int i = 0; i < 6000; i++) {
+        counts[dist(engine)]++;
+    }
+    for (int i = 1; i <= 6; i++) {
+        UT_BOOL(counts[i] > 800 && counts[i] < 1200) == UT_TRUE;
+    }
+    std::vector<int> v(100);
+    for (int i = 0; i < 100; i++) {
+        v[i] = i;
+    }
+    std::shuffle(v.begin(), v.end(), engine);
+    std::vector<int> sorted(v);
+    std::sort(sorted.begin(), sorted.end());
+    for (int i = 0; i < 100; i++) {
+        UT(sorted[i]) == UT(i);
+    }
+}
+
+} /* anonymous namespace */
+
+UT_TEST("SplitMix64")
+{
+    SplitMix64 sm(0);
+    UT(sm.Next()) == UT(static_cast<u64>(0xe220a8397b1dcdafull));
+    UT(sm.Next()) == UT(static_cast<u64>(0x6e789e6aa1b965f4ull));
+    UT(sm.Next()) == UT(static_cast<u64>(0x06c45d188009454full));
+    CheckEngine(sm);
+}
+
+UT_TEST("Xoshiro256")
+{
+    Xoshiro256 rnd(42);
+    UT(rnd.Next()) == UT(static_cast<u64>(0x15780b2e0c2ec716ull));
+    UT(rnd.Next()) == UT(static_cast<u64>(0x6104d9866d113a7eull));
+    UT(rnd.Next()) == UT(static_cast<u64>(0xae17533239e499a1ull));
+    UT(rnd.Next()) == UT(static_cast<u64>(0xecb8ad4703b360a1ull));
+    CheckEngine(rnd);
+}
+
+UT_TEST("Pcg64")
+{
+    /* Reference pcg64 output for seed 42 and stream 54. */
+    Pcg64 rnd(42, 54);
+    UT(rnd.Next()) == UT(static_cast<u64>(0x86b1da1d72062b68ull));
+    UT(rnd.Next()) == UT(static_cast<u64>(0x1304aa46c9853d39ull));
+    UT(rnd.Next()) == UT(static_cast<u64>(0xa3670e9e0dd50358ull));
+    UT(rnd.Next()) == UT(static_cast<u64>(0xf9090e529a7dae00ull));
+    UT(rnd.Next()) == UT(static_cast<u64>(0xc85b9fd837996f2cull));
+    UT(rnd.Next()) == UT(static_cast<u64>(0x606121f8e3919196ull));
+
+    Pcg64 s1(42, 1), s2(42, 2);
+    UT_BOOL(s1.Next() == s2.Next()) == UT_FALSE;
+    CheckEngine(rnd);
+}
+
+UT_TEST("Random engine interface")
+{
+    Random rnd(1);
+    std::uniform_int_distribution<int> dist(0, 9);
+    int counts[10] = {0};
+    for (int i = 0; i < 10000; i++) {
+        counts[dist(rnd)]++;
+    }
+    for (int count: counts) {
+        UT_BOOL(count > 800 && count < 1200) == UT_TRUE;
+    }
+
+    /* Same seed gives the same sequence. */
+    Xoshiro256 a(7), b(7);
+    for (int i = 0; i < 100; i++) {
+        UT(a.GetInt32()) == UT(b.GetInt32());
+        UT(a.GetInt64()) == UT(b.GetInt64());
+    }
+}
+
+UT_TEST("Bulk random fill")
+{
+    /* The first stream is the same as Xoshiro256 sequence. */
+    BulkRandom bulk(42);
+    Xoshiro256 ref(42);
+    std::vector<u64> v64(1000);
+    bulk.Fill(v64.data(), v64.size());
+    for (size_t i = 0; i < v64.size(); i += BulkRandom::NUM_STREAMS) {
+        UT(v64[i]) == UT(ref.Next());
+    }
+    /* Streams are different. */
+    UT_BOOL(v64[0] == v64[1]) == UT_FALSE;
+
+    /* Reproducible from seed. */
+    BulkRandom b1(7), b2(7);
+    std::vector<u32> v1(1001), v2(1001);
+    b1.Fill(v1.data(), v1.size());
+    b2.Fill(v2.data(), v2.size());
+    UT_BOOL(v1 == v2) == UT_TRUE;
+    b1.Fill(v1.data(), 3);
+    b2.Fill(v2.data(), 3);
+    UT_BOOL(v1 == v2) == UT_TRUE;
+
+    std::vector<double> d(100003);
+    bulk.FillDoubles(d.data(), d.size());
+    double sum = 0;
+    for (double x: d) {
+        UT_BOOL(x >= 0 && x < 1) == UT_TRUE;
+        sum += x;
+    }
+    UT_BOOL(std::abs(sum / d.size() - 0.5) < 0.01) == UT_TRUE;
+
+    bulk.FillGaussian(d.data(), d.size(), 3, 2);
+    double mean = 0, variance = 0;
+    for (double x: d) {
+        mean += x;
+    }
+    mean /= d.size();
+    for (double x: d) {
+        variance += (x - mean) * (x - mean);
+    }
+    variance /= d.size();
+    UT_BOOL(std::abs(mean - 3) < 0.05) == UT_TRUE;
+    UT_BOOL(std::abs(variance - 4) < 0.1) == UT_TRUE;
+
+    /* Odd sizes do not write past the end. */
+    double tail[4] = {-1, -1, -1, -1};
+    bulk.FillGaussian(tail, 3);
+    UT(tail[3]) == UT(-1.0);
+    u32 tail32[4] = {0, 0, 0, 0};
+    bulk.Fill(tail32, 3);
+    UT(tail32[3]) == UT(static_cast<u32>(0));
+}
+
+namespace {
+
+/** Check that samples match the distribution CDF by Kolmogorov-Smirnov
+ * statistic.
+ */
+template <class Cdf>
+void
+CheckDistribution(std::vector<double> samples, Cdf &&cdf)
+{
+    std::sort(samples.begin(), samples.end());
+    double d = 0, n = samples.size();
+    for (size_t i = 0; i < samples.size(); i++) {
+        double f = cdf(samples[i]);
+        d = std::max(d, std::max(f - i / n, (i + 1) / n - f));
+    }
+    /* Critical value for significance level 0.001. */
+    UT_BOOL(d < 1.95 / std::sqrt(n)) == UT_TRUE;
+}
+
+double
+NormalCdf(double x)
+{
+    return 0.5 * std::erfc(-x / std::sqrt(2.0));
+}
+
+} /* anonymous namespace */
+
+UT_TEST("Ziggurat samplers")
+{
+    const adk::internal::ZigguratTable &t = adk::internal::GetNormalZigguratTable();
+    for (size_t i = 0; i < adk::internal::ZigguratTable::NUM_LAYERS; i++) {
+        UT_BOOL(t.x[i] > t.x[i + 1]) == UT_TRUE;
+    }
+    UT(t.f[adk::internal::ZigguratTable::NUM_LAYERS]) == UT(1.0);
+
+    const size_t n = 200000;
+    std::vector<double> samples(n);
+
+    Random rnd(1);
+    for (double &x: samples) {
+        x = rnd.GetGaussian(1.0);
+    }
+    CheckDistribution(samples, NormalCdf);
+    /* Tail beyond the base layer is sampled. */
+    size_t numTail = 0;
+    for (double x: samples) {
+        if (std::abs(x) > t.r) {
+            numTail++;
+        }
+    }
+    UT_BOOL(numTail > 0) == UT_TRUE;
+
+    for (double &x: samples) {
+        x = rnd.GetGaussian(5, 3);
+    }
+    CheckDistribution(samples, [](double x) { return NormalCdf((x - 5) / 3); });
+
+    for (double &x: samples) {
+        x = rnd.GetExponential(2);
+    }
+    CheckDistribution(samples, [](double x) { return 1 - std::exp(-2 * x); });
+
+    Xoshiro256 xoshiro(1);
+    for (double &x: samples) {
+        x = xoshiro.GetGaussian(-1, 0.5);
+    }
+    CheckDistribution(samples, [](double x) { return NormalCdf((x + 1) / 0.5); });
+
+    for (double &x: samples) {
+        x = xoshiro.GetExponential();
+    }
+    CheckDistribution(samples, [](double x) { return 1 - std::exp(-x); });
+
+    BulkRandom bulk(1);
+    bulk.FillGaussian(samples.data(), n);
+    CheckDistribution(samples, NormalCdf);
+}
+
+UT_TEST("Random streams")
+{
+    /* Jump polynomials verified against independent calculation. */
+    Xoshiro256 rnd(42);
+    rnd.Jump();
+    UT(rnd.Next()) == UT(static_cast<u64>(0x50086ef83cbf4f4aull));
+    Xoshiro256 stream2(42, 2);
+    UT(stream2.Next()) == UT(static_cast<u64>(0x8677623ee7544e81ull));
+    Xoshiro256 longJump(42);
+    longJump.LongJump();
+    UT(longJump.Next()) == UT(static_cast<u64>(0xa0a4cb7719d49439ull));
+    Xoshiro256 stream0(42, 0), ref(42);
+    UT(stream0.Next()) == UT(ref.Next());
+
+    /* Advance is equivalent to sequential generation. */
+    for (u64 delta: {0, 1, 2, 1000, 12345}) {
+        Pcg64 a(42, 54), b(42, 54);
+        for (u64 i = 0; i < delta; i++) {
+            a.Next();
+        }
+        b.Advance(delta);
+        UT(a.Next()) == UT(b.Next());
+    }
+    Pcg64 a(1, 2), b(1, 2);
+    a.Advance(0x123456789abcdefull);
+    a.Advance(0xfedcba987654321ull);
+    b.Advance(0x123456789abcdefull + 0xfedcba987654321ull);
+    UT(a.Next()) == UT(b.Next());
+
+    /* Bulk generator streams are jumped Xoshiro256 streams. */
+    BulkRandom bulk(42, 1);
+    u64 values[BulkRandom::NUM_STREAMS];
+    bulk.Fill(values, BulkRandom::NUM_STREAMS);
+    for (size_t i = 0; i < BulkRandom::NUM_STREAMS; i++) {
+        Xoshiro256 x(42, BulkRandom::NUM_STREAMS + i);
+        UT(values[i]) == UT(x.Next());
+    }
+}
+
+UT_TEST("Thread local random")
+{
+    ThreadLocalRandom::SetSeed(42);
+    Xoshiro256 &rnd = ThreadLocalRandom::Get();
+    UT_BOOL(&rnd == &ThreadLocalRandom::Get()) == UT_TRUE;
+
+    /* Each worker generates from its own stream selected by the pool index
+     * and the worker index in the pool.
+     */
+    const int numThreads = 4;
+    std::mutex mutex;
+    std::map<std::pair<int, int>, u64> values;
+    for (int poolNum = 0; poolNum < 2; poolNum++) {
+        ThreadPoolExecutor executor(numThreads);
+        std::atomic<int> numDone(0);
+        for (int i = 0; i < numThreads * 10; i++) {
+            executor.Submit([&]() {
+                int idx = ThreadPoolExecutor::GetCurrentWorkerIndex();
+                std::pair<int, int> key(ThreadPoolExecutor::GetCurrentPoolIndex(), idx);
+                std::unique_lock<std::mutex> lock(mutex);
+                UT_BOOL(idx >= 0 && idx < numThreads) == UT_TRUE;
+                if (!values.count(key)) {
+                    values[key] = ThreadLocalRandom::Get().Next();
+                }
+                numDone++;
+            });
+        }
+        while (numDone < numThreads * 10) {
+            std::this_thread::yield();
+        }
+    }
+    UT(ThreadPoolExecutor::GetCurrentWorkerIndex()) == UT(-1);
+    UT(ThreadPoolExecutor::GetCurrentPoolIndex()) == UT(-1);
+
+    /* Threads streams do not overlap with bulk generators streams. */
+    std::set<u64> bulkValues;
+    for (u64 stream = 0; stream < 4; stream++) {
+        BulkRandom bulk(42, stream);
+        std::vector<u64> buf(BulkRandom::NUM_STREAMS * 1000);
+        bulk.Fill(buf.data(), buf.size());
+        bulkValues.insert(buf.begin(), buf.end());
+    }
+    std::set<int> pools;
+    for (auto &p: values) {
+        pools.insert(p.first.first);
+        Xoshiro256 expected(42);
+        for (int i = 0; i < p.first.first + 2; i++) {
+            expected.LongJump();
+        }
+        for (int i = 0; i < p.first.second; i++) {
+            expected.Jump();
+        }
+        UT(p.second) == UT(expected.Next());
+        UT(bulkValues.count(p.second)) == UT_SIZE(0);
+        for (int i = 0; i < 1000; i++) {
+            UT(bulkValues.count(expected.Next())) == UT_SIZE(0);
+        }
+    }
+    UT(pools.size()) == UT_SIZE(2);
+
+    /* Reseeding re-initializes the generator on next access. */
+    u64 x = ThreadLocalRandom::Get().Next();
+    UT(bulkValues.count(x)) == UT_SIZE(0);
+    ThreadLocalRandom::SetSeed(42);
+    UT(ThreadLocalRandom::Get().Next()) == UT(x);
+    ThreadLocalRandom::SetSeed(43);
+    UT_BOOL(ThreadLocalRandom::Get().Next() == x) == UT_FALSE;
+}
+
+namespace {
+
+/** Check that the counts match the expected probabilities by chi-square
+ * test.
+ */
+void
+CheckCounts(const std::vector<size_t> &counts, const std::vector<double> &probs)
+{
+    size_t total = 0;
+    for (size_t count: counts) {
+        total += count;
+    }
+    double chi2 = 0;
+    size_t numBins = 0;
+    for (size_t i = 0; i < counts.size(); i++) {
+        double expected = probs[i] * total;
+        if (expected == 0) {
+            UT(counts[i]) == UT(static_cast<size_t>(0));
+            continue;
+        }
+        chi2 += (counts[i] - expected) * (counts[i] - expected) / expected;
+        numBins++;
+    }
+    /* Loose bound, far above the critical value for any tested number of
+     * degrees of freedom.
+     */
+    UT_BOOL(chi2 < 3.0 * numBins + 30) == UT_TRUE;
+}
+
+template <class TRandom>
+void
+CheckSampling(TRandom &rnd)
+{
+    /* Bounds. */
+    for (int i = 0; i < 1000; i++) {
+        int x = rnd.GetUniform(-3, 3);
+        UT_BOOL(x >= -3 && x <= 3) == UT_TRUE;
+        UT(rnd.GetUniform(5, 5)) == UT(5);
+        u8 b = rnd.template GetUniform<u8>(250, 255);
+        UT_BOOL(b >= 250) == UT_TRUE;
+        i64 big = rnd.template GetUniform<i64>(-(static_cast<i64>(1) << 62),
+                                                static_cast<i64>(1) << 62);
+        UT_BOOL(big >= -(static_cast<i64>(1) << 62) && big <= static_cast<i64>(1) << 62) ==
+            UT_TRUE;
+    }
+    /* Full ranges. */
+    rnd.template GetUniform<i64>(std::numeric_limits<i64>::min(),
+                                 std::numeric_limits<i64>::max());
+    rnd.template GetUniform<u32>(0, MAX_U32);
+
+    /* Uniformity. The second range would make modulo reduction of 64-bits
+     * values strongly biased.
+     */
+    std::vector<size_t> counts(3);
+    for (int i = 0; i < 30000; i++) {
+        counts[rnd.GetUniform(0, 2)]++;
+    }
+    CheckCounts(counts, std::vector<double>(3, 1.0 / 3));
+    std::vector<size_t> bigCounts(3);
+    const u64 bigRange = (static_cast<u64>(1) << 63) + (static_cast<u64>(1) << 62);
+    for (int i = 0; i < 30000; i++) {
+        bigCounts[rnd.template GetUniform<u64>(0, bigRange - 1) / (bigRange / 3)]++;
+    }
+    CheckCounts(bigCounts, std::vector<double>(3, 1.0 / 3));
+
+    /* Shuffle produces permutations with uniform positions. */
+    std::vector<size_t> firstCounts(5);
+    for (int i = 0; i < 10000; i++) {
+        int v[5] = {0, 1, 2, 3, 4};
+        rnd.Shuffle(v, v + 5);
+        int sum = 0;
+        for (int x: v) {
+            sum += 1 << x;
+        }
+        UT(sum) == UT(31);
+        firstCounts[v[0]]++;
+    }
+    CheckCounts(firstCounts, std::vector<double>(5, 0.2));
+
+    /* Reservoir sampling includes each element with equal probability. */
+    std::vector<size_t> inclusion(100);
+    for (int i = 0; i < 5000; i++) {
+        std::vector<int> input(100);
+        for (int j = 0; j < 100; j++) {
+            input[j] = j;
+        }
+        int sample[10];
+        UT(rnd.Sample(input.begin(), input.end(), sample, 10)) == UT(static_cast<size_t>(10));
+        std::set<int> unique(sample, sample + 10);
+        UT(unique.size()) == UT(static_cast<size_t>(10));
+        for (int x: sample) {
+            inclusion[x]++;
+        }
+    }
+    CheckCounts(inclusion, std::vector<double>(100, 0.01));
+    /* Short input. */
+    std::list<int> input {1, 2, 3};
+    int sample[10];
+    UT(rnd.Sample(input.begin(), input.end(), sample, 10)) == UT(static_cast<size_t>(3));
+    UT(rnd.Sample(input.begin(), input.end(), sample, 0)) == UT(static_cast<size_t>(0));
+
+    /* Alias table. */
+    std::vector<double> weights {1, 0, 2, 3, 10, 0.5};
+    AliasTable table(weights);
+    UT(table.GetSize()) == UT(weights.size());
+    std::vector<size_t> aliasCounts(weights.size());
+    for (int i = 0; i < 100000; i++) {
+        aliasCounts[table.Sample(rnd)]++;
+    }
+    std::vector<double> probs;
+    for (double w: weights) {
+        probs.push_back(w / 16.5);
+    }
+    CheckCounts(aliasCounts, probs);
+}
+
+} /* anonymous namespace */
+
+UT_TEST("Sampling utilities")
+{
+    Random rnd(1);
+    CheckSampling(rnd);
+    Xoshiro256 xoshiro(1);
+    CheckSampling(xoshiro);
+    Pcg64 pcg(1);
+    CheckSampling(pcg);
+
+    AliasTable single({5});
+    UT(single.Sample(rnd)) == UT(static_cast<size_t>(0));
+
+    for (const std::vector<double> &weights:
+         {std::vector<double>(), std::vector<double> {0, 0}, std::vector<double> {1, -1}}) {
+        bool thrown = false;
+        try {
+            AliasTable table(weights);
+        } catch (InvalidParamException &) {
+            thrown = true;
+        }
+        UT_BOOL(thrown) == UT_TRUE;
+    }
+}
@@ -0,0 +1,382 @@
+/* This file is a part of ADK library.
+ * Copyright (c) 2012-2015, Artyom Lebedev <artyom.lebedev@gmail.com>
+ * All rights reserved.
+ * See LICENSE file for copyright details.
+ */
+
+/** @file rb_tree.cpp
+ * Tests for intrusive red-black tree containers.
+ */
+
+#include <adk.h>
+#include <adk_ut.h>
+
+using namespace adk;
+
+namespace {
+
+struct Item {
+    int value;
+    RBTreeEntry entry;
+
+    Item(int value = 0):
+        value(value)
+    {}
+
+    bool
+    operator <(const Item &other) const
+    {
+        return value < other.value;
+    }
+};
+
+/** Comparator which allows lookup by integer value. */
+struct ItemLess {
+    bool
+    operator()(const Item &a, const Item &b) const
+    {
+        return a.value < b.value;
+    }
+
+    bool
+    operator()(const Item &a, int b) const
+    {
+        return a.value < b;
+    }
+
+    bool
+    operator()(int a, const Item &b) const
+    {
+        return a < b.value;
+    }
+};
+
+/** Item which is indexed by two maps simultaneously. */
+struct Timer {
+    u64 deadline;
+    int id;
+    RBTreeEntry deadlineEntry, idEntry;
+};
+
+typedef RBSet<Item, &Item::entry, ItemLess> ItemSet;
+
+/** Item with subtree size for order statistics. */
+struct RankedItem {
+    int value;
+    size_t subtreeSize;
+    RBTreeEntry entry;
+
+    bool
+    operator <(const RankedItem &other) const
+    {
+        return value < other.value;
+    }
+};
+
+typedef RBSet<RankedItem, &RankedItem::entry, std::less<RankedItem>,
+              RBTreeSizeAugment<RankedItem, &RankedItem::subtreeSize>> RankedSet;
+
+/** Memory region [start, end). */
+struct Region {
+    u64 start, end, maxEnd;
+    RBTreeEntry entry;
+};
+
+typedef RBMap<u64, Region, &Region::start, &Region::entry, std::less<u64>,
+              RBTreeIntervalAugment<Region, u64, &Region::end, &Region::maxEnd>> RegionMap;
+
+} /* anonymous namespace */
+
+UT_TEST("RB set")
+{
+    const int numItems = 1000;
+    std::vector<Item> items(numItems);
+    for (int i = 0; i < numItems; i++) {
+        /* Even values only. */
+        items[i].value = i * 2;
+    }
+    std::vector<Item *> order;
+    for (Item &item: items) {
+        order.push_back(&item);
+    }
+    Xoshiro256 rnd(1);
+    rnd.Shuffle(order.begin(), order.end());
+
+    ItemSet set;
+    UT_BOOL(set.IsEmpty()) == UT_TRUE;
+    UT_BOOL(set.begin() == set.end()) == UT_TRUE;
+    for (Item *item: order) {
+        auto res = set.Insert(*item);
+        UT_BOOL(res.second) == UT_TRUE;
+        UT_BOOL(&*res.first == item) == UT_TRUE;
+    }
+    UT(set.Size()) == UT(static_cast<size_t>(numItems));
+    UT_BOOL(set.Validate()) == UT_TRUE;
+
+    /* Duplicated key is not inserted. */
+    Item dup(10);
+    auto res = set.Insert(dup);
+    UT_BOOL(res.second) == UT_FALSE;
+    UT_BOOL(&*res.first == &items[5]) == UT_TRUE;
+    UT_BOOL(dup.entry.IsWired()) == UT_FALSE;
+
+    /* Forward and backward iteration. */
+    int expected = 0;
+    for (Item &item: set) {
+        UT(item.value) == UT(expected);
+        expected += 2;
+    }
+    UT(expected) == UT(numItems * 2);
+    auto it = set.end();
+    do {
+        --it;
+        expected -= 2;
+        UT(it->value) == UT(expected);
+    } while (it != set.begin());
+    UT(expected) == UT(0);
+
+    /* Lookups. */
+    UT(set.Find(100)->value) == UT(100);
+    UT_BOOL(set.Find(101) == set.end()) == UT_TRUE;
+    UT_BOOL(set.Contains(998)) == UT_TRUE;
+    UT_BOOL(set.Contains(-2)) == UT_FALSE;
+    UT(set.LowerBound(100)->value) == UT(100);
+    UT(set.LowerBound(101)->value) == UT(102);
+    UT(set.LowerBound(-5)->value) == UT(0);
+    UT_BOOL(set.LowerBound(numItems * 2 - 1) == set.end()) == UT_TRUE;
+    UT(set.UpperBound(100)->value) == UT(102);
+    UT(set.UpperBound(101)->value) == UT(102);
+    UT_BOOL(set.UpperBound(numItems * 2 - 2) == set.end()) == UT_TRUE;
+    const ItemSet &constSet = set;
+    ItemSet::const_iterator cit = constSet.LowerBound(7);
+    UT(cit->value) == UT(8);
+
+    /* Range erase. */
+    it = set.LowerBound(100);
+    while (it != set.end() && it->value < 200) {
+        it = set.Erase(it);
+    }
+    UT(it->value) == UT(200);
+    UT(set.Size()) == UT(static_cast<size_t>(numItems - 50));
+    UT_BOOL(items[50].entry.IsWired()) == UT_FALSE;
+    UT_BOOL(set.Validate()) == UT_TRUE;
+
+    /* Erase by item and by key in random order. */
+    for (Item *item: order) {
+        if (item->value >= 100 && item->value < 200) {
+            continue;
+        }
+        if (item->value % 4) {
+            set.Erase(*item);
+        } else {
+            UT(set.EraseKey(item->value)) == UT(static_cast<size_t>(1));
+        }
+        UT_BOOL(item->entry.IsWired()) == UT_FALSE;
+    }
+    UT_BOOL(set.Validate()) == UT_TRUE;
+    UT_BOOL(set.IsEmpty()) == UT_TRUE;
+    UT(set.EraseKey(0)) == UT(static_cast<size_t>(0));
+
+    /* Items can be inserted again after removal. */
+    for (Item &item: items) {
+        set.Insert(item);
+    }
+    UT_BOOL(set.Validate()) == UT_TRUE;
+    set.Clear();
+    UT_BOOL(set.IsEmpty()) == UT_TRUE;
+    for (Item &item: items) {
+        UT_BOOL(item.entry.IsWired()) == UT_FALSE;
+    }
+}
+
+UT_TEST("RB map")
+{
+    typedef RBMap<u64, Timer, &Timer::deadline, &Timer::deadlineEntry> DeadlineMap;
+    typedef RBMap<int, Timer, &Timer::id, &Timer::idEntry,
+                  std::greater<int>> IdMap;
+
+    const int numTimers = 500;
+    std::vector<Timer> timers(numTimers);
+    DeadlineMap byDeadline;
+    IdMap byId;
+    for (int i = 0; i < numTimers; i++) {
+        timers[i].deadline = static_cast<u64>(i * 7919 % numTimers) * 1000;
+        timers[i].id = i;
+        UT_BOOL(byDeadline.Insert(timers[i]).second) == UT_TRUE;
+        UT_BOOL(byId.Insert(timers[i]).second) == UT_TRUE;
+    }
+    UT_BOOL(byDeadline.Validate()) == UT_TRUE;
+    UT_BOOL(byId.Validate()) == UT_TRUE;
+
+    /* Descending order for the reversed comparator. */
+    UT(byId.begin()->id) == UT(numTimers - 1);
+
+    /* Expire timers up to the specified time. */
+    u64 now = 100500;
+    int numExpired = 0;
+    while (!byDeadline.IsEmpty() && byDeadline.begin()->deadline <= now) {
+        Timer &timer = *byDeadline.begin();
+        byDeadline.Erase(timer);
+        byId.Erase(timer);
+        numExpired++;
+    }
+    UT(numExpired) == UT(101);
+    UT(byDeadline.begin()->deadline) == UT(static_cast<u64>(101000));
+    UT(byDeadline.Size()) == UT(byId.Size());
+    UT_BOOL(byDeadline.Validate()) == UT_TRUE;
+    UT_BOOL(byId.Validate()) == UT_TRUE;
+
+    /* Iterator from item. */
+    Timer &timer = *byId.Find(numTimers / 2);
+    auto it = byDeadline.GetIterator(timer);
+    UT(it->id) == UT(numTimers / 2);
+    ++it;
+    UT(it->deadline) == UT(timer.deadline + 1000);
+
+    /* Moved container keeps the items. */
+    DeadlineMap other(std::move(byDeadline));
+    UT_BOOL(byDeadline.IsEmpty()) == UT_TRUE;
+    UT(other.Size()) == UT(static_cast<size_t>(numTimers - numExpired));
+    UT_BOOL(other.Validate()) == UT_TRUE;
+}
+
+UT_TEST("RB tree bulk build")
+{
+    for (int numItems = 0; numItems <= 1100; numItems += numItems < 70 ? 1 : 97) {
+        UT_TRACE("%d items", numItems);
+        std::vector<Item> items, odd;
+        for (int i = 0; i < numItems; i++) {
+            items.emplace_back(i * 2);
+        }
+        for (int i = 0; i < numItems; i += 3) {
+            odd.emplace_back(i * 2 + 1);
+        }
+        /* The set is declared after the items since it unlinks them on
+         * destruction.
+         */
+        RBSet<Item, &Item::entry> set(items.begin(), items.end());
+        UT(set.Size()) == UT(static_cast<size_t>(numItems));
+        UT_BOOL(set.Validate()) == UT_TRUE;
+        int expected = 0;
+        for (Item &item: set) {
+            UT(item.value) == UT(expected);
+            expected += 2;
+        }
+
+        /* Built tree is rebalanced correctly on modifications. */
+        for (Item &item: odd) {
+            UT_BOOL(set.Insert(item).second) == UT_TRUE;
+        }
+        UT_BOOL(set.Validate()) == UT_TRUE;
+        for (int i = 0; i < numItems; i += 2) {
+            set.Erase(items[i]);
+        }
+        UT_BOOL(set.Validate()) == UT_TRUE;
+        UT(set.Size()) == UT(odd.size() + numItems / 2);
+
+        /* Re-building the content releases previous items. */
+        set.Assign(odd.begin(), odd.end());
+        UT_BOOL(set.Validate()) == UT_TRUE;
+        UT(set.Size()) == UT(odd.size());
+        for (Item &item: items) {
+            UT_BOOL(item.entry.IsWired()) == UT_FALSE;
+        }
+    }
+}
+
+UT_TEST("RB tree order statistics")
+{
+    const int numItems = 2000;
+    std::vector<RankedItem> items(numItems);
+    for (int i = 0; i < numItems; i++) {
+        items[i].value = i;
+    }
+    std::vector<RankedItem *> order;
+    for (RankedItem &item: items) {
+        order.push_back(&item);
+    }
+    Xoshiro256 rnd(2);
+    rnd.Shuffle(order.begin(), order.end());
+
+    RankedSet set;
+    for (RankedItem *item: order) {
+        set.Insert(*item);
+    }
+    UT_BOOL(set.Validate()) == UT_TRUE;
+    for (int i = 0; i < numItems; i++) {
+        UT(set.Select(i)->value) == UT(i);
+        UT(set.GetRank(set.GetIterator(items[i]))) == UT(static_cast<size_t>(i));
+    }
+    UT_BOOL(set.Select(numItems) == set.end()) == UT_TRUE;
+    UT(set.GetRank(set.end())) == UT(static_cast<size_t>(numItems));
+
+    /* Sizes are maintained on deletion. */
+    std::set<int> reference;
+    for (int i = 0; i < numItems; i++) {
+        reference.insert(i);
+    }
+    for (size_t i = 0; i < order.size(); i += 2) {
+        set.Erase(*order[i]);
+        reference.erase(order[i]->value);
+    }
+    UT_BOOL(set.Validate()) == UT_TRUE;
+    size_t rank = 0;
+    for (int value: reference) {
+        UT(set.Select(rank)->value) == UT(value);
+        UT(set.GetRank(set.Find(items[value]))) == UT(rank);
+        rank++;
+    }
+
+    /* Sizes are calculated by bulk build. */
+    set.Clear();
+    RankedSet built(items.begin(), items.end());
+    UT_BOOL(built.Validate()) == UT_TRUE;
+    UT(built.Select(numItems / 3)->value) == UT(numItems / 3);
+}
+
+UT_TEST("RB tree interval search")
+{
+    const int numRegions = 3000;
+    std::vector<Region> regions(numRegions);
+    Xoshiro256 rnd(3);
+    RegionMap map;
+    for (Region &region: regions) {
+        /* Unique start, random length including long ones. */
+        do {
+            region.start = rnd.GetUniform<u64>(0, 1000000);
+            region.end = region.start + 1 + (rnd.GetUniform<u32>(0, 99) ?
+                rnd.GetUniform<u64>(0, 999) : rnd.GetUniform<u64>(0, 99999));
+        } while (!map.Insert(region).second);
+    }
+    UT_BOOL(map.Validate()) == UT_TRUE;
+
+    auto Check = [&]() {
+        for (int query = 0; query < 200; query++) {
+            u64 low = rnd.GetUniform<u64>(0, 1100000);
+            u64 high = low + rnd.GetUniform<u64>(1, 5000);
+            std::vector<const Region *> expected, found;
+            for (const Region &region: map) {
+                if (region.start < high && low < region.end) {
+                    expected.push_back(&region);
+                }
+            }
+            for (auto it = map.FindOverlap(low, high); it != map.end();
+                 it = map.FindNextOverlap(it, low, high)) {
+
+                found.push_back(&*it);
+            }
+            UT(found.size()) == UT(expected.size());
+            UT_BOOL(found == expected) == UT_TRUE;
+        }
+    };
+    Check();
+
+    /* Maximal ends are maintained on deletion. */
+    for (int i = 0; i < numRegions; i += 3) {
+        map.Erase(regions[i]);
+    }
+    UT_BOOL(map.Validate()) == UT_TRUE;
+    Check();
+
+    UT_BOOL(map.FindOverlap<u64>(2000000, 2000001) == map.end()) == UT_TRUE;
+}
@@ -0,0 +1,144 @@
+/* This file is a part of ADK library.
+ * Copyright (c) 2012-2015, Artyom Lebedev <artyom.lebedev@gmail.com>
+ * All rights reserved.
+ * See LICENSE file for copyright details.
+ */
+
+/** @file sketch.cpp
+ * Tests for probabilistic sketches.
+ */
+
+#include <adk.h>
+#include <adk_ut.h>
+
+using namespace adk;
+
+UT_TEST("Bloom filter")
+{
+    const size_t numItems = 10000;
+    BloomFilter filter(numItems, 0.01);
+    UT_BOOL(filter.GetNumHashes() > 0) == UT_TRUE;
+
+    for (u32 i = 0; i < numItems; i++) {
+        filter.Add(&i, sizeof(i));
+    }
+    /* No false negatives. */
+    for (u32 i = 0; i < numItems; i++) {
+        UT_BOOL(filter.Contains(&i, sizeof(i))) == UT_TRUE;
+    }
+    size_t numFalsePositives = 0;
+    for (u32 i = numItems; i < numItems * 11; i++) {
+        if (filter.Contains(&i, sizeof(i))) {
+            numFalsePositives++;
+        }
+    }
+    double rate = static_cast<double>(numFalsePositives) / (numItems * 10);
+    UT_TRACE("False positive rate %f", rate);
+    UT_BOOL(rate < 0.015) == UT_TRUE;
+
+    /* Per-thread filters merge. */
+    BloomFilter f1(numItems, 0.01), f2(numItems, 0.01);
+    for (u32 i = 0; i < numItems; i++) {
+        if (i % 2) {
+            f1.Add(&i, sizeof(i));
+        } else {
+            f2.Add(&i, sizeof(i));
+        }
+    }
+    u32 item = 1;
+    UT_BOOL(f2.Contains(&item, sizeof(item))) == UT_FALSE;
+    f2.Merge(f1);
+    for (u32 i = 0; i < numItems; i++) {
+        UT_BOOL(f2.Contains(&i, sizeof(i))) == UT_TRUE;
+    }
+
+    f2.Clear();
+    UT_BOOL(f2.Contains(&item, sizeof(item))) == UT_FALSE;
+
+    BloomFilter other(numItems, 0.01, 1);
+    bool thrown = false;
+    try {
+        f1.Merge(other);
+    } catch (InvalidParamException &) {
+        thrown = true;
+    }
+    UT_BOOL(thrown) == UT_TRUE;
+}
+
+UT_TEST("Count-min sketch")
+{
+    CountMinSketch sketch(0.001, 0.01);
+    UT(sketch.GetDepth()) == UT(static_cast<size_t>(5));
+    UT(sketch.GetWidth()) == UT(static_cast<size_t>(4096));
+
+    /* Item i occurs i % 100 times. */
+    for (u32 i = 0; i < 10000; i++) {
+        sketch.Add(&i, sizeof(i), i % 100);
+    }
+    u64 total = sketch.GetTotal();
+    size_t numExceeded = 0;
+    for (u32 i = 0; i < 10000; i++) {
+        u64 estimate = sketch.Estimate(&i, sizeof(i));
+        UT_BOOL(estimate >= i % 100) == UT_TRUE;
+        if (estimate > i % 100 + 0.001 * total) {
+            numExceeded++;
+        }
+    }
+    UT_BOOL(numExceeded <= 100) == UT_TRUE;
+
+    CountMinSketch s1, s2;
+    std::string a("a"), b("b");
+    s1.Add(a.data(), a.size(), 3);
+    s2.Add(a.data(), a.size(), 4);
+    s2.Add(b.data(), b.size());
+    s1.Merge(s2);
+    UT(s1.Estimate(a.data(), a.size())) == UT(static_cast<u64>(7));
+    UT(s1.Estimate(b.data(), b.size())) == UT(static_cast<u64>(1));
+    UT(s1.GetTotal()) == UT(static_cast<u64>(8));
+    s1.Clear();
+    UT(s1.Estimate(a.data(), a.size())) == UT(static_cast<u64>(0));
+    UT(s1.GetTotal()) == UT(static_cast<u64>(0));
+}
+
+UT_TEST("HyperLogLog")
+{
+    HyperLogLog hll;
+    UT(hll.Estimate()) == UT(0.0);
+
+    /* Duplicates do not affect the estimation. */
+    for (int round = 0; round < 3; round++) {
+        for (u32 i = 0; i < 100; i++) {
+            hll.Add(&i, sizeof(i));
+        }
+    }
+    UT_BOOL(std::abs(hll.Estimate() - 100) < 2) == UT_TRUE;
+
+    for (size_t numItems: {1000, 100000, 1000000}) {
+        HyperLogLog h1(14), h2(14);
+        for (u32 i = 0; i < numItems; i++) {
+            (i % 3 ? h1 : h2).Add(&i, sizeof(i));
+        }
+        h1.Merge(h2);
+        double error = std::abs(h1.Estimate() - numItems) / numItems;
+        UT_TRACE("%zu items: estimate %f", numItems, h1.Estimate());
+        /* Standard error is 0.8% for precision 14. */
+        UT_BOOL(error < 0.03) == UT_TRUE;
+    }
+
+    bool thrown = false;
+    try {
+        HyperLogLog invalid(HyperLogLog::MAX_PRECISION + 1);
+    } catch (InvalidParamException &) {
+        thrown = true;
+    }
+    UT_BOOL(thrown) == UT_TRUE;
+
+    thrown = false;
+    try {
+        HyperLogLog other(12);
+        hll.Merge(other);
+    } catch (InvalidParamException &) {
+        thrown = true;
+    }
+    UT_BOOL(thrown) == UT_TRUE;
+}
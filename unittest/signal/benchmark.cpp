@@ -0,0 +1,156 @@
+/* This file is a part of ADK library.
+ * Copyright (c) 2012-2015, Artyom Lebedev <artyom.lebedev@gmail.com>
+ * All rights reserved.
+ * See LICENSE file for copyright details.
+ */
+
+/** @file benchmark.cpp
+ * Performance benchmarks for signals and slots.
+ */
+
+#include <adk.h>
+#include <adk_ut.h>
+
+using namespace adk;
+
+namespace {
+
+class Handler: public SlotTarget {
+public:
+    std::atomic<u64> counter {0};
+
+    void
+    Method(int x)
+    {
+        counter.fetch_add(x, std::memory_order_relaxed);
+    }
+};
+
+typedef std::chrono::steady_clock Clock;
+
+/** Run the function the specified number of times and return average time of
+ * one iteration in nanoseconds.
+ */
+template <class Func>
+double
+Measure(size_t numIterations, Func &&func)
+{
+    auto start = Clock::now();
+    for (size_t i = 0; i < numIterations; i++) {
+        func();
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>
+        (Clock::now() - start);
+    return static_cast<double>(elapsed.count()) / numIterations;
+}
+
+const size_t numSlotsCases[] = {0, 1, 4, 16, 64};
+
+} /* anonymous namespace */
+
+UT_TEST("Benchmark: emission cost versus slot count")
+{
+    const size_t numIterations = 20000;
+
+    for (size_t numSlots: numSlotsCases) {
+        Handler h;
+        Signal<void(int)> sig;
+        StaticSignal<void(int), 64> staticSig;
+        std::list<SignalConnection<void(int)>> cons;
+
+        for (size_t i = 0; i < numSlots; i++) {
+            cons.push_back(sig.Connect(
+                Slot<void(int)>::Make(&Handler::Method, &h, std::placeholders::_1)));
+            staticSig.Connect(Delegate<void(int)>::Make<Handler, &Handler::Method>(&h));
+        }
+
+        double tSig = Measure(numIterations, [&]() { sig.Emit(1); });
+        sig.EnableProfiling();
+        double tSigProf = Measure(numIterations, [&]() { sig.Emit(1); });
+        double tStatic = Measure(numIterations, [&]() { staticSig.Emit(1); });
+
+        UT_TRACE("%2zu slots: Signal %9.1f ns, Signal (profiled) %9.1f ns, "
+                 "StaticSignal %7.1f ns",
+                 numSlots, tSig, tSigProf, tStatic);
+        UT(h.counter.load()) == UT(static_cast<u64>(numIterations * numSlots * 3));
+    }
+}
+
+UT_TEST("Benchmark: connect/disconnect churn")
+{
+    const size_t numIterations = 20000;
+    Handler h;
+    Signal<void(int)> sig;
+    /* Some connections which stay in the lists during the test. */
+    std::list<SignalConnection<void(int)>> cons;
+    std::list<Slot<void(int)>> slots;
+    for (int i = 0; i < 64; i++) {
+        cons.push_back(sig.Connect(
+            Slot<void(int)>::Make(&Handler::Method, &h, std::placeholders::_1)));
+        slots.push_back(Slot<void(int)>::Make(&Handler::Method, &h, std::placeholders::_1));
+    }
+
+    double tConnect = Measure(numIterations, [&]() {
+        sig.Connect(Slot<void(int)>::Make(&Handler::Method, &h, std::placeholders::_1)).
+            Disconnect();
+    });
+
+    double tSlot = Measure(numIterations, [&]() {
+        Slot<void(int)> slot =
+            Slot<void(int)>::Make(&Handler::Method, &h, std::placeholders::_1);
+    });
+
+    StaticSignal<void(int), 64> staticSig;
+    auto d = Delegate<void(int)>::Make<Handler, &Handler::Method>(&h);
+    double tStatic = Measure(numIterations, [&]() {
+        staticSig.Connect(d);
+        staticSig.Disconnect(d);
+    });
+
+    UT_TRACE("Signal connect+disconnect %.1f ns, slot bind+unbind %.1f ns, "
+             "StaticSignal connect+disconnect %.1f ns",
+             tConnect, tSlot, tStatic);
+    UT(h.counter.load()) == UT(static_cast<u64>(0));
+}
+
+UT_TEST("Benchmark: cross-thread emission")
+{
+    const size_t numIterations = 10000;
+    const size_t numSlots = 8;
+    unsigned numThreads = Max(2u, std::thread::hardware_concurrency());
+    Handler h;
+    Signal<void(int)> sig;
+    AtomicStaticSignal<void(int), numSlots> staticSig;
+    std::list<SignalConnection<void(int)>> cons;
+
+    for (size_t i = 0; i < numSlots; i++) {
+        cons.push_back(sig.Connect(
+            Slot<void(int)>::Make(&Handler::Method, &h, std::placeholders::_1)));
+        staticSig.Connect(Delegate<void(int)>::Make<Handler, &Handler::Method>(&h));
+    }
+
+    auto run = [&](std::function<void()> emit) {
+        std::vector<std::thread> threads;
+        auto start = Clock::now();
+        for (unsigned i = 0; i < numThreads; i++) {
+            threads.emplace_back([&]() {
+                for (size_t j = 0; j < numIterations; j++) {
+                    emit();
+                }
+            });
+        }
+        for (std::thread &t: threads) {
+            t.join();
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>
+            (Clock::now() - start);
+        return static_cast<double>(elapsed.count()) / (numIterations * numThreads);
+    };
+
+    double tSig = run([&]() { sig.Emit(1); });
+    double tStatic = run([&]() { staticSig.Emit(1); });
+
+    UT_TRACE("%u threads, %zu slots: Signal %.1f ns/emit, AtomicStaticSignal %.1f ns/emit",
+             numThreads, numSlots, tSig, tStatic);
+    UT(h.counter.load()) == UT(static_cast<u64>(numIterations * numThreads * numSlots * 2));
+}
@@ -194,3 +194,258 @@ UT_TEST("Signal deletion")
     UT_BOOL(con1) == UT_FALSE;
     UT_BOOL(con2) == UT_FALSE;
 }
+
+UT_TEST("Slot target bookkeeping")
+{
+    std::unique_ptr<Target> t(new Target);
+    std::vector<std::unique_ptr<Slot<int(int)>>> slots;
+
+    for (int i = 0; i < 16; i++) {
+        slots.emplace_back(new Slot<int(int)>(
+            Slot<int(int)>::Make(&Target::Method, t.get(), i, std::placeholders::_1)));
+    }
+    /* Unlink from the head, the tail and the middle of the list. */
+    slots[15] = nullptr;
+    slots[0] = nullptr;
+    slots[7] = nullptr;
+    /* Move and copy should keep the list consistent. */
+    Slot<int(int)> moved(std::move(*slots[3]));
+    Slot<int(int)> copied(*slots[4]);
+    slots[3] = nullptr;
+    UT(moved(10)) == UT(13);
+    UT(copied(10)) == UT(14);
+
+    t = nullptr;
+    UT_BOOL(moved) == UT_FALSE;
+    UT_BOOL(copied) == UT_FALSE;
+    for (auto &slot: slots) {
+        if (slot) {
+            UT_BOOL(*slot) == UT_FALSE;
+        }
+    }
+}
+
+UT_TEST("Static signal")
+{
+    typedef StaticSignal<int(int, int), 3> SigType;
+    typedef SigType::DelegateType DelegateType;
+
+    SigType sig;
+    NonTarget nt;
+    Callable c(15);
+
+    UT(sig.Emit(1, 2)) == UT(0);
+
+    auto d1 = DelegateType::Make<NonTarget, &NonTarget::Method>(&nt);
+    auto d2 = DelegateType::Make<&Function>();
+    auto d3 = DelegateType::Make(&c);
+
+    UT_BOOL(DelegateType()) == UT_FALSE;
+    UT_BOOL(d1) == UT_TRUE;
+    UT(d1(1, 2)) == UT(3);
+    UT(d2(1, 2)) == UT(3);
+    UT(d3(1, 2)) == UT(18);
+
+    UT_BOOL(sig.Connect(d1)) == UT_TRUE;
+    UT_BOOL(sig.Connect(d2)) == UT_TRUE;
+    UT_BOOL(sig.Connect(d3)) == UT_TRUE;
+    UT_BOOL(sig.Connect(d3)) == UT_FALSE;
+
+    UT(sig.Emit(10, 20)) == UT(45);
+    UT(nt.lastResult) == UT(30);
+    UT(c.lastResult) == UT(30);
+
+    UT_BOOL(sig.Disconnect(d3)) == UT_TRUE;
+    UT_BOOL(sig.Disconnect(d3)) == UT_FALSE;
+    UT(sig.Emit(10, 20)) == UT(30);
+
+    UT_BOOL(sig.Disconnect(d1)) == UT_TRUE;
+    nt.lastResult = 0;
+    sig(1, 1);
+    UT(nt.lastResult) == UT(0);
+
+    /* Freed entry is reused. */
+    UT_BOOL(sig.Connect(d1)) == UT_TRUE;
+    UT_BOOL(sig.Connect(d3)) == UT_TRUE;
+    UT_BOOL(sig.Connect(d3)) == UT_FALSE;
+
+    sig.DisconnectAll();
+    UT(sig.Emit(10, 20)) == UT(0);
+}
+
+UT_TEST("Atomic static signal")
+{
+    AtomicStaticSignal<void(int), 4> sig;
+    std::atomic<int> sum(0);
+    auto func = [&sum](int x) { sum += x; };
+    auto d = Delegate<void(int)>::Make(&func);
+
+    UT_BOOL(sig.Connect(d)) == UT_TRUE;
+
+    std::atomic<bool> stop(false);
+    std::thread emitter([&]() {
+        while (!stop) {
+            sig.Emit(1);
+        }
+    });
+    for (int i = 0; i < 1000; i++) {
+        sig.Disconnect(d);
+        sig.Connect(d);
+    }
+    stop = true;
+    emitter.join();
+
+    sum = 0;
+    sig.Emit(5);
+    UT(sum.load()) == UT(5);
+
+    /* Target is not invoked after disconnection returns, so it can be
+     * destroyed.
+     */
+    sig.DisconnectAll();
+    std::atomic<bool> isDestroyed(false);
+    std::atomic<int> numViolations(0);
+    auto slowFunc = [&](int) {
+        for (int i = 0; i < 1000; i++) {
+            if (isDestroyed) {
+                numViolations++;
+                return;
+            }
+        }
+    };
+    auto slowD = Delegate<void(int)>::Make(&slowFunc);
+    stop = false;
+    std::vector<std::thread> emitters;
+    for (int i = 0; i < 2; i++) {
+        emitters.emplace_back([&]() {
+            while (!stop) {
+                sig.Emit(1);
+            }
+        });
+    }
+    for (int i = 0; i < 200; i++) {
+        sig.Connect(slowD);
+        std::this_thread::yield();
+        if (i % 2) {
+            sig.Disconnect(slowD);
+        } else {
+            sig.DisconnectAll();
+        }
+        isDestroyed = true;
+        std::this_thread::yield();
+        isDestroyed = false;
+    }
+    stop = true;
+    for (std::thread &t: emitters) {
+        t.join();
+    }
+    UT(numViolations.load()) == UT(0);
+
+    /* Disconnection from the slot does not wait for its own emission. */
+    Delegate<void(int)> selfD;
+    int numCalls = 0;
+    auto selfFunc = [&](int) {
+        numCalls++;
+        UT_BOOL(sig.Disconnect(selfD)) == UT_TRUE;
+    };
+    selfD = Delegate<void(int)>::Make(&selfFunc);
+    sig.Connect(selfD);
+    sig.Emit(1);
+    sig.Emit(1);
+    UT(numCalls) == UT(1);
+
+    /* Slots connecting and disconnecting on the signal being emitted while
+     * another thread disconnects do not deadlock.
+     */
+    auto nopFunc = [](int) {};
+    auto auxD = Delegate<void(int)>::Make(&nopFunc);
+    auto otherD = Delegate<void(int)>::Make(&func);
+    std::atomic<bool> inSlot(false);
+    auto reconnectFunc = [&](int) {
+        inSlot = true;
+        std::this_thread::yield();
+        sig.Connect(auxD);
+        sig.Disconnect(auxD);
+        inSlot = false;
+    };
+    auto reconnectD = Delegate<void(int)>::Make(&reconnectFunc);
+    sig.Connect(reconnectD);
+    stop = false;
+    std::thread reconnector([&]() {
+        while (!stop) {
+            sig.Emit(1);
+        }
+    });
+    for (int i = 0; i < 200; i++) {
+        sig.Connect(otherD);
+        while (!inSlot) {
+            std::this_thread::yield();
+        }
+        sig.Disconnect(otherD);
+    }
+    stop = true;
+    reconnector.join();
+    sig.DisconnectAll();
+}
+
+UT_TEST("Signal profiling")
+{
+    Signal<int(int)> sig;
+    std::unique_ptr<Target> t(new Target);
+    NonTarget nt;
+
+    auto con1 = sig.Connect(Slot<int(int)>::Make(&Target::Method, t.get(), 1, std::placeholders::_1));
+    auto con2 = sig.Connect(Slot<int(int)>::Make(&NonTarget::Method, &nt, 2, std::placeholders::_1));
+
+    /* Nothing is collected until enabled. */
+    sig.Emit(1);
+    for (const SignalSlotProfile &p: sig.GetProfile()) {
+        UT(p.numCalls) == UT(static_cast<u64>(0));
+    }
+
+    SignalProxy<int(int)>(sig).EnableProfiling();
+    UT_BOOL(sig.IsProfilingEnabled()) == UT_TRUE;
+    for (int i = 0; i < 10; i++) {
+        sig.Emit(i);
+    }
+    sig.EmitNoResult(1);
+
+    auto profile = sig.GetProfile();
+    UT(profile.size()) == UT_SIZE(2);
+    bool targetFound = false;
+    for (const SignalSlotProfile &p: profile) {
+        UT(p.numCalls) == UT(static_cast<u64>(11));
+        UT(p.totalTime.count()) > UT(0);
+        if (p.target == t.get()) {
+            targetFound = true;
+        }
+    }
+    UT_BOOL(targetFound) == UT_TRUE;
+
+    sig.ResetProfile();
+    for (const SignalSlotProfile &p: sig.GetProfile()) {
+        UT(p.numCalls) == UT(static_cast<u64>(0));
+    }
+
+    /* Deferred emission is accounted as well. */
+    std::list<Slot<int(int)>> slots = sig.GetEmitSlots();
+    UT(slots.size()) == UT_SIZE(2);
+    targetFound = false;
+    for (Slot<int(int)> &slot: slots) {
+        if (slot.GetTarget() == t.get()) {
+            targetFound = true;
+        }
+        slot(1);
+    }
+    UT_BOOL(targetFound) == UT_TRUE;
+    for (const SignalSlotProfile &p: sig.GetProfile()) {
+        UT(p.numCalls) == UT(static_cast<u64>(1));
+    }
+    sig.ResetProfile();
+
+    sig.EnableProfiling(false);
+    sig.Emit(1);
+    for (const SignalSlotProfile &p: sig.GetProfile()) {
+        UT(p.numCalls) == UT(static_cast<u64>(0));
+    }
+}